@@ -0,0 +1,185 @@
+#include "BeamSearch.h"
+#include "Zobrist.h"
+#include <algorithm>
+
+namespace
+{
+	constexpr std::size_t INITIAL_TABLE_SIZE = 4096;	// transposition table slots (a power of 2)
+
+	// the Zobrist hash of a board's occupancy
+	std::uint64_t hashBoard(const BeamSearch::Rows& rows)
+	{
+		return Zobrist::hashRows<BeamSearch::Board::MAX_X, BeamSearch::Board::MAX_Y>(rows.data());
+	}
+}
+
+// constructor (the default Evaluator weights)
+// - param 1: the boards kept at each depth
+BeamSearch::BeamSearch(int beamWidth) : BeamSearch{ beamWidth, Evaluator::Weights{} }
+{
+}
+
+// constructor
+// - param 1: the boards kept at each depth
+// - param 2: the Evaluator weights
+BeamSearch::BeamSearch(int beamWidth, const Evaluator::Weights& weights)
+	: evaluator{ weights }, beamWidth{ beamWidth > 0 ? beamWidth : 1 }, table(INITIAL_TABLE_SIZE)
+{
+}
+
+// search for where the first of a sequence of pieces should lock
+//   Each depth expands the beam into children (expand()), keeps the best beamWidth
+//   of them & records the root Move of the best one.  The search ends after the
+//   last piece, when no board can take the next piece (every sequence tops out)
+//   or at the deadline - a depth the deadline cut short is dropped.
+// - param 1: the board
+// - param 2: the pieces (the current shape first, then the preview), each
+//            spawned at the board's spawn location in its spawn rotation
+// - param 3: the time to stop by
+// - return: the Result
+BeamSearch::Result BeamSearch::search(const Board& board, const std::vector<TetShape>& pieces, Clock::time_point deadline)
+{
+	Result result;
+	rootMoves.clear();
+	beam.clear();
+	beam.emplace_back();
+	Evaluator::getRows(board, beam.back().rows);
+
+	for (std::size_t depth{ 0 }; depth < pieces.size(); depth++)
+	{
+		if (!expand(pieces[depth], board.getSpawnLoc(), deadline, result) || children.empty())
+		{
+			break;
+		}
+
+		const std::size_t keep = std::min(children.size(), static_cast<std::size_t>(beamWidth));
+		std::partial_sort(children.begin(), children.begin() + keep, children.end(),
+			[](const Node& a, const Node& b) { return a.value > b.value; });
+		children.resize(keep);
+		beam.swap(children);
+
+		result.found = true;
+		result.move = rootMoves[beam[0].root];
+		result.value = beam[0].value;
+		result.depth = static_cast<int>(depth) + 1;
+		if (Clock::now() >= deadline)
+		{
+			break;
+		}
+	}
+	return result;
+}
+
+// place a piece on every board of the beam & keep the distinct children
+//   A child's value is its parent's carried terms plus the score of the board it
+//   is; it carries its parent's terms plus its own placement's landing height &
+//   removed rows terms.  At the root every Move is recorded, deeper children
+//   inherit their parent's root.
+// - param 1: the piece
+// - param 2: the piece's spawn location
+// - param 3: the time to stop by (checked between boards, unless the beam is the root)
+// - param 4: the Result (its counters are updated)
+// - return: bool, false if the deadline passed before every board was expanded
+bool BeamSearch::expand(TetShape piece, const Point& spawnLoc, Clock::time_point deadline, Result& result)
+{
+	const bool isRoot = rootMoves.empty();
+	const Evaluator::Weights& weights = evaluator.getWeights();
+	if (++stamp == 0)
+	{
+		// (the stamps wrapped around: forget every entry)
+		std::fill(table.begin(), table.end(), Entry{});
+		stamp = 1;
+	}
+	children.clear();
+
+	GridTetromino spawned;
+	spawned.setShape(piece);
+	spawned.setGridLoc(spawnLoc);
+	Evaluator::Candidate candidate;
+	Node child;
+	for (const Node& node : beam)
+	{
+		if (!isRoot && Clock::now() >= deadline)
+		{
+			return false;
+		}
+		for (const MoveGenerator::Move& move : generator.generate(node.rows.data(), spawned))
+		{
+			Evaluator::place(node.rows, piece, move, candidate);
+			const Evaluator::Features features = Evaluator::getFeatures(candidate);
+			child.rows = candidate.rows;
+			child.value = node.carried + evaluator.score(features);
+			child.carried = node.carried + weights.landingHeight * features.landingHeight
+				+ weights.removedRows * features.removedRows;
+			if (isRoot)
+			{
+				child.root = static_cast<int>(rootMoves.size());
+				rootMoves.push_back(move);
+			}
+			else
+			{
+				child.root = node.root;
+			}
+			result.nodes++;
+			addChild(child, result);
+		}
+	}
+	return true;
+}
+
+// add a child board unless the transposition table has a better copy of it
+//   (open addressing: the slots from the hash on, until the board or a slot of an
+//   earlier depth is found)
+// - param 1: the child
+// - param 2: the Result (its duplicates counter is updated)
+// - return: nothing
+void BeamSearch::addChild(const Node& child, Result& result)
+{
+	if (children.size() * 2 >= table.size())
+	{
+		growTable();
+	}
+	const std::uint64_t key = hashBoard(child.rows);
+	const std::size_t mask = table.size() - 1;
+	for (std::size_t slot = key & mask; ; slot = (slot + 1) & mask)
+	{
+		Entry& entry = table[slot];
+		if (entry.stamp != stamp)
+		{
+			entry.key = key;
+			entry.stamp = stamp;
+			entry.node = static_cast<int>(children.size());
+			children.push_back(child);
+			return;
+		}
+		if (entry.key == key)
+		{
+			result.duplicates++;
+			if (child.value > children[entry.node].value)
+			{
+				children[entry.node] = child;
+			}
+			return;
+		}
+	}
+}
+
+// double the transposition table & put the current depth's children back in it
+// - return: nothing
+void BeamSearch::growTable()
+{
+	table.assign(table.size() * 2, Entry{});
+	const std::size_t mask = table.size() - 1;
+	for (std::size_t c{ 0 }; c < children.size(); c++)
+	{
+		const std::uint64_t key = hashBoard(children[c].rows);
+		std::size_t slot = key & mask;
+		while (table[slot].stamp == stamp)
+		{
+			slot = (slot + 1) & mask;
+		}
+		table[slot].key = key;
+		table[slot].stamp = stamp;
+		table[slot].node = static_cast<int>(c);
+	}
+}
@@ -0,0 +1,120 @@
+// A BeamSearch looks ahead over the known pieces (the current shape, the preview)
+// to choose where the current shape should lock.
+//
+// Each depth places the next piece on every board the beam holds: the MoveGenerator
+// lists its lock positions (tucks & spins included) and the Evaluator scores the
+// boards they leave.  Only the best beamWidth boards are expanded at the next depth,
+// so the cost grows linearly with the number of pieces, not exponentially.
+//
+// A board's value is the score of its last placement, plus the landing height &
+// removed rows terms of the placements before it (the earlier boards' shapes no
+// longer matter, what they cost & earned on the way does).
+//
+// Different placement sequences often build the same board (eg: two pieces placed
+// in either order).  A transposition table keyed on the board's Zobrist hash keeps
+// only the best valued copy of each board at a depth, so the beam isn't filled with
+// duplicates.
+//
+// The search stops at its deadline: the answer is the best sequence of the deepest
+// depth it completed.  The first depth (the current shape's own placements) is
+// always completed, so there is always an answer if the shape can be placed.
+
+#ifndef BEAMSEARCH_H
+#define BEAMSEARCH_H
+
+#include "Evaluator.h"
+#include "MoveGenerator.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class BeamSearch
+{
+	friend class TestSuite;
+public:
+	typedef MoveGenerator::Board Board;
+	typedef Evaluator::Rows Rows;
+	typedef std::chrono::steady_clock Clock;
+
+	static constexpr int DEFAULT_BEAM_WIDTH = 64;	// the boards kept at each depth
+
+	// the outcome of a search
+	struct Result
+	{
+		bool found{ false };				// false if the first piece can't be placed
+		MoveGenerator::Move move;			// where the first piece should lock
+		double value{ 0 };					// the value of the best sequence
+		int depth{ 0 };						// the pieces the best sequence places (the depths completed)
+		std::size_t nodes{ 0 };				// the boards made
+		std::size_t duplicates{ 0 };		// the boards the transposition table merged
+	};
+
+private:
+	// a board in the beam
+	struct Node
+	{
+		Rows rows{};			// the occupancy
+		double carried{ 0 };	// the landing height & removed rows terms of its placements
+		double value{ 0 };		// carried + the score of its last placement
+		int root{ 0 };			// the index of the first piece's Move it descends from
+	};
+
+	// a transposition table slot: a board made at the current depth
+	struct Entry
+	{
+		std::uint64_t key{ 0 };		// the board's Zobrist hash
+		std::uint32_t stamp{ 0 };	// the depth stamp it was made at (stale if not the current one)
+		int node{ 0 };				// its index into children
+	};
+
+	Evaluator evaluator;				// scores the boards
+	int beamWidth;						// the boards kept at each depth
+	MoveGenerator generator;			// lists the lock positions of each board
+	std::vector<MoveGenerator::Move> rootMoves;	// the first piece's lock positions
+	std::vector<Node> beam;				// the boards being expanded
+	std::vector<Node> children;			// the boards they make
+	std::vector<Entry> table;			// the transposition table (a power of 2 slots)
+	std::uint32_t stamp{ 0 };			// the current depth's stamp (a new one per depth searched)
+
+public:
+	// constructor (the default Evaluator weights)
+	// - param 1: the boards kept at each depth
+	explicit BeamSearch(int beamWidth = DEFAULT_BEAM_WIDTH);
+
+	// constructor
+	// - param 1: the boards kept at each depth
+	// - param 2: the Evaluator weights
+	BeamSearch(int beamWidth, const Evaluator::Weights& weights);
+
+	// the boards kept at each depth
+	int getBeamWidth() const { return beamWidth; }
+
+	// search for where the first of a sequence of pieces should lock
+	// - param 1: the board
+	// - param 2: the pieces (the current shape first, then the preview), each
+	//            spawned at the board's spawn location in its spawn rotation
+	// - param 3: the time to stop by
+	// - return: the Result
+	Result search(const Board& board, const std::vector<TetShape>& pieces, Clock::time_point deadline);
+
+private:
+	// place a piece on every board of the beam & keep the distinct children
+	// - param 1: the piece
+	// - param 2: the piece's spawn location
+	// - param 3: the time to stop by (checked between boards, unless the beam is the root)
+	// - param 4: the Result (its counters are updated)
+	// - return: bool, false if the deadline passed before every board was expanded
+	bool expand(TetShape piece, const Point& spawnLoc, Clock::time_point deadline, Result& result);
+
+	// add a child board unless the transposition table has a better copy of it
+	// - param 1: the child
+	// - param 2: the Result (its duplicates counter is updated)
+	// - return: nothing
+	void addChild(const Node& child, Result& result);
+
+	// double the transposition table & put the current depth's children back in it
+	// - return: nothing
+	void growTable();
+};
+
+#endif /* BEAMSEARCH_H */
@@ -0,0 +1,59 @@
+// Bit scanning & counting helpers for the bitboard code (the move generator walks
+// the set bits of its position words, the evaluator counts cells in board rows).
+//
+// They compile to a single instruction on GCC, Clang & MSVC when the target has
+// one, with a portable fallback otherwise.
+
+#ifndef BITS_H
+#define BITS_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace Bits
+{
+	// the index of the lowest set bit (the value must not be 0)
+	// - param 1: the value
+	// - return: int, [0, 64)
+	inline int countTrailingZeros(std::uint64_t value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return static_cast<int>(index);
+#else
+		int index{ 0 };
+		while ((value & 1) == 0)
+		{
+			value >>= 1;
+			index++;
+		}
+		return index;
+#endif
+	}
+
+	// the number of set bits
+	// - param 1: the value
+	// - return: int, [0, 32]
+	inline int popCount(std::uint32_t value)
+	{
+#if defined(__POPCNT__)
+		return __builtin_popcount(value);
+#elif defined(_MSC_VER) && defined(__AVX__)
+		return static_cast<int>(__popcnt(value));
+#else
+		// (without the popcnt instruction the builtin is a library call, this is faster)
+		value = value - ((value >> 1) & 0x55555555u);
+		value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+		value = (value + (value >> 4)) & 0x0F0F0F0Fu;
+		return static_cast<int>((value * 0x01010101u) >> 24);
+#endif
+	}
+}
+
+#endif /* BITS_H */
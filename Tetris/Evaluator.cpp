@@ -0,0 +1,190 @@
+#include "Evaluator.h"
+#include "Bits.h"
+#include <cstdlib>
+
+namespace
+{
+	typedef Evaluator::Board Board;
+
+	constexpr std::uint32_t COLUMNS = Board::FULL_ROW;						// a bit for every column
+	constexpr std::uint32_t WALLS = 1u | (1u << (Board::MAX_X + 1));		// the walls of a walled row
+	constexpr std::uint32_t WALLED_EDGES = (1u << (Board::MAX_X + 1)) - 1;	// the edges between walled row cells
+}
+
+// constructor (the default Weights)
+Evaluator::Evaluator() : Evaluator{ Weights{} }
+{
+}
+
+// constructor
+// - param 1: the feature weights
+Evaluator::Evaluator(const Weights& weights) : weights{ weights }
+{
+}
+
+// copy the occupancy of a board
+// - param 1: the board
+// - param 2: the Rows to fill
+// - return: nothing
+void Evaluator::getRows(const Board& board, Rows& rows)
+{
+	for (int y{ 0 }; y < Board::MAX_Y; y++)
+	{
+		rows[y] = board.getRow(y);
+	}
+}
+
+// make the candidate a placement leaves behind: OR the shape's blocks into a
+// copy of the rows and remove the completed rows
+//   Blocks above the top row are dropped, as the engine drops them when a shape
+//   locks there.  The surviving rows are moved down over the completed ones from
+//   the bottom up, and the rows left over at the top are cleared.
+// - param 1: the occupancy before the placement
+// - param 2: the shape
+// - param 3: the lock position (it must fit)
+// - param 4: the Candidate to fill
+// - return: nothing
+void Evaluator::place(const Rows& rows, TetShape shape, const MoveGenerator::Move& move, Candidate& candidate)
+{
+	const RotationState& state = Tetromino::getRotationState(shape, move.rotation);
+	Rows placed = rows;
+	for (const Point& block : state.blocks)
+	{
+		if (move.y + block.getY() >= 0)
+		{
+			placed[move.y + block.getY()] |= static_cast<Row>(1u << (move.x + block.getX()));
+		}
+	}
+
+	// the middle of the shape, counted up from the bottom row
+	const int bottom = Board::MAX_Y - 1 - (move.y + state.minY + state.height - 1);
+	candidate.landingHeight = bottom + (state.height - 1) / 2.0;
+
+	int target{ Board::MAX_Y - 1 };
+	for (int y{ Board::MAX_Y - 1 }; y >= 0; y--)
+	{
+		if (placed[y] != Board::FULL_ROW)
+		{
+			candidate.rows[target--] = placed[y];
+		}
+	}
+	candidate.removedRows = target + 1;
+	for (; target >= 0; target--)
+	{
+		candidate.rows[target] = 0;
+	}
+}
+
+// compute the features of a candidate
+//   One pass from the top row down, keeping the columns with a block above the
+//   current row ("covered"):
+//   - a row's holes are its empty covered cells, its open cells are the rest,
+//   - the columns whose surface is in the row are its occupied uncovered cells (the
+//     only place the columns are visited one by one, to record their heights),
+//   - the row padded with walls XOR-ed with itself shifted by one marks its row
+//     transitions, and the row XOR-ed with the row below marks the column
+//     transitions between them (the floor is a full row),
+//   - a row's well cells are its open cells with occupied cells (or walls) on both
+//     sides; each column counts the depth of the well it is in, so a well cell of
+//     depth d adds d (a well of depth n adds 1 + 2 + ... + n).
+// - param 1: the Candidate
+// - return: the Features
+Evaluator::Features Evaluator::getFeatures(const Candidate& candidate)
+{
+	Features features;
+	features.landingHeight = candidate.landingHeight;
+	features.removedRows = candidate.removedRows;
+
+	int heights[Board::MAX_X]{};
+	int wellDepths[Board::MAX_X]{};
+	std::uint32_t covered{ 0 };
+	std::uint32_t wells{ 0 };
+	for (int y{ 0 }; y < Board::MAX_Y; y++)
+	{
+		const std::uint32_t row = candidate.rows[y];
+		const std::uint32_t below = y + 1 < Board::MAX_Y ? candidate.rows[y + 1] : COLUMNS;
+		const std::uint32_t walled = (row << 1) | WALLS;
+		const std::uint32_t open = ~(row | covered) & COLUMNS;
+
+		features.holes += Bits::popCount(covered & ~row & COLUMNS);
+		features.rowTransitions += Bits::popCount((walled ^ (walled >> 1)) & WALLED_EDGES);
+		features.columnTransitions += Bits::popCount(row ^ below);
+
+		for (std::uint32_t surface = row & ~covered; surface != 0; surface &= surface - 1)
+		{
+			heights[Bits::countTrailingZeros(surface)] = Board::MAX_Y - y;
+		}
+
+		// the cell left of column x is bit x of the walled row, the cell right of it is bit x + 2
+		const std::uint32_t rowWells = open & walled & (walled >> 2);
+		for (std::uint32_t ended = wells & ~rowWells; ended != 0; ended &= ended - 1)
+		{
+			wellDepths[Bits::countTrailingZeros(ended)] = 0;
+		}
+		for (std::uint32_t cells = rowWells; cells != 0; cells &= cells - 1)
+		{
+			features.wellSums += ++wellDepths[Bits::countTrailingZeros(cells)];
+		}
+		wells = rowWells;
+		covered |= row;
+	}
+
+	for (int x{ 0 }; x < Board::MAX_X; x++)
+	{
+		features.aggregateHeight += heights[x];
+		if (x > 0)
+		{
+			features.bumpiness += std::abs(heights[x] - heights[x - 1]);
+		}
+	}
+	return features;
+}
+
+// the weighted sum of a candidate's features
+// - param 1: the Features
+// - return: the score (higher is better)
+double Evaluator::score(const Features& features) const
+{
+	return weights.aggregateHeight * features.aggregateHeight
+		+ weights.holes * features.holes
+		+ weights.bumpiness * features.bumpiness
+		+ weights.rowTransitions * features.rowTransitions
+		+ weights.columnTransitions * features.columnTransitions
+		+ weights.wellSums * features.wellSums
+		+ weights.landingHeight * features.landingHeight
+		+ weights.removedRows * features.removedRows;
+}
+
+// score a batch of candidates
+// - param 1: the first Candidate
+// - param 2: the number of candidates
+// - param 3: an array of (at least) that many scores to fill
+// - return: nothing
+void Evaluator::scoreAll(const Candidate* batch, std::size_t count, double* scores) const
+{
+	for (std::size_t c{ 0 }; c < count; c++)
+	{
+		scores[c] = score(getFeatures(batch[c]));
+	}
+}
+
+// score every lock position of a shape on a board (eg: the Moves of a MoveGenerator)
+//   The board's Rows are copied once and every candidate is made from them.
+// - param 1: the board
+// - param 2: the shape
+// - param 3: the lock positions
+// - param 4: a vector to fill with one score per Move (it is resized)
+// - return: nothing
+void Evaluator::scoreMoves(const Board& board, TetShape shape, const std::vector<MoveGenerator::Move>& moves,
+	std::vector<double>& scores)
+{
+	Rows rows;
+	getRows(board, rows);
+	candidates.resize(moves.size());
+	for (std::size_t m{ 0 }; m < moves.size(); m++)
+	{
+		place(rows, shape, moves[m], candidates[m]);
+	}
+	scores.resize(moves.size());
+	scoreAll(candidates.data(), candidates.size(), scores.data());
+}
@@ -0,0 +1,142 @@
+// An Evaluator scores the board a placement leaves behind, for bots: the higher the
+// score, the better the placement.  The score is a weighted sum of the standard
+// board features:
+//   - aggregate height:    the sum of the column heights
+//   - holes:               empty cells with an occupied cell somewhere above them
+//   - bumpiness:           the sum of the height differences of neighbouring columns
+//   - row transitions:     occupied/empty changes along each row (the walls count as occupied)
+//   - column transitions:  occupied/empty changes down each column (the floor counts as occupied)
+//   - well sums:           for each well (open cells with occupied cells or walls on
+//                          both sides), 1 + 2 + ... + its depth
+//   - landing height:      the height of the middle of the placed shape
+//   - removed rows:        the rows the placement completed
+//
+// The features are computed from the occupancy bits only, a whole row at a time:
+// the cells above the stack, the holes, the transitions & the wells of a row are a
+// few shifts, ANDs and a popcount, and the columns are only visited one by one
+// where their surface is.  Candidates are plain arrays of Rows (no colors), so a
+// bot can make one per lock position from its parent's Rows with a few ORs and
+// score a whole batch of them in one call.
+
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include "MoveGenerator.h"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class Evaluator
+{
+public:
+	typedef TetrisEngine::Board Board;
+	typedef Board::Row Row;
+
+	// the occupancy of a board, one Row per row (index 0 is the top row)
+	typedef std::array<Row, Board::MAX_Y> Rows;
+
+	// the board a placement leaves behind
+	struct Candidate
+	{
+		Rows rows{};				// the occupancy, after the completed rows were removed
+		double landingHeight{ 0 };	// the height of the middle of the placed shape (0: the bottom row)
+		int removedRows{ 0 };		// the rows the placement completed
+	};
+
+	// the features of a candidate
+	struct Features
+	{
+		int aggregateHeight{ 0 };
+		int holes{ 0 };
+		int bumpiness{ 0 };
+		int rowTransitions{ 0 };
+		int columnTransitions{ 0 };
+		int wellSums{ 0 };
+		double landingHeight{ 0 };
+		int removedRows{ 0 };
+	};
+
+	// the weight of each feature in the score
+	//   (the defaults are the El-Tetris weights for Dellacherie's features)
+	struct Weights
+	{
+		double aggregateHeight{ 0 };
+		double holes{ -7.899265427351652 };
+		double bumpiness{ 0 };
+		double rowTransitions{ -3.2178882868487753 };
+		double columnTransitions{ -9.348695305445199 };
+		double wellSums{ -3.3855972247263626 };
+		double landingHeight{ -4.500158825082766 };
+		double removedRows{ 3.4181268101392694 };
+	};
+
+private:
+	Weights weights;	// the weights of the score
+
+	// scoreMoves() scratch (kept between calls so batches don't allocate)
+	std::vector<Candidate> candidates;
+
+public:
+	// constructor (the default Weights)
+	Evaluator();
+
+	// constructor
+	// - param 1: the feature weights
+	explicit Evaluator(const Weights& weights);
+
+	// the feature weights
+	const Weights& getWeights() const { return weights; }
+
+	// change the feature weights
+	// - param 1: the Weights
+	// - return: nothing
+	void setWeights(const Weights& newWeights) { weights = newWeights; }
+
+	// copy the occupancy of a board
+	// - param 1: the board
+	// - param 2: the Rows to fill
+	// - return: nothing
+	static void getRows(const Board& board, Rows& rows);
+
+	// make the candidate a placement leaves behind: OR the shape's blocks into a
+	// copy of the rows and remove the completed rows
+	// - param 1: the occupancy before the placement
+	// - param 2: the shape
+	// - param 3: the lock position (it must fit)
+	// - param 4: the Candidate to fill
+	// - return: nothing
+	static void place(const Rows& rows, TetShape shape, const MoveGenerator::Move& move, Candidate& candidate);
+
+	// compute the features of a candidate
+	// - param 1: the Candidate
+	// - return: the Features
+	static Features getFeatures(const Candidate& candidate);
+
+	// the weighted sum of a candidate's features
+	// - param 1: the Features
+	// - return: the score (higher is better)
+	double score(const Features& features) const;
+
+	// score a candidate
+	// - param 1: the Candidate
+	// - return: the score (higher is better)
+	double score(const Candidate& candidate) const { return score(getFeatures(candidate)); }
+
+	// score a batch of candidates
+	// - param 1: the first Candidate
+	// - param 2: the number of candidates
+	// - param 3: an array of (at least) that many scores to fill
+	// - return: nothing
+	void scoreAll(const Candidate* batch, std::size_t count, double* scores) const;
+
+	// score every lock position of a shape on a board (eg: the Moves of a MoveGenerator)
+	// - param 1: the board
+	// - param 2: the shape
+	// - param 3: the lock positions
+	// - param 4: a vector to fill with one score per Move (it is resized)
+	// - return: nothing
+	void scoreMoves(const Board& board, TetShape shape, const std::vector<MoveGenerator::Move>& moves,
+		std::vector<double>& scores);
+};
+
+#endif /* EVALUATOR_H */
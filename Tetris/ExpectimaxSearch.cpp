@@ -0,0 +1,220 @@
+#include "ExpectimaxSearch.h"
+#include "PieceGenerator.h"
+#include "Random.h"
+#include "Zobrist.h"
+#include <algorithm>
+
+const double ExpectimaxSearch::TOPPED_OUT = -1e12;
+
+namespace
+{
+	const int FULL_BAG = (1 << PieceGenerator::SHAPE_COUNT) - 1;	// a new bag: every shape
+}
+
+// constructor (the default Evaluator weights)
+// - param 1: the unknown pieces averaged over at most
+ExpectimaxSearch::ExpectimaxSearch(int maxUnknown) : maxUnknown{ maxUnknown }
+{
+}
+
+// constructor
+// - param 1: the unknown pieces averaged over at most
+// - param 2: the Evaluator weights
+// - param 3: the log2 of the transposition table's slot count
+ExpectimaxSearch::ExpectimaxSearch(int maxUnknown, const Evaluator::Weights& weights, int tableSizeLog2)
+	: evaluator{ weights }, maxUnknown{ maxUnknown }, table{ tableSizeLog2 }
+{
+}
+
+// search for where the first of the known pieces should lock
+//   1) place the first piece everywhere it can lock
+//   2) search each placement with the known pieces alone, then averaging over one
+//      unknown piece more each time, up to maxUnknown or until the deadline passes
+//      (the known pieces alone ignore the deadline)
+//   3) the answer is the best placement of the deepest depth completed (ties go to
+//      the first placement generated)
+// - param 1: the board
+// - param 2: the known pieces (the current shape first, then the preview), each
+//            spawned at the board's spawn location in its spawn rotation
+// - param 3: the bag the first unknown piece is dealt from: a bitmask, bit s set if
+//            TetShape s is still in it (PieceGenerator::getBagRemaining()), or UNIFORM
+// - param 4: the time to stop by
+// - return: the Result
+ExpectimaxSearch::Result ExpectimaxSearch::search(const Board& board, const std::vector<TetShape>& pieces, int bag,
+	Clock::time_point deadline)
+{
+	Result searchResult;
+	if (pieces.empty())
+	{
+		return searchResult;
+	}
+	known = pieces;
+	knownKeys.assign(known.size() + 1, 0x3A1F0C7Eull);
+	for (int ply{ static_cast<int>(known.size()) - 1 }; ply >= 0; ply--)
+	{
+		knownKeys[ply] = Random::mix(knownKeys[ply + 1] ^ (static_cast<std::uint64_t>(known[ply]) + 1));
+	}
+	spawnLoc = board.getSpawnLoc();
+	this->deadline = deadline;
+	checkDeadline = false;
+	aborted = false;
+	result = &searchResult;
+	generators.resize(known.size() + std::max(maxUnknown, 0));
+
+	// 1) the first piece's placements
+	Rows rows;
+	Evaluator::getRows(board, rows);
+	GridTetromino spawned;
+	spawned.setShape(known[0]);
+	spawned.setGridLoc(spawnLoc);
+	const std::vector<MoveGenerator::Move>& rootMoves = generators[0].generate(rows.data(), spawned);
+	const int rootCount = static_cast<int>(rootMoves.size());
+	if (rootCount == 0)
+	{
+		result = nullptr;
+		return searchResult;
+	}
+	std::vector<Evaluator::Candidate> rootBoards(rootCount);
+	std::vector<double> carried(rootCount);
+	std::vector<double> values(rootCount);
+	std::vector<double> finalScores(rootCount);
+	for (int r{ 0 }; r < rootCount; r++)
+	{
+		Evaluator::place(rows, known[0], rootMoves[r], rootBoards[r]);
+		const Evaluator::Features features = Evaluator::getFeatures(rootBoards[r]);
+		finalScores[r] = evaluator.score(features);
+		carried[r] = evaluator.getWeights().landingHeight * features.landingHeight
+			+ evaluator.getWeights().removedRows * features.removedRows;
+	}
+	searchResult.nodes = rootCount;
+
+	// 2) the depths
+	const int knownCount = static_cast<int>(known.size());
+	for (int unknown{ 0 }; unknown <= maxUnknown; unknown++)
+	{
+		checkDeadline = unknown > 0;
+		for (int r{ 0 }; r < rootCount && !aborted; r++)
+		{
+			values[r] = (knownCount == 1 && unknown == 0) ? finalScores[r]
+				: carried[r] + getNodeValue(rootBoards[r].rows, 1, unknown, bag);
+		}
+		if (aborted)
+		{
+			break;
+		}
+
+		// 3) this depth's best placement
+		const int best = static_cast<int>(std::max_element(values.begin(), values.end()) - values.begin());
+		searchResult.found = true;
+		searchResult.move = rootMoves[best];
+		searchResult.value = values[best];
+		searchResult.unknown = unknown;
+	}
+	result = nullptr;
+	return searchResult;
+}
+
+// the value of a node: the pieces [ply, known) & then unknown more still to place
+//   A known piece is a max node.  An unknown piece is a chance node: the average
+//   of the best placement of every shape the bag can deal (each leaving the bag).
+//   Only completed values are stored.
+// - param 1: the board
+// - param 2: the index of the next known piece (known.size() once they're placed)
+// - param 3: the unknown pieces still to average over
+// - param 4: the bag the next unknown piece is dealt from (or UNIFORM)
+// - return: the value (meaningless if the search was aborted)
+double ExpectimaxSearch::getNodeValue(const Rows& rows, int ply, int unknown, int bag)
+{
+	if (checkDeadline && (aborted || Clock::now() >= deadline))
+	{
+		aborted = true;
+		return 0;
+	}
+	const std::uint64_t key = Zobrist::hashRows<Board::MAX_X, Board::MAX_Y>(rows.data()) ^ knownKeys[ply]
+		^ Random::mix((static_cast<std::uint64_t>(unknown) << 8) + static_cast<std::uint64_t>(bag) + 0xE4B1ull);
+	double value;
+	if (table.probe(key, value))
+	{
+		result->tableHits++;
+		return value;
+	}
+
+	const int knownCount = static_cast<int>(known.size());
+	if (ply < knownCount)
+	{
+		value = getBestPlacement(rows, known[ply], ply, ply + 1, unknown, bag);
+	}
+	else
+	{
+		// the chance node's level: unknown only decreases below it, so every level is used once per line
+		const int level = knownCount + maxUnknown - unknown;
+		const int shapes = (bag == UNIFORM) ? FULL_BAG : bag;
+		double sum{ 0 };
+		int count{ 0 };
+		for (int shape{ 0 }; shape < PieceGenerator::SHAPE_COUNT; shape++)
+		{
+			if ((shapes & (1 << shape)) == 0)
+			{
+				continue;
+			}
+			int nextBag{ UNIFORM };
+			if (bag != UNIFORM)
+			{
+				nextBag = bag & ~(1 << shape);
+				nextBag = (nextBag == 0) ? FULL_BAG : nextBag;
+			}
+			sum += getBestPlacement(rows, static_cast<TetShape>(shape), level, ply, unknown - 1, nextBag);
+			count++;
+		}
+		value = sum / count;
+	}
+	if (aborted)
+	{
+		return 0;
+	}
+	table.store(key, value);
+	return value;
+}
+
+// the best value of placing one piece, then the rest of the node's pieces
+//   (the placement's own landing height & removed rows terms included; the last
+//   piece of a line is worth its board's full score)
+// - param 1: the board
+// - param 2: the piece
+// - param 3: the pieces placed before it (its level)
+// - param 4: the index of the next known piece after it
+// - param 5: the unknown pieces still to average over after it
+// - param 6: the bag the next unknown piece is dealt from (or UNIFORM)
+// - return: the value (TOPPED_OUT if the piece can't be placed)
+double ExpectimaxSearch::getBestPlacement(const Rows& rows, TetShape piece, int level, int ply, int unknown, int bag)
+{
+	const Evaluator::Weights& weights = evaluator.getWeights();
+	const bool last = ply >= static_cast<int>(known.size()) && unknown == 0;
+	GridTetromino spawned;
+	spawned.setShape(piece);
+	spawned.setGridLoc(spawnLoc);
+	Evaluator::Candidate candidate;
+	double best{ TOPPED_OUT };
+	for (const MoveGenerator::Move& move : generators[level].generate(rows.data(), spawned))
+	{
+		Evaluator::place(rows, piece, move, candidate);
+		result->nodes++;
+		const Evaluator::Features features = Evaluator::getFeatures(candidate);
+		double value;
+		if (last)
+		{
+			value = evaluator.score(features);
+		}
+		else
+		{
+			value = weights.landingHeight * features.landingHeight + weights.removedRows * features.removedRows
+				+ getNodeValue(candidate.rows, ply, unknown, bag);
+			if (aborted)
+			{
+				return 0;
+			}
+		}
+		best = std::max(best, value);
+	}
+	return best;
+}
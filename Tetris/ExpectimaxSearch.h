@@ -0,0 +1,120 @@
+// An ExpectimaxSearch looks ahead past the known pieces (the current shape, the
+// preview) to choose where the current shape should lock, averaging over the pieces
+// that could be dealt after them.
+//
+// The known pieces are max nodes: every lock position is tried and the best one
+// counts.  Each unknown piece is a chance node: the value is the average, over the
+// shapes that could be dealt, of the best placement of that shape.  The shapes are
+// equally likely, or - when the game deals from a 7-bag - only the shapes the bag
+// still holds can come, and each one drawn leaves the bag (a new bag of 7 follows
+// an empty one).  The HISTORY generator's re-rolls are treated as uniform.
+//
+// A sequence's value is the BeamSearch's: the score of the last board plus the
+// landing height & removed rows terms of the placements before it, and a piece
+// that can't be placed is worth TOPPED_OUT.
+//
+// Every node's value only depends on the board, the pieces still known, the unknown
+// pieces still to average over and the bag, so it is memoized in a
+// TranspositionTable keyed on the board's Zobrist hash & those, and entries stay
+// valid from one search to the next.
+//
+// The unknown pieces are searched in turn (iterative deepening: none, one, two ...)
+// up to a maximum, until the deadline passes.  The answer is the best placement of
+// the deepest depth completed - the known pieces alone are always completed.
+
+#ifndef EXPECTIMAXSEARCH_H
+#define EXPECTIMAXSEARCH_H
+
+#include "Evaluator.h"
+#include "MoveGenerator.h"
+#include "TranspositionTable.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class ExpectimaxSearch
+{
+	friend class TestSuite;
+public:
+	typedef MoveGenerator::Board Board;
+	typedef Evaluator::Rows Rows;
+	typedef std::chrono::steady_clock Clock;
+
+	static const double TOPPED_OUT;				// the value of a sequence with a piece that can't be placed, init to -1e12
+	static constexpr int UNIFORM = 0;			// the bag of uniformly dealt shapes (none is ever used up)
+	static constexpr int DEFAULT_MAX_UNKNOWN = 1;	// the unknown pieces averaged over at most
+
+	// the outcome of a search
+	struct Result
+	{
+		bool found{ false };			// false if the first piece can't be placed
+		MoveGenerator::Move move;		// where the first piece should lock
+		double value{ 0 };				// the expected value of the best placement
+		int unknown{ 0 };				// the unknown pieces it was averaged over (the depths completed)
+		std::size_t nodes{ 0 };			// the boards made
+		std::size_t tableHits{ 0 };		// the nodes the transposition table already had a value for
+	};
+
+private:
+	Evaluator evaluator;				// scores the boards
+	int maxUnknown;						// the unknown pieces averaged over at most
+	TranspositionTable table;			// the memoized node values (kept between searches)
+	std::vector<MoveGenerator> generators;	// one per piece placed (each level's Moves stay valid below it)
+
+	// the search in progress
+	std::vector<TetShape> known;		// the known pieces
+	std::vector<std::uint64_t> knownKeys;	// [ply] -> the key of the known pieces [ply, known)
+	Point spawnLoc;						// where every piece spawns
+	Clock::time_point deadline;			// the time to stop by
+	bool checkDeadline{ false };		// false while the known pieces alone are searched
+	bool aborted{ false };				// set when the deadline passes
+	Result* result{ nullptr };			// the counters of the search in progress
+
+public:
+	// constructor (the default Evaluator weights)
+	// - param 1: the unknown pieces averaged over at most
+	explicit ExpectimaxSearch(int maxUnknown = DEFAULT_MAX_UNKNOWN);
+
+	// constructor
+	// - param 1: the unknown pieces averaged over at most
+	// - param 2: the Evaluator weights
+	// - param 3: the log2 of the transposition table's slot count
+	ExpectimaxSearch(int maxUnknown, const Evaluator::Weights& weights,
+		int tableSizeLog2 = TranspositionTable::DEFAULT_SIZE_LOG2);
+
+	// the unknown pieces averaged over at most
+	int getMaxUnknown() const { return maxUnknown; }
+
+	// search for where the first of the known pieces should lock
+	// - param 1: the board
+	// - param 2: the known pieces (the current shape first, then the preview), each
+	//            spawned at the board's spawn location in its spawn rotation
+	// - param 3: the bag the first unknown piece is dealt from: a bitmask, bit s set if
+	//            TetShape s is still in it (PieceGenerator::getBagRemaining()), or UNIFORM
+	// - param 4: the time to stop by
+	// - return: the Result
+	Result search(const Board& board, const std::vector<TetShape>& pieces, int bag, Clock::time_point deadline);
+
+private:
+	// the value of a node: the pieces [ply, known) & then unknown more still to place
+	//   (memoized; meaningless if the search was aborted)
+	// - param 1: the board
+	// - param 2: the index of the next known piece (known.size() once they're placed)
+	// - param 3: the unknown pieces still to average over
+	// - param 4: the bag the next unknown piece is dealt from (or UNIFORM)
+	// - return: the value
+	double getNodeValue(const Rows& rows, int ply, int unknown, int bag);
+
+	// the best value of placing one piece, then the rest of the node's pieces
+	//   (the placement's own landing height & removed rows terms included)
+	// - param 1: the board
+	// - param 2: the piece
+	// - param 3: the pieces placed before it (its level)
+	// - param 4: the index of the next known piece after it
+	// - param 5: the unknown pieces still to average over after it
+	// - param 6: the bag the next unknown piece is dealt from (or UNIFORM)
+	// - return: the value (TOPPED_OUT if the piece can't be placed)
+	double getBestPlacement(const Rows& rows, TetShape piece, int level, int ply, int unknown, int bag);
+};
+
+#endif /* EXPECTIMAXSEARCH_H */
@@ -26,6 +26,29 @@
 // - The array contains content(integers) which represent either :
 //    - an EMPTY_BLOCK(-1),
 //    - a color from the Tetromino::TetColor enum.
+// - The grid is stored as two planes :
+//    - an occupancy bitboard (one Row word per row, bit x set when column x
+//      holds content). Occupancy queries (areAllLocsEmpty, isRowCompleted, ...)
+//      only touch this plane, so they become mask ANDs and a completed row is
+//      a single compare against FULL_ROW.
+//    - a compact color plane (one signed char per cell) that is only read when
+//      the actual content is needed (getContent, printToConsole).
+//   Every write goes through setContent/fillRow/copyRowIntoRow which keep the
+//   two planes in sync.
+// - Writes are dirty tracked: the board keeps a generation counter that every
+//      write advances, and stamps each written row with it.  An observer (eg: a
+//      renderer caching the locked cells) remembers the generation it last saw and
+//      asks getChangedRowsSince() which rows it needs to refresh.
+// - The height of every column's surface is kept up to date by the same writes
+//      (a filled cell can only raise it, only emptying a column's top cell means
+//      looking further down), so landing positions can be found without probing.
+// - Two 64 bit Zobrist hashes (see Zobrist.h) are kept up to date by the same writes,
+//      so reading them is O(1): one of the content (occupancy & colors), and one of
+//      the occupancy alone (the one searches use, colors don't change a decision).
+// - place() locks a set of cells & removes the rows they complete, returning an
+//      UndoRecord of just the cells written & the rows removed; undo() restores the
+//      board exactly from it (content, hashes & column heights).  So a depth first
+//      search can place & undo on one board instead of copying a board per trial.
 // - This 2D array is oriented with [0][0] at the top left and [MAX_Y][MAX_X] at the
 //      bottom right.  Why?  It makes the board much easier to draw the grid on the 
 //      screen later because this is the same way things are drawn on a screen 
@@ -43,6 +66,10 @@
 //		We are using abstraction to hide the details of implementation inside the class.
 //      If we call member functions that are public (eg : setContent(x, y, content))
 //      we can treat X and Y as we normally would,
+// - The board dimensions are template parameters (Gameboard<WIDTH, HEIGHT>), so the
+//      row mask, FULL_ROW and every loop bound are compile time constants and the
+//      row kernels can be unrolled.  Gameboard<> is the classic 10x19 board.
+//      The member definitions live in Gameboard.inl (included at the bottom of this file).
 //
 //  [expected .cpp size: ~ 225 lines (including method comments)]
 
@@ -51,29 +78,74 @@
 #define GAMEBOARD_H
 
 #include <vector>
+#include <cstdint>
+#include <type_traits>
+#include "Bits.h"
 #include "Point.h"
+#include "Zobrist.h"
 #include <iomanip>
 #include <iostream>
 #include <cassert>
 
+template<int WIDTH = 10, int HEIGHT = 19>
 class Gameboard
 {
-	friend int main();
 	friend class TestSuite;
 public:
 	// CONSTANTS
-	static const int MAX_X = 10;		// gameboard x dimension
-	static const int MAX_Y = 19;		// gameboard y dimension
-	static const int EMPTY_BLOCK = -1;	// contents of an empty block
+	static constexpr int MAX_X = WIDTH;		// gameboard x dimension
+	static constexpr int MAX_Y = HEIGHT;	// gameboard y dimension
+	static constexpr int EMPTY_BLOCK = -1;	// contents of an empty block
+	static_assert(MAX_X > 0 && MAX_Y > 0, "a gameboard needs at least one cell");
+
+	// one occupancy word per row (bit x represents column x)
+	//   (the smallest word that holds MAX_X bits)
+	typedef typename std::conditional<(MAX_X <= 16), std::uint16_t, std::uint32_t>::type Row;
+	static constexpr Row FULL_ROW = static_cast<Row>((std::uint64_t{ 1 } << MAX_X) - 1);	// every column occupied
+	static_assert(MAX_X <= 32, "a gameboard row must fit in a Row");
+
+	// a set of row indices (bit y represents row y)
+	typedef std::uint64_t RowSet;
+	static_assert(MAX_Y <= 64, "every gameboard row index must fit in a RowSet");
+	static_assert(MAX_Y <= 127, "every column height must fit in an UndoRecord");
+
+	static constexpr int MAX_PLACED_CELLS = 4;	// the most cells one place() writes (a tetromino's)
+
+	// what a place() changed - all undo() needs to restore the board
+	//   (fixed size, so placing & undoing never allocates)
+	struct UndoRecord
+	{
+		int cellCount{ 0 };								// the cells written
+		signed char cellX[MAX_PLACED_CELLS];			// their columns,
+		signed char cellY[MAX_PLACED_CELLS];			// rows (before the removal)
+		signed char oldContent[MAX_PLACED_CELLS];		// & content before the write
+		RowSet removedRows{ 0 };						// the rows completed & removed (indices before the removal)
+		signed char removedContent[MAX_PLACED_CELLS][MAX_X];	// their content, top row first
+		std::uint64_t contentHash;						// the hashes before the placement
+		std::uint64_t occupancyHash;
+		signed char columnHeights[MAX_X];				// the column heights before the placement
+	};
 
 private:
 	// MEMBER VARIABLES -------------------------------------------------
 
-	// the gameboard - a grid of X and Y offsets.  
+	// the occupancy bitboard - one Row per grid row.
+	//  (rows[0] is the top row, bit 0 is the leftmost column)
+	Row rows[MAX_Y]{};
+	// the color plane - a grid of X and Y offsets holding the content of each cell.
 	//  ([0][0] is top left, [MAX_Y-1][MAX_X-1] is bottom right) 
-	int grid[MAX_Y][MAX_X];
+	signed char grid[MAX_Y][MAX_X];
 	// the gameboard offset to spawn a new tetromino at.
-	const Point spawnLoc{ MAX_X / 2, 0 };
+	//  (not const, so boards can be assigned - eg: in engine snapshots)
+	Point spawnLoc{ MAX_X / 2, 0 };
+	// dirty tracking - the generation of the latest write, and of the latest write to each row.
+	std::uint64_t generation{ 0 };
+	std::uint64_t rowGenerations[MAX_Y];
+	// the height of each column's surface (MAX_Y - the row index of its highest occupied cell, 0 if empty)
+	int columnHeights[MAX_X]{};
+	// the Zobrist hashes of the content & of the occupancy (0 for an empty board)
+	std::uint64_t contentHash{ 0 };
+	std::uint64_t occupancyHash{ 0 };
 	
 public:	
 	// METHODS -------------------------------------------------
@@ -133,16 +205,94 @@ public:
 	// - return: true if the content at ALL VALID points is EMPTY_BLOCK, false otherwise
 	bool areAllLocsEmpty(const std::vector<Point>& locations) const;
 
+	// Determine if a block pattern can be placed on the board (allocation free).
+	//   The pattern is given as occupancy masks, one per row of its bounding box
+	//   (bit 0 of each mask is the box's left column).  This keeps the gameboard
+	//   free of any tetromino knowledge: callers pass the masks from the rotation table.
+	//   The rules match a legal tetromino position:
+	//    - the box must be inside the left, right & bottom borders,
+	//    - rows above the top border are allowed and never collide,
+	//    - every (valid) masked cell must be empty (a mask AND per row).
+	// - param 1: a pointer to maskHeight row masks
+	// - param 2: an int, the width of the pattern's bounding box
+	// - param 3: an int, the height of the pattern's bounding box
+	// - param 4: an int, the board column of the box's left edge
+	// - param 5: an int, the board row of the box's top edge
+	// - return: true if the pattern fits, false otherwise
+	bool isMaskPlaceable(const std::uint16_t* rowMasks, int maskWidth, int maskHeight, int left, int top) const;
+
+	// get the occupancy of a row (bit x set when column x holds content)
+	//   (lets bitboard clients - eg: a move generator - test many positions at once)
+	// - param 1: an int representing the row index (assert it is valid)
+	// - return: the row's Row word
+	Row getRow(int rowIndex) const;
+
 	// Remove all completed rows from the board
-	//   use getCompletedRowIndices() and removeRows() 
+	//   collect the completed rows into a RowSet and compactRows() them
+	//   (no vector of indices is built)
 	// - params: none
 	// - return: the count of completed rows removed
 	int removeCompletedRows();
 
+	// lock a set of cells & remove the rows they complete
+	//   (invalid cells are ignored, as in setContent; only the rows the cells
+	//   are in can be completed by them, so only those are tested)
+	// - param 1: a pointer to the cell offsets (at most MAX_PLACED_CELLS of them)
+	// - param 2: an int, the number of offsets
+	// - param 3: a Point, the board location the offsets are from
+	// - param 4: an int representing the content to write
+	// - return: the UndoRecord that undoes the placement
+	UndoRecord place(const Point* offsets, int count, const Point& origin, int content);
+
+	// undo the latest place() not yet undone
+	//   (undo in the reverse order of placing: the record must match the board)
+	//   put the removed rows back, restore the cells written, then the recorded
+	//   hashes & column heights (nothing is recomputed)
+	// - param 1: the UndoRecord place() returned
+	// - return: nothing
+	void undo(const UndoRecord& record);
+
+	// copy another board's content into this board
+	//   (unlike assignment, every row is written through the normal path, so this
+	//   board's generation keeps increasing and every row is reported as changed)
+	// - param 1: the board to copy
+	// - return: nothing
+	void copyContentFrom(const Gameboard& other);
+
 	// A getter for the spawn location
 	// - params: none
 	// - returns: a Point, representing our private spawnLoc
-	Point getSpawnLoc();
+	Point getSpawnLoc() const;
+
+	// the generation of the board's latest write (it only ever increases)
+	// - params: none
+	// - return: the generation
+	std::uint64_t getGeneration() const { return generation; }
+
+	// the rows written to after a given generation
+	//   (pass the getGeneration() value seen when the rows were last read)
+	// - param 1: the generation last seen
+	// - return: a RowSet of the rows changed since then
+	RowSet getChangedRowsSince(std::uint64_t seenGeneration) const;
+
+	// the height of a column's surface (kept up to date by every write)
+	//   the column's highest occupied cell is at row MAX_Y - height, and every
+	//   cell above it is empty.
+	// - param 1: an int representing x (assert it is valid)
+	// - return: an int, the height [0, MAX_Y] (0 if the column is empty)
+	int getColumnHeight(int x) const;
+
+	// the Zobrist hash of the board's content (the occupancy & the colors)
+	//   (kept up to date by every write, boards with equal content have equal hashes)
+	// - params: none
+	// - return: the hash (0 for an empty board)
+	std::uint64_t getHash() const { return contentHash; }
+
+	// the Zobrist hash of the board's occupancy alone (the colors are ignored)
+	//   (kept up to date by every write; the same as Zobrist::hashRows() of the rows)
+	// - params: none
+	// - return: the hash (0 for an empty board)
+	std::uint64_t getOccupancyHash() const { return occupancyHash; }
 
 private:  // This is commented out to allow us to test. 
 
@@ -157,8 +307,32 @@ private:  // This is commented out to allow us to test.
 	// - return: true if the x,y is a valid grid location, false otherwise
 	bool isValidPoint(int x, int y) const;
 
+	// the occupancy bit representing a given column within a Row
+	// - param 1: an int representing x
+	// - return: a Row with only the bit for column x set
+	static Row cellMask(int x) { return static_cast<Row>(1u << x); }
+
+	// record a write to a row (advance the generation & stamp the row with it)
+	// - param 1: an int representing the row index
+	// - return: nothing
+	void markRowChanged(int rowIndex) { rowGenerations[rowIndex] = ++generation; }
+
+	// bring the column heights up to date after a row's occupancy changed
+	//   newly occupied cells can only raise a column.  A column is only
+	//   searched (downwards) when the cell that was its top is emptied.
+	// - param 1: an int representing the row index
+	// - param 2: the row's occupancy before the write
+	// - return: nothing
+	void updateColumnHeights(int rowIndex, Row oldRow);
+
+	// the XOR of the content keys of a row's occupied cells
+	// - param 1: an int representing the row index
+	// - return: the hash
+	std::uint64_t getRowContentHash(int rowIndex) const;
+
 	// return a bool indicating if a given row is full (no EMPTY_BLOCK in the row)
 	// assert the row index is valid
+	// (the row's occupancy word is compared against FULL_ROW)
 	// - param 1: an int representing the row index we want to test
 	// - return: bool representing if the row is completed
 	bool isRowCompleted(int rowIndex) const;	
@@ -170,16 +344,24 @@ private:  // This is commented out to allow us to test.
 	void fillRow(int rowIndex, int content);
 	
 	// scan the board for completed rows.
-	// Iterate through grid rows and use isRowCompleted(rowIndex)
+	// Iterate through the occupancy rows and use isRowCompleted(rowIndex)
 	// - params: none
 	// - return: a vector of completed row indices (integers).
 	std::vector<int> getCompletedRowIndices() const;				
 
 	// copy a source row's contents into a target row.
+	//   (writeRow() the source's content & occupancy)
 	// - param 1: an int representing the source row index
 	// - param 2: an int representing the target row index
 	// - return: nothing
 	void copyRowIntoRow(int sourceRow, int targetRow);
+
+	// write a whole row (keeping the hashes, heights & generations up to date)
+	// - param 1: an int representing the row index
+	// - param 2: a pointer to the row's MAX_X contents
+	// - param 3: the row's occupancy (matching the contents)
+	// - return: nothing
+	void writeRow(int rowIndex, const signed char* content, Row occupancy);
 		
 	// In gameplay, when a full row is completed (filled with content)
 	// it gets "removed".  To be exact, the row itself is not removed
@@ -188,20 +370,34 @@ private:  // This is commented out to allow us to test.
 	// into the second row.  Finally, the first row is filled with EMPTY_BLOCK
 	// Given a row index:
 	//   1) Assert the row index is valid
-	//   2) Starting at rowIndex, copy each row above the removed
-	//     row "one-row-downwards" in the grid.
-	//     (loop from y=rowIndex-1 down to 0, and copyRowIntoRow(y, y+1)).
-	//   3) call fillRow() on the first row (and place EMPTY_BLOCKs in it).
+	//   2) compactRows() with a RowSet holding only that row.
 	// - param 1: an int representing a row index
 	// - return: nothing
 	void removeRow(int rowIndex);
 
 	// given a vector of row indices, remove them. 
-	//   Iterate through the vector, call removeRow() on each row index. 
+	//   All indices refer to the board as it was before any row was removed.
+	//   Collect them into a RowSet and compactRows() once.
 	// - param 1: a vector of integers representing row indices we want to remove
 	// - return: nothing
-	void removeRows(std::vector<int>& row);
+	void removeRows(std::vector<int>& rowIndices);
+
+	// remove a set of rows in a single bottom-up pass.
+	//   Walk from the bottom row up to the highest occupied row, copying each
+	//   surviving row directly into its final position (at most once), then
+	//   fill the vacated rows at the top of the stack with EMPTY_BLOCK.
+	//   Rows above the highest occupied row are already empty and are never touched.
+	// - param 1: a RowSet of the rows to remove
+	// - return: nothing
+	void compactRows(RowSet removedRows);
+
+	// find the highest (smallest index) row containing any content
+	// - params: none
+	// - return: an int, the row index (MAX_Y if the board is empty)
+	int getHighestOccupiedRow() const;
 };
 
+#include "Gameboard.inl"
+
 #endif /* GAMEBOARD_H */
 
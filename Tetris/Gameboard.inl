@@ -0,0 +1,649 @@
+// Member definitions for the Gameboard<WIDTH, HEIGHT> class template.
+// (included at the bottom of Gameboard.h)
+
+// constructor - empty() the grid
+//   (the color plane starts out EMPTY_BLOCK, so the hashes of the empty board are 0)
+template<int WIDTH, int HEIGHT>
+Gameboard<WIDTH, HEIGHT>::Gameboard()
+{
+	for (int y{ 0 }; y < MAX_Y; y++)
+	{
+		for (int x{ 0 }; x < MAX_X; x++)
+		{
+			grid[y][x] = static_cast<signed char>(EMPTY_BLOCK);
+		}
+	}
+	empty();
+}
+
+// fill the board with EMPTY_BLOCK 
+//   (iterate through each rowIndex and fillRow() with EMPTY_BLOCK))
+// - params: none
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::empty()
+{
+	for (int y{ 0 }; y < MAX_Y; y++)
+	{
+		fillRow(y, EMPTY_BLOCK);
+	}
+}
+
+// print the grid contents to the console (for debugging purposes)
+//   use std::setw(2) to space the contents out 
+//   (google it, you'll need to #include <iomanip>).
+//   If the content == EMPTY_BLOCK, print a '.', otherwise print the content.
+// - params: none
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::printToConsole() const
+{
+	for (int y{ 0 }; y < MAX_Y; ++y)
+	{
+		for (int x{ 0 }; x < MAX_X; ++x)
+		{
+			if (grid[y][x] != EMPTY_BLOCK)
+			{ 
+				std::cout << static_cast<int>(grid[y][x]) << std::setw(2);
+			}
+			else {
+				std::cout << '.' << std::setw(2);
+			}
+		}
+		std::cout << '\n';
+	}
+}
+
+// get the content at a given point 
+// assert the point is valid (use isValidPoint())
+// - param 1: a Point (the XY of the content weant to retrieve)
+// - return: an int, the content from the grid at the specified point 
+template<int WIDTH, int HEIGHT>
+int Gameboard<WIDTH, HEIGHT>::getContent (Point p) const
+{
+	assert(isValidPoint(p));
+	return getContent(p.getX(), p.getY());
+}
+
+// get the content at a given XY location
+// assert the point is valid (use isValidPoint())
+// - param 1: an int for X (column)
+// - param 2: an int for Y (row)
+// - return: an int, the content from the grid at the specified XY
+template<int WIDTH, int HEIGHT>
+int Gameboard<WIDTH, HEIGHT>::getContent (int x, int y) const
+{
+	assert(isValidPoint(x, y));
+	return grid[y][x];
+}
+
+// set the content at a given point (ignore invalid points)
+// - param 1: a Point
+// - param 2: an int representing the content we want to set at this location.
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::setContent(const Point& p, int content) 
+{
+	setContent(p.getX(), p.getY(), content);
+}
+
+// set the content at an x,y position (ignore invalid points)
+// - param 1: an int for X (column)
+// - param 2: an int for Y (row)
+// - param 3: an int representing the content we want to set at this location	
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::setContent(int x, int y, int content)
+{
+	if (isValidPoint(x, y)) {
+		const Row oldRow = rows[y];
+		if (grid[y][x] != EMPTY_BLOCK)
+		{
+			contentHash ^= Zobrist::contentKey(x, y, grid[y][x]);
+		}
+		grid[y][x] = static_cast<signed char>(content);
+		if (content == EMPTY_BLOCK)
+		{
+			rows[y] &= static_cast<Row>(~cellMask(x));
+		}
+		else
+		{
+			rows[y] |= cellMask(x);
+			contentHash ^= Zobrist::contentKey(x, y, grid[y][x]);
+		}
+		if (rows[y] != oldRow)
+		{
+			occupancyHash ^= Zobrist::cellKey(x, y);
+		}
+		updateColumnHeights(y, oldRow);
+		markRowChanged(y);
+	}
+}
+
+// set the content for a set of points (ignore invalid points)
+// - param 1: a vector of Points representing locations
+// - param 2: an int representing the content we want to set.
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::setContent(std::vector<Point>& locations, int content)
+{
+	for (Point& p : locations)
+	{
+		setContent(p, content);
+	}
+}
+
+// Determine if (valid) all points passed in are empty
+// *** IMPORTANT: Assume invalid x,y values can be passed to this method.
+// Invalid meaning outside the bounds of the grid.
+// * ONLY TEST VALID POINTS (use isValidPoint()). Ignore invalid Points.
+// Using invalid points to index into the grid would cause undefined behaviour. 
+// - param 1: a vector of Points representing locations to test
+// - return: true if the content at ALL VALID points is EMPTY_BLOCK, false otherwise
+template<int WIDTH, int HEIGHT>
+bool Gameboard<WIDTH, HEIGHT>::areAllLocsEmpty(const std::vector<Point>& locations) const
+{
+	for (const Point& p : locations)
+	{
+		if (isValidPoint(p))
+		{
+			if (rows[p.getY()] & cellMask(p.getX()))
+			{
+				return false;
+			}
+		}
+
+	}
+	return true;
+}
+
+// Determine if a block pattern can be placed on the board (allocation free).
+//   The pattern is given as occupancy masks, one per row of its bounding box
+//   (bit 0 of each mask is the box's left column).
+//   The box must be inside the left, right & bottom borders, rows above the
+//   top border never collide, and every other masked cell must be empty.
+// - param 1: a pointer to maskHeight row masks
+// - param 2: an int, the width of the pattern's bounding box
+// - param 3: an int, the height of the pattern's bounding box
+// - param 4: an int, the board column of the box's left edge
+// - param 5: an int, the board row of the box's top edge
+// - return: true if the pattern fits, false otherwise
+template<int WIDTH, int HEIGHT>
+bool Gameboard<WIDTH, HEIGHT>::isMaskPlaceable(const std::uint16_t* rowMasks, int maskWidth, int maskHeight, int left, int top) const
+{
+	if (left < 0 || left + maskWidth > MAX_X || top + maskHeight > MAX_Y)
+	{
+		return false;
+	}
+	for (int r{ top < 0 ? -top : 0 }; r < maskHeight; r++)
+	{
+		if (rows[top + r] & static_cast<Row>(static_cast<std::uint32_t>(rowMasks[r]) << left))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// get the occupancy of a row (bit x set when column x holds content)
+// - param 1: an int representing the row index (assert it is valid)
+// - return: the row's Row word
+template<int WIDTH, int HEIGHT>
+typename Gameboard<WIDTH, HEIGHT>::Row Gameboard<WIDTH, HEIGHT>::getRow(int rowIndex) const
+{
+	assert(rowIndex >= 0 && rowIndex < MAX_Y);
+	return rows[rowIndex];
+}
+
+// Remove all completed rows from the board
+//   collect the completed rows into a RowSet and compactRows() them
+//   (no vector of indices is built)
+// - params: none
+// - return: the count of completed rows removed
+template<int WIDTH, int HEIGHT>
+int Gameboard<WIDTH, HEIGHT>::removeCompletedRows()
+{
+	RowSet completedRows{ 0 };
+	int count{ 0 };
+	for (int y{ 0 }; y < MAX_Y; y++)
+	{
+		if (isRowCompleted(y))
+		{
+			completedRows |= RowSet{ 1 } << y;
+			count++;
+		}
+	}
+	compactRows(completedRows);
+	return count;
+}
+
+// lock a set of cells & remove the rows they complete
+//   1) write each valid cell, recording its location & old content
+//   2) the rows holding a written cell that are now full are the completed ones:
+//      record their content (top row first) and compactRows() them
+// - param 1: a pointer to the cell offsets (at most MAX_PLACED_CELLS of them)
+// - param 2: an int, the number of offsets
+// - param 3: a Point, the board location the offsets are from
+// - param 4: an int representing the content to write
+// - return: the UndoRecord that undoes the placement
+template<int WIDTH, int HEIGHT>
+typename Gameboard<WIDTH, HEIGHT>::UndoRecord Gameboard<WIDTH, HEIGHT>::place(const Point* offsets, int count,
+	const Point& origin, int content)
+{
+	assert(count >= 0 && count <= MAX_PLACED_CELLS);
+	UndoRecord record;
+	record.contentHash = contentHash;
+	record.occupancyHash = occupancyHash;
+	for (int x{ 0 }; x < MAX_X; x++)
+	{
+		record.columnHeights[x] = static_cast<signed char>(columnHeights[x]);
+	}
+	RowSet writtenRows{ 0 };
+	for (int i{ 0 }; i < count; i++)
+	{
+		const int x = origin.getX() + offsets[i].getX();
+		const int y = origin.getY() + offsets[i].getY();
+		if (isValidPoint(x, y))
+		{
+			record.cellX[record.cellCount] = static_cast<signed char>(x);
+			record.cellY[record.cellCount] = static_cast<signed char>(y);
+			record.oldContent[record.cellCount] = grid[y][x];
+			record.cellCount++;
+			setContent(x, y, content);
+			writtenRows |= RowSet{ 1 } << y;
+		}
+	}
+
+	int removed{ 0 };
+	for (RowSet rowSet{ writtenRows }; rowSet != 0; rowSet &= rowSet - 1)
+	{
+		const int y = Bits::countTrailingZeros(rowSet);
+		if (isRowCompleted(y))
+		{
+			record.removedRows |= RowSet{ 1 } << y;
+			for (int x{ 0 }; x < MAX_X; x++)
+			{
+				record.removedContent[removed][x] = grid[y][x];
+			}
+			removed++;
+		}
+	}
+	compactRows(record.removedRows);
+	return record;
+}
+
+// undo the latest place() not yet undone
+//   The rows & cells are written directly (every row written is still marked
+//   changed): the hashes & column heights are then set back to the recorded ones.
+//   1) put the removed rows back: walking down from the top of the stack, each
+//      removed row is rewritten from the record and every other row is copied
+//      back up from where the compaction moved it (a row only ever moves up,
+//      and is read before it is overwritten).  Once the lowest removed row is
+//      back, the rows below it never moved.
+//   2) restore the cells written, last first
+//   3) restore the hashes & column heights
+// - param 1: the UndoRecord place() returned
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::undo(const UndoRecord& record)
+{
+	if (record.removedRows != 0)
+	{
+		int remaining{ 0 };
+		for (RowSet rowSet{ record.removedRows }; rowSet != 0; rowSet &= rowSet - 1)
+		{
+			remaining++;
+		}
+		// rows above the old top of the stack were empty, and are still empty
+		int y{ getHighestOccupiedRow() - remaining };
+		const int topRemoved = Bits::countTrailingZeros(record.removedRows);
+		y = y < topRemoved ? y : topRemoved;
+		y = y > 0 ? y : 0;
+		int sourceRow{ y + remaining };
+		int restored{ 0 };
+		for (; remaining > 0; y++)
+		{
+			const bool removed = (record.removedRows & (RowSet{ 1 } << y)) != 0;
+			const signed char* content = removed ? record.removedContent[restored] : grid[sourceRow];
+			for (int x{ 0 }; x < MAX_X; x++)
+			{
+				grid[y][x] = content[x];
+			}
+			if (removed)
+			{
+				rows[y] = FULL_ROW;
+				restored++;
+				remaining--;
+			}
+			else
+			{
+				rows[y] = rows[sourceRow];
+				sourceRow++;
+			}
+			markRowChanged(y);
+		}
+	}
+
+	for (int i{ record.cellCount - 1 }; i >= 0; i--)
+	{
+		const int x = record.cellX[i];
+		const int y = record.cellY[i];
+		grid[y][x] = record.oldContent[i];
+		if (record.oldContent[i] == EMPTY_BLOCK)
+		{
+			rows[y] &= static_cast<Row>(~cellMask(x));
+		}
+		else
+		{
+			rows[y] |= cellMask(x);
+		}
+		markRowChanged(y);
+	}
+
+	contentHash = record.contentHash;
+	occupancyHash = record.occupancyHash;
+	for (int x{ 0 }; x < MAX_X; x++)
+	{
+		columnHeights[x] = record.columnHeights[x];
+	}
+}
+
+// copy another board's content into this board
+//   (unlike assignment, every row is written through the normal path, so this
+//   board's generation keeps increasing and every row is reported as changed)
+// - param 1: the board to copy
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::copyContentFrom(const Gameboard& other)
+{
+	for (int y{ 0 }; y < MAX_Y; y++)
+	{
+		for (int x{ 0 }; x < MAX_X; x++)
+		{
+			grid[y][x] = other.grid[y][x];
+		}
+		rows[y] = other.rows[y];
+		markRowChanged(y);
+	}
+	for (int x{ 0 }; x < MAX_X; x++)
+	{
+		columnHeights[x] = other.columnHeights[x];
+	}
+	contentHash = other.contentHash;
+	occupancyHash = other.occupancyHash;
+}
+
+// A getter for the spawn location
+// - params: none
+// - returns: a Point, representing our private spawnLoc
+template<int WIDTH, int HEIGHT>
+Point Gameboard<WIDTH, HEIGHT>::getSpawnLoc() const
+{
+	return spawnLoc;
+}
+
+// the rows written to after a given generation
+//   (pass the getGeneration() value seen when the rows were last read)
+// - param 1: the generation last seen
+// - return: a RowSet of the rows changed since then
+template<int WIDTH, int HEIGHT>
+typename Gameboard<WIDTH, HEIGHT>::RowSet Gameboard<WIDTH, HEIGHT>::getChangedRowsSince(std::uint64_t seenGeneration) const
+{
+	RowSet changedRows{ 0 };
+	if (seenGeneration == generation)
+	{
+		return changedRows;
+	}
+	for (int y{ 0 }; y < MAX_Y; y++)
+	{
+		if (rowGenerations[y] > seenGeneration)
+		{
+			changedRows |= RowSet{ 1 } << y;
+		}
+	}
+	return changedRows;
+}
+
+// the height of a column's surface (kept up to date by every write)
+// - param 1: an int representing x (assert it is valid)
+// - return: an int, the height [0, MAX_Y] (0 if the column is empty)
+template<int WIDTH, int HEIGHT>
+int Gameboard<WIDTH, HEIGHT>::getColumnHeight(int x) const
+{
+	assert(x >= 0 && x < MAX_X);
+	return columnHeights[x];
+}
+
+// the XOR of the content keys of a row's occupied cells
+//   (walks the row's occupancy bits, so an empty row costs nothing)
+// - param 1: an int representing the row index
+// - return: the hash
+template<int WIDTH, int HEIGHT>
+std::uint64_t Gameboard<WIDTH, HEIGHT>::getRowContentHash(int rowIndex) const
+{
+	std::uint64_t hash{ 0 };
+	for (Row row{ rows[rowIndex] }; row != 0; row &= static_cast<Row>(row - 1))
+	{
+		const int x = Bits::countTrailingZeros(row);
+		hash ^= Zobrist::contentKey(x, rowIndex, grid[rowIndex][x]);
+	}
+	return hash;
+}
+
+// bring the column heights up to date after a row's occupancy changed
+//   newly occupied cells can only raise a column.  A column is only
+//   searched (downwards) when the cell that was its top is emptied.
+// - param 1: an int representing the row index
+// - param 2: the row's occupancy before the write
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::updateColumnHeights(int rowIndex, Row oldRow)
+{
+	const Row newRow = rows[rowIndex];
+	if (newRow == oldRow)
+	{
+		return;
+	}
+	const int rowHeight = MAX_Y - rowIndex;
+	for (int x{ 0 }; x < MAX_X; x++)
+	{
+		const Row cell = cellMask(x);
+		if (newRow & cell)
+		{
+			if (columnHeights[x] < rowHeight)
+			{
+				columnHeights[x] = rowHeight;
+			}
+		}
+		else if ((oldRow & cell) && columnHeights[x] == rowHeight)
+		{
+			// the top cell was emptied - the new top is further down (if anywhere)
+			int y{ rowIndex + 1 };
+			while (y < MAX_Y && !(rows[y] & cell))
+			{
+				y++;
+			}
+			columnHeights[x] = MAX_Y - y;
+		}
+	}
+}
+
+// Determine if a given Point is a valid grid location
+// - param 1: a Point object
+// - return: true if the point is a valid grid location, false otherwise
+template<int WIDTH, int HEIGHT>
+bool Gameboard<WIDTH, HEIGHT>::isValidPoint(const Point& p) const
+{
+	return (p.getY() >= 0 && p.getY() < MAX_Y && p.getX() >= 0 && p.getX() < MAX_X);
+}
+
+// Determine if a given XY is a valid grid location
+// - param 1: an int representing x
+// - param 2: an int representing y
+// - return: true if the x,y is a valid grid location, false otherwise
+template<int WIDTH, int HEIGHT>
+bool Gameboard<WIDTH, HEIGHT>::isValidPoint(int x, int y) const
+{
+	return (x >= 0 && x < MAX_X&& y >= 0 && y < MAX_Y);
+}
+
+// return a bool indicating if a given row is full (no EMPTY_BLOCK in the row)
+// assert the row index is valid
+// - param 1: an int representing the row index we want to test
+// - return: bool representing if the row is completed
+template<int WIDTH, int HEIGHT>
+bool Gameboard<WIDTH, HEIGHT>::isRowCompleted(int rowIndex) const
+{
+	assert(rowIndex >= 0 && rowIndex < MAX_Y);	
+	return rows[rowIndex] == FULL_ROW;
+}
+
+// fill a given grid row with specified content
+// - param 1: an int representing a row index
+// - param 2: an int representing content
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::fillRow(int rowIndex, int content)
+{
+	const Row oldRow = rows[rowIndex];
+	contentHash ^= getRowContentHash(rowIndex);
+	for (int x{ 0 }; x < MAX_X; x++)
+	{
+		grid[rowIndex][x] = static_cast<signed char>(content);
+	}
+	rows[rowIndex] = (content == EMPTY_BLOCK) ? 0 : FULL_ROW;
+	contentHash ^= getRowContentHash(rowIndex);
+	occupancyHash ^= Zobrist::RowKeys<WIDTH, HEIGHT>::get().hashRow(rowIndex, oldRow ^ rows[rowIndex]);
+	updateColumnHeights(rowIndex, oldRow);
+	markRowChanged(rowIndex);
+}
+
+// scan the board for completed rows.
+// Iterate through the occupancy rows and use isRowCompleted(rowIndex)
+// - params: none
+// - return: a vector of completed row indices (integers).
+template<int WIDTH, int HEIGHT>
+std::vector<int> Gameboard<WIDTH, HEIGHT>::getCompletedRowIndices() const
+{
+	std::vector<int> completedRows;
+
+	for (int y{ 0 }; y < MAX_Y; y++)
+	{
+		if (isRowCompleted(y)) completedRows.push_back(y);
+	}
+	return completedRows;
+}
+
+// copy a source row's contents into a target row.
+//   (writeRow() the source's content & occupancy)
+// - param 1: an int representing the source row index
+// - param 2: an int representing the target row index
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::copyRowIntoRow(int sourceRow, int targetRow)
+{
+	writeRow(targetRow, grid[sourceRow], rows[sourceRow]);
+}
+
+// write a whole row (keeping the hashes, heights & generations up to date)
+// - param 1: an int representing the row index
+// - param 2: a pointer to the row's MAX_X contents
+// - param 3: the row's occupancy (matching the contents)
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::writeRow(int rowIndex, const signed char* content, Row occupancy)
+{
+	const Row oldRow = rows[rowIndex];
+	contentHash ^= getRowContentHash(rowIndex);
+	for (int x{ 0 }; x < MAX_X; x++)
+	{
+		grid[rowIndex][x] = content[x];
+	}
+	rows[rowIndex] = occupancy;
+	contentHash ^= getRowContentHash(rowIndex);
+	occupancyHash ^= Zobrist::RowKeys<WIDTH, HEIGHT>::get().hashRow(rowIndex, oldRow ^ rows[rowIndex]);
+	updateColumnHeights(rowIndex, oldRow);
+	markRowChanged(rowIndex);
+}
+
+// In gameplay, when a full row is completed (filled with content)
+// it gets "removed".  To be exact, the row itself is not removed
+// but the content from the row above it is copied into it.
+// This continues all the way up the grid until the first row is copied
+// into the second row.  Finally, the first row is filled with EMPTY_BLOCK
+// Given a row index:
+//   1) Assert the row index is valid
+//   2) compactRows() with a RowSet holding only that row.
+// - param 1: an int representing a row index
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::removeRow(int rowIndex)
+{
+	assert(rowIndex >= 0 && rowIndex < MAX_Y);
+	compactRows(RowSet{ 1 } << rowIndex);
+}
+
+// given a vector of row indices, remove them. 
+//   All indices refer to the board as it was before any row was removed.
+//   Collect them into a RowSet and compactRows() once.
+// - param 1: a vector of integers representing row indices we want to remove
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::removeRows(std::vector<int>& rowIndices)
+{
+	RowSet removedRows{ 0 };
+	for (int row : rowIndices)
+	{
+		assert(row >= 0 && row < MAX_Y);
+		removedRows |= RowSet{ 1 } << row;
+	}
+	compactRows(removedRows);
+}
+
+// remove a set of rows in a single bottom-up pass.
+//   Walk from the bottom row up to the highest occupied row, copying each
+//   surviving row directly into its final position (at most once), then
+//   fill the vacated rows at the top of the stack with EMPTY_BLOCK.
+//   Rows above the highest occupied row are already empty and are never touched.
+// - param 1: a RowSet of the rows to remove
+// - return: nothing
+template<int WIDTH, int HEIGHT>
+void Gameboard<WIDTH, HEIGHT>::compactRows(RowSet removedRows)
+{
+	if (removedRows == 0)
+	{
+		return;
+	}
+
+	const int topRow = getHighestOccupiedRow();
+	int targetRow = MAX_Y - 1;
+	for (int y{ MAX_Y - 1 }; y >= topRow; y--)
+	{
+		if (removedRows & (RowSet{ 1 } << y))
+		{
+			continue;
+		}
+		if (targetRow != y)
+		{
+			copyRowIntoRow(y, targetRow);
+		}
+		targetRow--;
+	}
+
+	// everything from the old top of the stack down to the last target is now vacated
+	for (int y{ topRow }; y <= targetRow; y++)
+	{
+		fillRow(y, EMPTY_BLOCK);
+	}
+}
+
+// find the highest (smallest index) row containing any content
+// - params: none
+// - return: an int, the row index (MAX_Y if the board is empty)
+template<int WIDTH, int HEIGHT>
+int Gameboard<WIDTH, HEIGHT>::getHighestOccupiedRow() const
+{
+	int y{ 0 };
+	while (y < MAX_Y && rows[y] == 0)
+	{
+		y++;
+	}
+	return y;
+}
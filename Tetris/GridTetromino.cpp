@@ -35,22 +35,21 @@ void GridTetromino::move(int xOffset, int yOffset) {
 	gridLoc.setXY(gridLoc.getX() + xOffset, gridLoc.getY() + yOffset);
 }
 
-// Build and return a vector of Points to represent our inherited
-// blockLocs vector mapped to the gridLoc of this object instance.
-// You will need to provide this class access to blockLocs (from the Tetromino class).
-// eg: if we have a Point [x,y] in our vector,
+// Build and return an array of Points to represent our inherited
+// block locs (from the rotation table) mapped to the gridLoc of this object instance.
+// eg: if we have a Point [x,y] in our block locs,
 // and our gridLoc is [5,6] the mapped Point would be [5+x,6+y].
+// (a fixed size array, so mapping never allocates)
 // params: none:
-// return: a vector of Point objects.
-std::vector<Point> GridTetromino::getBlockLocsMappedToGrid() const
+// return: an array of BLOCK_COUNT Point objects.
+std::array<Point, Tetromino::BLOCK_COUNT> GridTetromino::getBlockLocsMappedToGrid() const
 {
-	std::vector<Point> inheritedBlockLocs;
+	std::array<Point, BLOCK_COUNT> mappedBlockLocs = getBlockLocs();
 
-	for (const Point& p : blockLocs)
+	for (Point& p : mappedBlockLocs)
 	{
-		inheritedBlockLocs.push_back(Point(p.getX() + gridLoc.getX(), p.getY() + gridLoc.getY()));
+		p = p + gridLoc;
 	}
 
-	return inheritedBlockLocs;
-
-}
\ No newline at end of file
+	return mappedBlockLocs;
+}
@@ -50,14 +50,14 @@ public:
 	// - return: nothing
 	void move(int xOffset, int yOffset);
 
-	// Build and return a vector of Points to represent our inherited
-	// blockLocs vector mapped to the gridLoc of this object instance.
-	// You will need to provide this class access to blockLocs (from the Tetromino class).
-	// eg: if we have a Point [x,y] in our vector,
+	// Build and return an array of Points to represent our inherited
+	// block locs (from the rotation table) mapped to the gridLoc of this object instance.
+	// eg: if we have a Point [x,y] in our block locs,
 	// and our gridLoc is [5,6] the mapped Point would be [5+x,6+y].
+	// (a fixed size array, so mapping never allocates)
 	// params: none:
-	// return: a vector of Point objects.
-	std::vector<Point> getBlockLocsMappedToGrid() const;
+	// return: an array of BLOCK_COUNT Point objects.
+	std::array<Point, BLOCK_COUNT> getBlockLocsMappedToGrid() const;
 };
 
 #endif /* GRIDTETROMINO_H */
\ No newline at end of file
@@ -1,6 +1,7 @@
 
 
 #include <SFML/Graphics.hpp>
+#include <ctime>
 #include <iostream>
 #include "TetrisGame.h"
 #include "TestSuite.h"
@@ -8,9 +9,6 @@
 
 int main()
 {	
-	// Seeding the randomizer
-	srand(static_cast<unsigned int>(time(0)));
-
 	// run some sanity tests on our classes to ensure they're working as expected.
 	TestSuite::runTestSuite();
 
@@ -35,9 +33,10 @@ int main()
 	const Point nextShapeOffset{ 490, 210 };	// the pixel offset of the next shape Tetromino
 
 	// set up a tetris game
-	TetrisGame game(window, blockSprite, gameboardOffset, nextShapeOffset);
+	// every run deals a different game
+	TetrisGame game(window, blockSprite, gameboardOffset, nextShapeOffset, static_cast<std::uint64_t>(time(0)));
 
-	// set up a clock so we can determine seconds per game loop
+	// set up a clock so we can determine the time per game loop
 	sf::Clock clock;		
 
 	// create an event for handling userInput from the GUI (graphical user interface)
@@ -46,9 +45,8 @@ int main()
 	// the main game loop
 	while (window.isOpen())
 	{
-		// how long since the last loop (fraction of a second)		
-		float elapsedTime = clock.getElapsedTime().asSeconds();
-		clock.restart();		
+		// how long since the last loop (restart() returns it without losing any time)
+		sf::Time elapsedTime = clock.restart();
 
 		// handle any window or keyboard events that have occured since the last game loop
 		sf::Event event;
@@ -0,0 +1,371 @@
+#include "MoveGenerator.h"
+#include "Bits.h"
+#include <algorithm>
+
+namespace
+{
+	// the number of states in the search space (each one has its own bit)
+	constexpr int STATE_COUNT = MoveGenerator::ROTATION_COUNT * MoveGenerator::Y_SPAN * 64;
+
+	// the valid position bits: gridLoc x in [-2, MAX_X + 2)
+	//   (blocks are at most 2 columns from the pivot, so anything further out is off the board)
+	constexpr MoveGenerator::Positions POSITION_MASK =
+		((MoveGenerator::Positions{ 1 } << (MoveGenerator::Board::MAX_X + 4)) - 1) << (MoveGenerator::X_PAD - 2);
+
+	// a state's index: [rotation][row][bit]
+	int getStateIndex(int rotation, int row, int bit)
+	{
+		return (rotation * MoveGenerator::Y_SPAN + row) * 64 + bit;
+	}
+}
+
+// constructor
+MoveGenerator::MoveGenerator()
+{
+	moves.reserve(64);
+}
+
+// find every distinct lock position of a shape dropped in from the board's spawn location
+//   (in its spawn rotation state)
+// - param 1: the board
+// - param 2: the shape
+// - return: the Moves (valid until the next generate())
+const std::vector<MoveGenerator::Move>& MoveGenerator::generate(const Board& board, TetShape shape)
+{
+	GridTetromino spawned;
+	spawned.setShape(shape);
+	spawned.setGridLoc(board.getSpawnLoc());
+	return generate(board, spawned);
+}
+
+// find every distinct lock position reachable from a shape's current rotation & gridLoc
+//   (the board's occupancy is all the search needs)
+// - param 1: the board
+// - param 2: the shape (it should fit where it is, its gridLoc y should be >= -2)
+// - return: the Moves (valid until the next generate(), empty if the shape doesn't fit)
+const std::vector<MoveGenerator::Move>& MoveGenerator::generate(const Board& board, const GridTetromino& startShape)
+{
+	Row rows[Board::MAX_Y];
+	for (int y{ 0 }; y < Board::MAX_Y; y++)
+	{
+		rows[y] = board.getRow(y);
+	}
+	return generate(rows, startShape);
+}
+
+// find every distinct lock position reachable from a shape's current rotation & gridLoc
+// on a board given by its occupancy alone (eg: a search's candidate boards)
+//   1) shift the board rows once for every block column offset (prepareRows())
+//   2) flood the rows top-down: close each row under LEFT, RIGHT & ROTATE (bit
+//      shifts within the row's fits), then SOFT_DROP it into the next row (an AND).
+//      Only the rotations whose fits differ from the row above (or that gain
+//      positions by a ROTATE) are slid, so the rows above the stack cost nothing,
+//      and the flood stops at the first row nothing reaches.  Each row's fits
+//      are found (findFits()) just before the flood drops into it.
+//   3) list the reached states that can't move down, skipping duplicate footprints
+// - param 1: the board's Rows (MAX_Y of them, index 0 is the top row)
+// - param 2: the shape (it should fit where it is, its gridLoc y should be >= -2)
+// - return: the Moves (valid until the next generate(), empty if the shape doesn't fit)
+const std::vector<MoveGenerator::Move>& MoveGenerator::generate(const Row* rows, const GridTetromino& startShape)
+{
+	shape = startShape.getShape();
+	start = startShape.getGridLoc();
+	startRotation = startShape.getRotation() % ROTATION_COUNT;
+	moves.clear();
+	std::fill(&reached[0][0], &reached[0][0] + ROTATION_COUNT * Y_SPAN, Positions{ 0 });
+
+	prepareRows(rows);
+	findFits(0);
+	const int startBit = start.getX() + X_PAD;
+	if (startBit < 0 || startBit >= 64 || !(fits[startRotation][0] & (Positions{ 1 } << startBit)))
+	{
+		return moves;
+	}
+	reached[startRotation][0] = Positions{ 1 } << startBit;
+
+	int rowCount{ Y_SPAN };	// the rows the flood reached
+	for (int row{ 0 }; row < rowCount; row++)
+	{
+		// the rotations whose reached positions may slide further: in the first row the
+		// start, after that the rotations whose fits differ from the row above (the
+		// rest were closed in the row above and dropped unchanged - eg: above the stack)
+		unsigned dirty{ 0 };
+		for (int r{ 0 }; r < ROTATION_COUNT; r++)
+		{
+			if (row == 0 ? r == startRotation : fits[r][row] != fits[r][row - 1])
+			{
+				dirty |= 1u << r;
+			}
+		}
+		while (dirty != 0)
+		{
+			for (int r{ 0 }; r < ROTATION_COUNT; r++)
+			{
+				if (dirty & (1u << r))
+				{
+					reached[r][row] = slide(reached[r][row], fits[r][row]);
+					dirty &= ~(1u << r);
+				}
+				const int next = (r + 1) % ROTATION_COUNT;
+				const Positions rotated = reached[r][row] & fits[next][row] & ~reached[next][row];
+				if (rotated)
+				{
+					reached[next][row] |= rotated;
+					dirty |= 1u << next;
+				}
+			}
+		}
+		if (row + 1 < Y_SPAN)
+		{
+			findFits(row + 1);
+			Positions any{ 0 };
+			for (int r{ 0 }; r < ROTATION_COUNT; r++)
+			{
+				reached[r][row + 1] = reached[r][row] & fits[r][row + 1];
+				any |= reached[r][row + 1];
+			}
+			if (any == 0)
+			{
+				// (nothing reaches the rest of the rows, so they can't hold locks)
+				for (int r{ 0 }; r < ROTATION_COUNT; r++)
+				{
+					std::fill(&fits[r][row + 2 < Y_SPAN ? row + 2 : Y_SPAN], &fits[r][0] + Y_SPAN, Positions{ 0 });
+				}
+				rowCount = row + 1;
+			}
+		}
+	}
+
+	for (int r{ 0 }; r < ROTATION_COUNT; r++)
+	{
+		for (int row{ 0 }; row < rowCount; row++)
+		{
+			Positions locks = getLocks(r, row);
+			if (locks != 0 && footprintTwins[r] != 0)
+			{
+				locks &= ~getDuplicateLocks(r, row);
+			}
+			for (; locks != 0; locks &= locks - 1)
+			{
+				moves.push_back(Move{ r, Bits::countTrailingZeros(locks) - X_PAD, start.getY() + row });
+			}
+		}
+	}
+	return moves;
+}
+
+// the shortest input that takes the shape of the last generate() from its
+// start to a lock position: LEFT, RIGHT, ROTATE & SOFT_DROP moves, then a HARD_DROP.
+//   A breadth first search over the reached states; the first state found directly
+//   above the lock position (with nothing in between) gets the HARD_DROP.
+// - param 1: the Move (a lock position found by the last generate())
+// - param 2: a vector to fill with the GameInputs (it is cleared first)
+// - return: bool, false if the move isn't reachable (path left empty)
+bool MoveGenerator::getPath(const Move& move, std::vector<GameInput>& path) const
+{
+	path.clear();
+	const int targetRotation = move.rotation % ROTATION_COUNT;
+	const int targetRow = move.y - start.getY();
+	const int targetBit = move.x + X_PAD;
+	if (targetRow < 0 || targetRow >= Y_SPAN || targetBit < 0 || targetBit >= 64 ||
+		!(getLocks(targetRotation, targetRow) & (Positions{ 1 } << targetBit)))
+	{
+		return false;
+	}
+
+	// parents[state] = (the previous state << 3) | the input that left it, -1 if unvisited
+	//   (allocated on the first path, generators that never build paths don't need them)
+	parents.resize(STATE_COUNT);
+	queue.reserve(STATE_COUNT);
+	std::fill(parents.begin(), parents.end(), -1);
+	queue.clear();
+	const int first = getStateIndex(startRotation, 0, start.getX() + X_PAD);
+	parents[first] = 0;
+	queue.push_back(first);
+	for (std::size_t head{ 0 }; head < queue.size(); head++)
+	{
+		const int state = queue[head];
+		const int bit = state % 64;
+		const int row = (state / 64) % Y_SPAN;
+		const int r = state / (64 * Y_SPAN);
+
+		// a straight drop down the same column?
+		if (r == targetRotation && bit == targetBit && row <= targetRow)
+		{
+			int y{ row };
+			while (y < targetRow && (reached[r][y + 1] & (Positions{ 1 } << bit)))
+			{
+				y++;
+			}
+			if (y == targetRow)
+			{
+				path.push_back(GameInput::HARD_DROP);
+				for (int s{ state }; s != first; s = parents[s] >> 3)
+				{
+					path.push_back(static_cast<GameInput>(parents[s] & 7));
+				}
+				std::reverse(path.begin(), path.end());
+				return true;
+			}
+		}
+
+		const int neighbours[4][4] = {
+			{ r, row, bit - 1, static_cast<int>(GameInput::LEFT) },
+			{ r, row, bit + 1, static_cast<int>(GameInput::RIGHT) },
+			{ (r + 1) % ROTATION_COUNT, row, bit, static_cast<int>(GameInput::ROTATE) },
+			{ r, row + 1, bit, static_cast<int>(GameInput::SOFT_DROP) }
+		};
+		for (const auto& n : neighbours)
+		{
+			if (n[1] >= Y_SPAN || n[2] < 0 || n[2] >= 64 || !(reached[n[0]][n[1]] & (Positions{ 1 } << n[2])))
+			{
+				continue;
+			}
+			const int next = getStateIndex(n[0], n[1], n[2]);
+			if (parents[next] == -1)
+			{
+				parents[next] = (state << 3) | n[3];
+				queue.push_back(next);
+			}
+		}
+	}
+	return false;
+}
+
+// get the board ready for findFits(): shift the padded board rows (getWalledRow())
+// once for every block column offset, and look up every rotation's block offsets
+// & footprint twins.
+// - param 1: the board's Rows
+// - return: nothing
+void MoveGenerator::prepareRows(const Row* rows)
+{
+	for (int i{ 0 }; i < Y_SPAN + 4; i++)
+	{
+		const Positions walled = getWalledRow(rows, start.getY() + i - 2);
+		for (int dx{ -2 }; dx <= 2; dx++)
+		{
+			shiftedRows[dx + 2][i] = dx >= 0 ? walled >> dx : walled << -dx;
+		}
+	}
+
+	for (int r{ 0 }; r < ROTATION_COUNT; r++)
+	{
+		const RotationState& state = Tetromino::getRotationState(shape, r);
+		for (int b{ 0 }; b < RotationState::BLOCK_COUNT; b++)
+		{
+			const Point& block = state.blocks[b];
+			blockOffsets[r][b] = (block.getX() + 2) * (Y_SPAN + 4) + block.getY() + 2;
+		}
+		footprintTwins[r] = 0;
+		for (int other{ 0 }; other < r; other++)
+		{
+			const RotationState& otherState = Tetromino::getRotationState(shape, other);
+			if (otherState.width == state.width && otherState.height == state.height && otherState.rowMasks == state.rowMasks)
+			{
+				footprintTwins[r] |= 1u << other;
+			}
+		}
+	}
+}
+
+// fill in the fits of every rotation state in a row
+//   (a shape's block at [dx,dy] blocks every position whose cell it would land in,
+//   so the row of blocked positions is the board row shifted by dx - an OR of one
+//   prepared row per block)
+// - param 1: the row (gridLoc y - start y)
+// - return: nothing
+void MoveGenerator::findFits(int row)
+{
+	const Positions* rows = &shiftedRows[0][row];
+	for (int r{ 0 }; r < ROTATION_COUNT; r++)
+	{
+		Positions blocked{ 0 };
+		for (int b{ 0 }; b < RotationState::BLOCK_COUNT; b++)
+		{
+			blocked |= rows[blockOffsets[r][b]];
+		}
+		fits[r][row] = ~blocked & POSITION_MASK;
+	}
+}
+
+// every position reachable from a set of positions by LEFT & RIGHT moves
+//   (the runs of fitting positions that hold one of the positions).
+//   Up the bits, adding the positions to the fits carries through the rest of
+//   their runs.  Down the bits, the positions are smeared over the runs in
+//   doubling steps, so a row takes a handful of operations whatever its length.
+// - param 1: the positions (a subset of the fits)
+// - param 2: the fits
+// - return: the Positions
+MoveGenerator::Positions MoveGenerator::slide(Positions positions, Positions fits)
+{
+	const Positions up = ((fits + positions) ^ fits) & fits;
+	Positions down = positions;
+	Positions open = fits;
+	for (int shift{ 1 }; shift < Board::MAX_X + 4; shift <<= 1)	// (the longest run of positions)
+	{
+		down |= open & (down >> shift);
+		open &= open >> shift;
+	}
+	return up | down;
+}
+
+// the occupancy of a board row padded with walls, in Positions space
+//   (bit c + X_PAD set if column c is occupied or outside the board, rows
+//   below the board are solid and rows above it only have walls)
+// - param 1: the board's Rows
+// - param 2: the row index
+// - return: the padded row
+MoveGenerator::Positions MoveGenerator::getWalledRow(const Row* rows, int y)
+{
+	const Positions walls = ~(static_cast<Positions>(Board::FULL_ROW) << X_PAD);
+	if (y >= Board::MAX_Y)
+	{
+		return ~Positions{ 0 };
+	}
+	if (y < 0)
+	{
+		return walls;
+	}
+	return walls | (static_cast<Positions>(rows[y]) << X_PAD);
+}
+
+// the reached positions in a row that can't move down (lock positions)
+// - param 1: the rotation state
+// - param 2: the row (gridLoc y - start y)
+// - return: the Positions
+MoveGenerator::Positions MoveGenerator::getLocks(int rotation, int row) const
+{
+	const Positions below = (row + 1 < Y_SPAN) ? fits[rotation][row + 1] : 0;
+	return reached[rotation][row] & ~below;
+}
+
+// the lock positions in a row whose cells an earlier rotation state already covers
+//   Two rotation states with the same bounding box & row masks (footprint twins)
+//   cover the same cells from gridLocs offset by the difference of their bounding
+//   box corners, so the earlier twin's locks are shifted onto this row & rotation.
+// - param 1: the rotation state
+// - param 2: the row (gridLoc y - start y)
+// - return: the Positions
+MoveGenerator::Positions MoveGenerator::getDuplicateLocks(int rotation, int row) const
+{
+	Positions duplicates{ 0 };
+	const RotationState& state = Tetromino::getRotationState(shape, rotation);
+	for (int r{ 0 }; r < rotation; r++)
+	{
+		if ((footprintTwins[rotation] & (1u << r)) == 0)
+		{
+			continue;
+		}
+		const RotationState& other = Tetromino::getRotationState(shape, r);
+		const int otherRow = row + state.minY - other.minY;
+		if (otherRow < 0 || otherRow >= Y_SPAN)
+		{
+			continue;
+		}
+		// (this state's bit + the shift is the other state's bit)
+		const int shift = state.minX - other.minX;
+		const Positions otherLocks = getLocks(r, otherRow);
+		duplicates |= shift >= 0 ? otherLocks >> shift : otherLocks << -shift;
+	}
+	return duplicates;
+}
@@ -0,0 +1,158 @@
+// A MoveGenerator finds every place a shape can come to rest (lock) on a board,
+// and the input that gets it there.
+//
+// The state space of a falling shape is (rotation, gridLoc x, gridLoc y).  It is
+// flooded from a start state with the moves a player has: LEFT, RIGHT, ROTATE
+// (clockwise, no wall kicks) and SOFT_DROP - so lock positions that need a
+// soft drop tuck under an overhang or a spin are found as well as plain drops.
+//
+// The flood works on bitboards, one row of the state space at a time:
+//   - a set of gridLoc x positions is a single 64 bit word (bit x + X_PAD),
+//   - for each rotation & row, the positions where the shape fits are computed
+//     at once by OR-ing one shifted board row per block (the rows are shifted
+//     once per generate(), for each of the 5 column offsets a block can have),
+//   - the visited set is the same kind of word, so sliding a whole row of
+//     states left or right is a few shifts, ANDs and an add.
+// Shapes can't move up, so one top-down pass (closing each row under the
+// sideways moves & rotations before dropping into the next) reaches everything.
+//
+// Lock positions are the reached states that can't move down.  Rotation states
+// with the same footprint (eg: all 4 of the O) lock into the same cells, so the
+// duplicates are dropped and every Move covers a distinct set of cells.
+//
+// The paths are only built on request (getPath()), by a breadth first search
+// over the states the last generate() reached, so the path is the shortest
+// sequence of GameInputs (ending with a HARD_DROP).
+
+#ifndef MOVEGENERATOR_H
+#define MOVEGENERATOR_H
+
+#include "TetrisEngine.h"
+#include <cstdint>
+#include <vector>
+
+class MoveGenerator
+{
+	friend class TestSuite;
+public:
+	typedef TetrisEngine::Board Board;
+	typedef Board::Row Row;
+
+	// a set of gridLoc x positions (bit x + X_PAD represents gridLoc x)
+	typedef std::uint64_t Positions;
+
+	static constexpr int ROTATION_COUNT = Tetromino::ROTATION_COUNT;
+	static constexpr int X_PAD = 4;					// bit X_PAD of Positions is gridLoc x 0
+	static constexpr int Y_SPAN = Board::MAX_Y + 4;	// the rows of gridLoc y (from the start y down) searched
+	static_assert(Board::MAX_X + 2 * X_PAD <= 64, "the gameboard is too wide for the move generator");
+
+	// where a shape locks: its rotation state & gridLoc
+	struct Move
+	{
+		int rotation{ 0 };
+		int x{ 0 };
+		int y{ 0 };
+	};
+
+private:
+	TetShape shape{ TetShape::O };	// the shape of the last generate()
+	Point start;					// the start gridLoc of the last generate()
+	int startRotation{ 0 };			// the start rotation state of the last generate()
+
+	// [block x offset + 2][board row - start y + 2] -> the padded board row, shifted by the offset
+	//   (blocks are at most 2 columns & rows from the pivot)
+	Positions shiftedRows[5][Y_SPAN + 4];
+	// [rotation][block] -> the block's offset into shiftedRows (from [0][row])
+	int blockOffsets[ROTATION_COUNT][RotationState::BLOCK_COUNT];
+	// [rotation] -> the earlier rotation states with the same footprint (bit r set for rotation r)
+	unsigned footprintTwins[ROTATION_COUNT];
+	// [rotation][gridLoc y - start y] -> the positions where the shape fits
+	Positions fits[ROTATION_COUNT][Y_SPAN];
+	// [rotation][gridLoc y - start y] -> the positions reached from the start
+	Positions reached[ROTATION_COUNT][Y_SPAN];
+	// the distinct lock positions of the last generate()
+	std::vector<Move> moves;
+
+	// getPath() scratch (allocated by the first path & kept, so paths don't allocate)
+	mutable std::vector<int> parents;
+	mutable std::vector<int> queue;
+
+public:
+	// constructor
+	MoveGenerator();
+
+	// find every distinct lock position of a shape dropped in from the board's spawn location
+	//   (in its spawn rotation state)
+	// - param 1: the board
+	// - param 2: the shape
+	// - return: the Moves (valid until the next generate())
+	const std::vector<Move>& generate(const Board& board, TetShape shape);
+
+	// find every distinct lock position reachable from a shape's current rotation & gridLoc
+	// - param 1: the board
+	// - param 2: the shape (it should fit where it is, its gridLoc y should be >= -2)
+	// - return: the Moves (valid until the next generate(), empty if the shape doesn't fit)
+	const std::vector<Move>& generate(const Board& board, const GridTetromino& startShape);
+
+	// find every distinct lock position reachable from a shape's current rotation & gridLoc
+	// on a board given by its occupancy alone (eg: a search's candidate boards)
+	// - param 1: the board's Rows (MAX_Y of them, index 0 is the top row)
+	// - param 2: the shape (it should fit where it is, its gridLoc y should be >= -2)
+	// - return: the Moves (valid until the next generate(), empty if the shape doesn't fit)
+	const std::vector<Move>& generate(const Row* rows, const GridTetromino& startShape);
+
+	// the Moves of the last generate()
+	const std::vector<Move>& getMoves() const { return moves; }
+
+	// the shortest input that takes the shape of the last generate() from its
+	// start to a lock position: LEFT, RIGHT, ROTATE & SOFT_DROP moves, then a HARD_DROP.
+	// - param 1: the Move (a lock position found by the last generate())
+	// - param 2: a vector to fill with the GameInputs (it is cleared first)
+	// - return: bool, false if the move isn't reachable (path left empty)
+	bool getPath(const Move& move, std::vector<GameInput>& path) const;
+
+private:
+	// get the board ready for findFits(): shift the padded board rows (getWalledRow())
+	// once for every block column offset, and look up every rotation's block offsets
+	// & footprint twins.
+	// - param 1: the board's Rows
+	// - return: nothing
+	void prepareRows(const Row* rows);
+
+	// fill in the fits of every rotation state in a row
+	//   (a shape's block at [dx,dy] blocks every position whose cell it would land in,
+	//   so the row of blocked positions is the board row shifted by dx - an OR of one
+	//   prepared row per block)
+	// - param 1: the row (gridLoc y - start y)
+	// - return: nothing
+	void findFits(int row);
+
+	// every position reachable from a set of positions by LEFT & RIGHT moves
+	//   (the runs of fitting positions that hold one of the positions)
+	// - param 1: the positions (a subset of the fits)
+	// - param 2: the fits
+	// - return: the Positions
+	static Positions slide(Positions positions, Positions fits);
+
+	// the occupancy of a board row padded with walls, in Positions space
+	//   (bit c + X_PAD set if column c is occupied or outside the board, rows
+	//   below the board are solid and rows above it only have walls)
+	// - param 1: the board's Rows
+	// - param 2: the row index
+	// - return: the padded row
+	static Positions getWalledRow(const Row* rows, int y);
+
+	// the reached positions in a row that can't move down (lock positions)
+	// - param 1: the rotation state
+	// - param 2: the row (gridLoc y - start y)
+	// - return: the Positions
+	Positions getLocks(int rotation, int row) const;
+
+	// the lock positions in a row whose cells an earlier rotation state already covers
+	// - param 1: the rotation state
+	// - param 2: the row (gridLoc y - start y)
+	// - return: the Positions
+	Positions getDuplicateLocks(int rotation, int row) const;
+};
+
+#endif /* MOVEGENERATOR_H */
@@ -0,0 +1,338 @@
+#include "ParallelSearch.h"
+#include "Random.h"
+#include "Zobrist.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+const double ParallelSearch::TOPPED_OUT = -1e12;
+
+namespace
+{
+	typedef ParallelSearch::Board Board;
+	typedef ParallelSearch::Rows Rows;
+	typedef ParallelSearch::Clock Clock;
+
+	// a worker's task queue (tasks are [depth - 2][placement] indices)
+	struct TaskQueue
+	{
+		std::mutex mutex;
+		std::deque<int> tasks;
+
+		// take the oldest task (the owner & thieves both take the shallowest depth first)
+		bool take(int& task)
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			if (tasks.empty())
+			{
+				return false;
+			}
+			task = tasks.front();
+			tasks.pop_front();
+			return true;
+		}
+	};
+
+	// what the workers of one search share
+	struct SharedSearch
+	{
+		const Evaluator& evaluator;
+		TranspositionTable& table;
+		const std::vector<TetShape>& pieces;
+		Point spawnLoc;
+		Clock::time_point deadline;
+		std::vector<std::uint64_t> sequenceKeys;	// [ply][depth] -> the key of the pieces [ply, depth)
+		std::atomic<bool> aborted{ false };			// set when the deadline passes
+
+		SharedSearch(const Evaluator& evaluator, TranspositionTable& table, const std::vector<TetShape>& pieces,
+			const Point& spawnLoc, Clock::time_point deadline)
+			: evaluator{ evaluator }, table{ table }, pieces{ pieces }, spawnLoc{ spawnLoc }, deadline{ deadline }
+		{
+			const std::size_t count = pieces.size() + 1;
+			sequenceKeys.resize(count * count);
+			for (std::size_t ply{ 0 }; ply < pieces.size(); ply++)
+			{
+				std::uint64_t key{ 0x5E0E9CEull };
+				for (std::size_t depth{ ply + 1 }; depth <= pieces.size(); depth++)
+				{
+					key = Random::mix(key ^ (static_cast<std::uint64_t>(pieces[depth - 1]) + 1));
+					sequenceKeys[ply * count + depth] = key;
+				}
+			}
+		}
+
+		// the key of a board with pieces [ply, depth) still to place
+		//   (the value below a board only depends on the board & the pieces left, so
+		//   the key doesn't depend on ply: the same board & pieces share an entry
+		//   at any ply & in any later search)
+		std::uint64_t getKey(const Rows& rows, int ply, int depth) const
+		{
+			return Zobrist::hashRows<Board::MAX_X, Board::MAX_Y>(rows.data()) ^ sequenceKeys[ply * (pieces.size() + 1) + depth];
+		}
+	};
+
+	// one worker's search state
+	struct Worker
+	{
+		SharedSearch& shared;
+		std::vector<MoveGenerator> generators;	// one per ply (each ply's Moves stay valid below it)
+		std::size_t nodes{ 0 };
+		std::size_t tableHits{ 0 };
+
+		explicit Worker(SharedSearch& shared) : shared{ shared }, generators(shared.pieces.size()) {}
+
+		// the best value of the sequences placing pieces [ply, depth) on a board
+		//   (without the carried terms of the placements that made the board, so
+		//   the value only depends on the board & the pieces - it can be shared)
+		// - return: the value (meaningless if the search was aborted)
+		double explore(const Rows& rows, int ply, int depth)
+		{
+			if (shared.aborted.load(std::memory_order_relaxed) || Clock::now() >= shared.deadline)
+			{
+				shared.aborted.store(true, std::memory_order_relaxed);
+				return 0;
+			}
+			const std::uint64_t key = shared.getKey(rows, ply, depth);
+			double best;
+			if (shared.table.probe(key, best))
+			{
+				tableHits++;
+				return best;
+			}
+
+			const TetShape piece = shared.pieces[ply];
+			const Evaluator::Weights& weights = shared.evaluator.getWeights();
+			GridTetromino spawned;
+			spawned.setShape(piece);
+			spawned.setGridLoc(shared.spawnLoc);
+			Evaluator::Candidate candidate;
+			best = ParallelSearch::TOPPED_OUT;
+			for (const MoveGenerator::Move& move : generators[ply].generate(rows.data(), spawned))
+			{
+				Evaluator::place(rows, piece, move, candidate);
+				nodes++;
+				const Evaluator::Features features = Evaluator::getFeatures(candidate);
+				double value;
+				if (ply + 1 == depth)
+				{
+					value = shared.evaluator.score(features);
+				}
+				else
+				{
+					value = weights.landingHeight * features.landingHeight + weights.removedRows * features.removedRows
+						+ explore(candidate.rows, ply + 1, depth);
+					if (shared.aborted.load(std::memory_order_relaxed))
+					{
+						return 0;
+					}
+				}
+				best = std::max(best, value);
+			}
+			shared.table.store(key, best);
+			return best;
+		}
+	};
+}
+
+// constructor
+// - param 1: the worker threads (0: one per hardware thread)
+// - param 2: the Evaluator weights
+// - param 3: the log2 of the transposition table's slot count
+//   (starts the pool threads)
+ParallelSearch::ParallelSearch(int threads, const Evaluator::Weights& weights, int tableSizeLog2)
+	: evaluator{ weights }, threadCount{ threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency()) },
+	table{ tableSizeLog2 }
+{
+	threadCount = std::max(threadCount, 1);
+	for (int t{ 1 }; t < threadCount; t++)
+	{
+		pool.emplace_back(&ParallelSearch::poolLoop, this, t);
+	}
+}
+
+// destructor - stop & join the pool threads
+ParallelSearch::~ParallelSearch()
+{
+	{
+		std::lock_guard<std::mutex> lock{ poolMutex };
+		stopping = true;
+	}
+	jobStarted.notify_all();
+	for (std::thread& thread : pool)
+	{
+		thread.join();
+	}
+}
+
+// run a job on every worker: the pool threads & the calling thread (worker 0)
+//   post the job under a new generation, run it as worker 0, then wait until
+//   every pool thread has returned from it
+// - param 1: the job (called with the worker index)
+// - return: nothing (once every worker has returned from the job)
+void ParallelSearch::runOnWorkers(const std::function<void(int)>& work)
+{
+	{
+		std::lock_guard<std::mutex> lock{ poolMutex };
+		job = &work;
+		jobGeneration++;
+		jobsRunning = static_cast<int>(pool.size());
+	}
+	jobStarted.notify_all();
+	work(0);
+	std::unique_lock<std::mutex> lock{ poolMutex };
+	jobFinished.wait(lock, [this] { return jobsRunning == 0; });
+	job = nullptr;
+}
+
+// a pool thread: wait for jobs & run them until the pool stops
+// - param 1: the worker index
+// - return: nothing
+void ParallelSearch::poolLoop(int self)
+{
+	std::uint64_t seenGeneration{ 0 };
+	for (;;)
+	{
+		const std::function<void(int)>* work;
+		{
+			std::unique_lock<std::mutex> lock{ poolMutex };
+			jobStarted.wait(lock, [this, seenGeneration] { return stopping || jobGeneration != seenGeneration; });
+			if (stopping)
+			{
+				return;
+			}
+			seenGeneration = jobGeneration;
+			work = job;
+		}
+		(*work)(self);
+		std::lock_guard<std::mutex> lock{ poolMutex };
+		if (--jobsRunning == 0)
+		{
+			jobFinished.notify_all();
+		}
+	}
+}
+
+// search for where the first of a sequence of pieces should lock
+//   1) place the first piece everywhere it can lock: its placements' values are
+//      the first depth
+//   2) deal a task for every (placement, depth) from 2 to the number of pieces onto
+//      the worker queues, shallowest first; the workers (the pool threads & the
+//      calling thread, worker 0) run their own queue, then steal from the others, until the tasks
+//      run out or the deadline passes
+//   3) the answer is the best placement of the deepest depth whose tasks all
+//      completed (ties go to the first placement generated)
+// - param 1: the board
+// - param 2: the pieces (the current shape first, then the preview), each
+//            spawned at the board's spawn location in its spawn rotation
+// - param 3: the time to stop by
+// - return: the Result
+ParallelSearch::Result ParallelSearch::search(const Board& board, const std::vector<TetShape>& pieces, Clock::time_point deadline)
+{
+	Result result;
+	if (pieces.empty())
+	{
+		return result;
+	}
+	SharedSearch shared{ evaluator, table, pieces, board.getSpawnLoc(), deadline };
+
+	// 1) the first depth
+	Worker rootWorker{ shared };
+	Rows rows;
+	Evaluator::getRows(board, rows);
+	GridTetromino spawned;
+	spawned.setShape(pieces[0]);
+	spawned.setGridLoc(board.getSpawnLoc());
+	const std::vector<MoveGenerator::Move>& rootMoves = rootWorker.generators[0].generate(rows.data(), spawned);
+	const int rootCount = static_cast<int>(rootMoves.size());
+	if (rootCount == 0)
+	{
+		return result;
+	}
+	std::vector<Evaluator::Candidate> rootBoards(rootCount);
+	std::vector<double> carried(rootCount);
+	const int depthCount = static_cast<int>(pieces.size());
+	std::vector<double> values(static_cast<std::size_t>(depthCount) * rootCount);
+	for (int r{ 0 }; r < rootCount; r++)
+	{
+		Evaluator::place(rows, pieces[0], rootMoves[r], rootBoards[r]);
+		const Evaluator::Features features = Evaluator::getFeatures(rootBoards[r]);
+		values[r] = evaluator.score(features);
+		carried[r] = evaluator.getWeights().landingHeight * features.landingHeight
+			+ evaluator.getWeights().removedRows * features.removedRows;
+	}
+	result.nodes = rootCount;
+
+	// 2) the deeper depths
+	std::unique_ptr<TaskQueue[]> queues{ new TaskQueue[threadCount] };
+	const int taskCount = (depthCount - 1) * rootCount;
+	for (int task{ 0 }; task < taskCount; task++)
+	{
+		queues[task % threadCount].tasks.push_back(task);
+	}
+	std::unique_ptr<std::atomic<int>[]> completed{ new std::atomic<int>[depthCount] };
+	for (int d{ 0 }; d < depthCount; d++)
+	{
+		completed[d].store(d == 0 ? rootCount : 0);
+	}
+	std::atomic<std::size_t> nodes{ 0 };
+	std::atomic<std::size_t> tableHits{ 0 };
+	std::atomic<std::size_t> steals{ 0 };
+
+	const std::function<void(int)> work = [&](int self)
+	{
+		Worker worker{ shared };
+		int task;
+		while (!shared.aborted.load(std::memory_order_relaxed))
+		{
+			if (!queues[self].take(task))
+			{
+				bool stolen{ false };
+				for (int v{ 1 }; v < threadCount && !stolen; v++)
+				{
+					stolen = queues[(self + v) % threadCount].take(task);
+				}
+				if (!stolen)
+				{
+					break;
+				}
+				steals++;
+			}
+			const int depth = task / rootCount + 2;
+			const int root = task % rootCount;
+			const double value = carried[root] + worker.explore(rootBoards[root].rows, 1, depth);
+			if (shared.aborted.load(std::memory_order_relaxed))
+			{
+				break;
+			}
+			values[static_cast<std::size_t>(depth - 1) * rootCount + root] = value;
+			completed[depth - 1]++;
+		}
+		nodes += worker.nodes;
+		tableHits += worker.tableHits;
+	};
+
+	if (taskCount > 0)
+	{
+		runOnWorkers(work);
+	}
+
+	// 3) the deepest complete depth's best placement
+	int depth{ 1 };
+	while (depth < depthCount && completed[depth].load() == rootCount)
+	{
+		depth++;
+	}
+	const double* depthValues = &values[static_cast<std::size_t>(depth - 1) * rootCount];
+	const int best = static_cast<int>(std::max_element(depthValues, depthValues + rootCount) - depthValues);
+	result.found = true;
+	result.move = rootMoves[best];
+	result.value = depthValues[best];
+	result.depth = depth;
+	result.nodes += nodes.load();
+	result.tableHits = tableHits.load();
+	result.steals = steals.load();
+	return result;
+}
@@ -0,0 +1,111 @@
+// A ParallelSearch looks ahead over the known pieces (the current shape, the preview)
+// on several threads to choose where the current shape should lock.
+//
+// Unlike the BeamSearch it prunes nothing: every placement sequence of the pieces is
+// searched (depth first), and a placement's value is the best value of the sequences
+// that start with it.  The values are the BeamSearch's (the score of the last board
+// plus the landing height & removed rows terms of the placements before it).
+//
+// The work is split on the current shape's placements: each (placement, depth) is a
+// task, the tasks are dealt round robin onto one queue per worker thread, and a
+// worker whose queue runs dry steals from the others, so no thread idles while
+// another has subtrees left.  Every depth is searched in turn (iterative deepening),
+// so at the deadline the best placement of the deepest depth every task completed is
+// the answer - the first depth (the placements themselves) is always complete.
+//
+// The worker threads are started once, with the search, and sleep between searches
+// (the thread calling search() is worker 0), so a search pays no thread creation.
+//
+// The workers share a lock-free TranspositionTable keyed on the board's Zobrist hash
+// and the pieces still to place, so a board reached by several sequences (on any
+// thread) is only searched once, and entries stay valid from one search to the next.
+
+#ifndef PARALLELSEARCH_H
+#define PARALLELSEARCH_H
+
+#include "Evaluator.h"
+#include "MoveGenerator.h"
+#include "TranspositionTable.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ParallelSearch
+{
+	friend class TestSuite;
+public:
+	typedef MoveGenerator::Board Board;
+	typedef Evaluator::Rows Rows;
+	typedef std::chrono::steady_clock Clock;
+
+	static const double TOPPED_OUT;	// the value of a sequence with a piece that can't be placed, init to -1e12
+
+	// the outcome of a search
+	struct Result
+	{
+		bool found{ false };			// false if the first piece can't be placed
+		MoveGenerator::Move move;		// where the first piece should lock
+		double value{ 0 };				// the value of the best sequence
+		int depth{ 0 };					// the pieces the best sequence places (the depths completed)
+		std::size_t nodes{ 0 };			// the boards made
+		std::size_t tableHits{ 0 };		// the boards the transposition table already had a value for
+		std::size_t steals{ 0 };		// the tasks workers took from each other's queues
+	};
+
+private:
+	Evaluator evaluator;			// scores the boards
+	int threadCount;				// the worker threads (the calling thread included)
+	TranspositionTable table;		// shared by the workers (and kept between searches)
+
+	// the pool: threadCount - 1 threads waiting for a job (a new jobGeneration)
+	std::vector<std::thread> pool;
+	std::mutex poolMutex;
+	std::condition_variable jobStarted;		// a job was posted (or the pool is stopping)
+	std::condition_variable jobFinished;	// every pool thread finished the job
+	const std::function<void(int)>* job{ nullptr };	// the job (called with the worker index)
+	std::uint64_t jobGeneration{ 0 };		// advanced for every job
+	int jobsRunning{ 0 };					// the pool threads still running the job
+	bool stopping{ false };					// set when the pool threads should exit
+
+public:
+	// constructor
+	// - param 1: the worker threads (0: one per hardware thread)
+	// - param 2: the Evaluator weights
+	// - param 3: the log2 of the transposition table's slot count
+	explicit ParallelSearch(int threads = 0, const Evaluator::Weights& weights = Evaluator::Weights{},
+		int tableSizeLog2 = TranspositionTable::DEFAULT_SIZE_LOG2);
+
+	// destructor - stop & join the pool threads
+	~ParallelSearch();
+
+	ParallelSearch(const ParallelSearch&) = delete;
+	ParallelSearch& operator=(const ParallelSearch&) = delete;
+
+	// the worker threads (the calling thread included)
+	int getThreadCount() const { return threadCount; }
+
+	// search for where the first of a sequence of pieces should lock
+	// - param 1: the board
+	// - param 2: the pieces (the current shape first, then the preview), each
+	//            spawned at the board's spawn location in its spawn rotation
+	// - param 3: the time to stop by
+	// - return: the Result
+	Result search(const Board& board, const std::vector<TetShape>& pieces, Clock::time_point deadline);
+
+private:
+	// run a job on every worker: the pool threads & the calling thread (worker 0)
+	// - param 1: the job (called with the worker index)
+	// - return: nothing (once every worker has returned from the job)
+	void runOnWorkers(const std::function<void(int)>& work);
+
+	// a pool thread: wait for jobs & run them until the pool stops
+	// - param 1: the worker index
+	// - return: nothing
+	void poolLoop(int self);
+};
+
+#endif /* PARALLELSEARCH_H */
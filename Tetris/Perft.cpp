@@ -0,0 +1,200 @@
+#include "Perft.h"
+#include <atomic>
+#include <thread>
+
+namespace
+{
+	typedef TetrisEngine::Board Board;
+
+	// count the sequences below one board (the depth first search of perft())
+	//   At the last depth the lock positions are only counted, never placed.
+	//   Every placement is made & undone on the one board, so it is left as it was.
+	// - param 1: the board
+	// - param 2: the pieces
+	// - param 3: the depth of this board (the index of the piece to place)
+	// - param 4: the full depth
+	// - param 5: one MoveGenerator per depth (each depth's Moves stay valid below it)
+	// - return: the PerftStats of the subtree
+	PerftStats countSequences(Board& board, const std::vector<TetShape>& pieces, int ply, int depth,
+		std::vector<MoveGenerator>& generators)
+	{
+		PerftStats stats;
+		if (ply >= depth)
+		{
+			stats.sequences = 1;
+			return stats;
+		}
+
+		const std::vector<MoveGenerator::Move>& moves = generators[ply].generate(board, pieces[ply]);
+		stats.placements = moves.size();
+		if (ply + 1 == depth)
+		{
+			stats.sequences = moves.size();
+			return stats;
+		}
+		for (const MoveGenerator::Move& move : moves)
+		{
+			const Board::UndoRecord record = placeMove(board, pieces[ply], move);
+			stats.merge(countSequences(board, pieces, ply + 1, depth, generators));
+			board.undo(record);
+		}
+		return stats;
+	}
+}
+
+// add another set of totals to this one
+void PerftStats::merge(const PerftStats& other)
+{
+	sequences += other.sequences;
+	placements += other.placements;
+}
+
+// a built-in perft position
+//   0: "empty" - an empty board
+//   1: "cave"  - a ledge over a cave & a one block well (tucks & spins)
+//   2: "messy" - 7 rows of scattered blocks with holes & overhangs
+// - param 1: the position index [0, PERFT_POSITION_COUNT)
+// - return: the board
+TetrisEngine::Board getPerftPosition(int index)
+{
+	Board board;
+	const int color = static_cast<int>(TetColor::PURPLE);
+	if (index == 1)
+	{
+		for (int x{ 0 }; x < Board::MAX_X; x++)
+		{
+			if (x != 4)
+			{
+				board.setContent(x, Board::MAX_Y - 1, color);
+			}
+			if (x > 5)
+			{
+				board.setContent(x, Board::MAX_Y - 3, color);
+			}
+		}
+	}
+	else if (index == 2)
+	{
+		for (int y{ Board::MAX_Y - 7 }; y < Board::MAX_Y; y++)
+		{
+			for (int x{ 0 }; x < Board::MAX_X; x++)
+			{
+				if ((x * 7 + y * 5) % 9 < 5)
+				{
+					board.setContent(x, y, color);
+				}
+			}
+		}
+	}
+	return board;
+}
+
+// the name of a built-in perft position
+// - param 1: the position index [0, PERFT_POSITION_COUNT)
+// - return: the name
+std::string getPerftPositionName(int index)
+{
+	switch (index)
+	{
+	case 1: return "cave";
+	case 2: return "messy";
+	default: return "empty";
+	}
+}
+
+// lock a shape onto a board at a generated lock position & remove the completed rows
+//   (the same cells & content TetrisEngine::lock() would write)
+// - param 1: the board
+// - param 2: the shape
+// - param 3: the Move (lock position)
+// - return: the UndoRecord that undoes the placement (see Gameboard::undo())
+TetrisEngine::Board::UndoRecord placeMove(TetrisEngine::Board& board, TetShape shape, const MoveGenerator::Move& move)
+{
+	const RotationState& state = Tetromino::getRotationState(shape, move.rotation);
+	return board.place(state.blocks.data(), RotationState::BLOCK_COUNT, Point{ move.x, move.y }, static_cast<int>(shape));
+}
+
+// count the placement sequences of a piece sequence on a board
+//   The root Moves are generated once; workers claim the next root Move from a
+//   shared counter and search its whole subtree with their own generators, keeping
+//   their own totals until they are merged at the end.
+// - param 1: the board
+// - param 2: the pieces, one per depth (at least depth of them)
+// - param 3: the depth
+// - param 4: the worker threads the root placements are spread over (0: one per hardware thread)
+// - return: the PerftStats
+PerftStats perft(const TetrisEngine::Board& board, const std::vector<TetShape>& pieces, int depth, int threads)
+{
+	std::vector<MoveGenerator> rootGenerators(depth > 0 ? depth : 1);
+	if (depth <= 1)
+	{
+		Board root = board;
+		return countSequences(root, pieces, 0, depth, rootGenerators);
+	}
+
+	const std::vector<MoveGenerator::Move>& rootMoves = rootGenerators[0].generate(board, pieces[0]);
+	int threadCount = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+	if (threadCount > static_cast<int>(rootMoves.size()))
+	{
+		threadCount = rootMoves.empty() ? 1 : static_cast<int>(rootMoves.size());
+	}
+
+	std::atomic<std::size_t> nextMove{ 0 };
+	std::vector<PerftStats> threadTotals(threadCount);
+	auto worker = [&](PerftStats& workerTotals)
+	{
+		std::vector<MoveGenerator> generators(depth);
+		Board next = board;
+		for (std::size_t m = nextMove++; m < rootMoves.size(); m = nextMove++)
+		{
+			const Board::UndoRecord record = placeMove(next, pieces[0], rootMoves[m]);
+			workerTotals.merge(countSequences(next, pieces, 1, depth, generators));
+			next.undo(record);
+		}
+	};
+
+	// the calling thread is worker 0
+	std::vector<std::thread> workers;
+	for (int t{ 1 }; t < threadCount; t++)
+	{
+		workers.emplace_back(worker, std::ref(threadTotals[t]));
+	}
+	worker(threadTotals[0]);
+	for (std::thread& thread : workers)
+	{
+		thread.join();
+	}
+
+	PerftStats totals;
+	totals.placements = rootMoves.size();
+	for (const PerftStats& workerTotals : threadTotals)
+	{
+		totals.merge(workerTotals);
+	}
+	return totals;
+}
+
+// count the placement sequences that follow each root placement (a "divide")
+//   (to find which subtree a count changed in)
+// - param 1: the board
+// - param 2: the pieces, one per depth (at least depth of them)
+// - param 3: the depth (>= 1)
+// - return: the sequences under each Move of the first piece (in generate() order)
+std::vector<std::uint64_t> perftDivide(const TetrisEngine::Board& board, const std::vector<TetShape>& pieces, int depth)
+{
+	std::vector<std::uint64_t> counts;
+	std::vector<MoveGenerator> generators(depth > 0 ? depth : 1);
+	const std::vector<MoveGenerator::Move>& rootMoves = generators[0].generate(board, pieces[0]);
+	Board next = board;
+	for (const MoveGenerator::Move& move : rootMoves)
+	{
+		const Board::UndoRecord record = placeMove(next, pieces[0], move);
+		counts.push_back(countSequences(next, pieces, 1, depth, generators).sequences);
+		next.undo(record);
+	}
+	return counts;
+}
@@ -0,0 +1,77 @@
+// Perft ("performance test") counts every sequence of placements a fixed piece
+// sequence can make on a fixed board, to a given depth - the same way chess engines
+// count move sequences to check & benchmark their move generators.
+//
+// Depth 1 is the number of distinct lock positions of the first piece, depth 2 adds
+// every lock position of the second piece on each board the first one left (with
+// completed rows removed), and so on.  A piece that can't spawn ends its sequence
+// early, so that sequence isn't counted.
+//
+// The counts only depend on the board, the pieces and the rules, so they are a
+// regression oracle for the move generator (and for the board & collision code
+// under it), and the number of placements made per second is the throughput figure
+// for those changes.  The tetris_perft binary reports both.
+//
+// The root placements can be spread over worker threads; each thread explores whole
+// subtrees with its own generators & boards, so the counts never depend on the
+// number of threads.  Within a subtree every placement is made & undone on one board
+// (Gameboard::place() & undo()), so no board is copied per placement.
+
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "MoveGenerator.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// the totals of a perft run
+struct PerftStats
+{
+	std::uint64_t sequences{ 0 };	// placement sequences of the full depth (the perft count)
+	std::uint64_t placements{ 0 };	// placements made at every depth (the nodes searched)
+
+	// add another set of totals to this one
+	void merge(const PerftStats& other);
+};
+
+// the number of built-in perft positions
+const int PERFT_POSITION_COUNT = 3;
+
+// a built-in perft position
+//   0: "empty" - an empty board
+//   1: "cave"  - a ledge over a cave & a one block well (tucks & spins)
+//   2: "messy" - 7 rows of scattered blocks with holes & overhangs
+// - param 1: the position index [0, PERFT_POSITION_COUNT)
+// - return: the board
+TetrisEngine::Board getPerftPosition(int index);
+
+// the name of a built-in perft position
+// - param 1: the position index [0, PERFT_POSITION_COUNT)
+// - return: the name
+std::string getPerftPositionName(int index);
+
+// lock a shape onto a board at a generated lock position & remove the completed rows
+// - param 1: the board
+// - param 2: the shape
+// - param 3: the Move (lock position)
+// - return: the UndoRecord that undoes the placement (see Gameboard::undo())
+TetrisEngine::Board::UndoRecord placeMove(TetrisEngine::Board& board, TetShape shape, const MoveGenerator::Move& move);
+
+// count the placement sequences of a piece sequence on a board
+// - param 1: the board
+// - param 2: the pieces, one per depth (at least depth of them)
+// - param 3: the depth
+// - param 4: the worker threads the root placements are spread over (0: one per hardware thread)
+// - return: the PerftStats
+PerftStats perft(const TetrisEngine::Board& board, const std::vector<TetShape>& pieces, int depth, int threads = 1);
+
+// count the placement sequences that follow each root placement (a "divide")
+//   (to find which subtree a count changed in)
+// - param 1: the board
+// - param 2: the pieces, one per depth (at least depth of them)
+// - param 3: the depth (>= 1)
+// - return: the sequences under each Move of the first piece (in generate() order)
+std::vector<std::uint64_t> perftDivide(const TetrisEngine::Board& board, const std::vector<TetShape>& pieces, int depth);
+
+#endif /* PERFT_H */
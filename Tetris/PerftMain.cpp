@@ -0,0 +1,185 @@
+// tetris_perft - counts the placement sequences of a piece sequence on a fixed board
+// and reports how fast they were generated.
+//
+// usage: tetris_perft [--depth N] [--position empty|cave|messy] [--sequence SHAPES]
+//                     [--pieces random|bag|history] [--seed S] [--threads T] [--divide]
+//
+// Every depth from 1 to N is counted single threaded, then depth N is counted again
+// spread over --threads worker threads (default: one per hardware thread).  The two
+// counts of depth N must agree; the exit code is 1 if they don't.
+//
+// The pieces are dealt by the --pieces generator from --seed, unless --sequence
+// lists them (as letters, eg: "TISZ").  The counts for a position & pieces never
+// change unless the rules do, so they can be compared between engine changes.
+// --divide prints the count under each placement of the first piece.
+
+#include "PieceGenerator.h"
+#include "Perft.h"
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// the letter of each shape (in TetShape order)
+const std::string SHAPE_LETTERS = "SZLJOIT";
+
+// read a sequence of shape letters
+// - param 1: the letters
+// - param 2: the shapes read
+// - return: bool, false if a letter isn't a shape
+bool parseSequence(const std::string& letters, std::vector<TetShape>& shapes)
+{
+	shapes.clear();
+	for (char letter : letters)
+	{
+		const std::size_t index = SHAPE_LETTERS.find(static_cast<char>(std::toupper(static_cast<unsigned char>(letter))));
+		if (index == std::string::npos)
+		{
+			return false;
+		}
+		shapes.push_back(static_cast<TetShape>(index));
+	}
+	return true;
+}
+
+// read a position by name or index
+// - param 1: the name
+// - param 2: the position index read
+// - return: bool, false if there's no such position
+bool parsePosition(const std::string& name, int& position)
+{
+	for (int p{ 0 }; p < PERFT_POSITION_COUNT; p++)
+	{
+		if (name == getPerftPositionName(p) || name == std::to_string(p))
+		{
+			position = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+// count one depth & print a line of results
+// - param 1: the label
+// - param 2: the board
+// - param 3: the pieces
+// - param 4: the depth
+// - param 5: the thread count
+// - return: the PerftStats
+PerftStats runPerft(const std::string& label, const TetrisEngine::Board& board, const std::vector<TetShape>& pieces, int depth, int threads)
+{
+	const auto start = std::chrono::steady_clock::now();
+	const PerftStats stats = perft(board, pieces, depth, threads);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << label << "  sequences " << stats.sequences << "  placements " << stats.placements
+		<< "  seconds " << seconds << "  placements/sec " << (seconds > 0.0 ? stats.placements / seconds : 0.0) << "\n";
+	return stats;
+}
+
+int main(int argc, char* argv[])
+{
+	int depth{ 3 };
+	int position{ 0 };
+	int threads{ 0 };
+	bool divide{ false };
+	std::uint64_t seed{ 1 };
+	PieceGenerator::Kind pieceKind{ PieceGenerator::Kind::BAG };
+	std::vector<TetShape> pieces;
+
+	for (int i{ 1 }; i < argc; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--depth") == 0 && hasValue)
+		{
+			depth = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--position") == 0 && hasValue && parsePosition(argv[i + 1], position))
+		{
+			i++;
+		}
+		else if (std::strcmp(argv[i], "--sequence") == 0 && hasValue && parseSequence(argv[i + 1], pieces))
+		{
+			i++;
+		}
+		else if (std::strcmp(argv[i], "--pieces") == 0 && hasValue && PieceGenerator::parseKind(argv[i + 1], pieceKind))
+		{
+			i++;
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+		{
+			seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+		{
+			threads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--divide") == 0)
+		{
+			divide = true;
+		}
+		else
+		{
+			std::cerr << "usage: " << argv[0]
+				<< " [--depth N] [--position empty|cave|messy] [--sequence SHAPES]\n"
+				<< "       [--pieces random|bag|history] [--seed S] [--threads T] [--divide]\n";
+			return 1;
+		}
+	}
+	if (depth < 1)
+	{
+		std::cerr << "the depth must be at least 1\n";
+		return 1;
+	}
+
+	// deal the pieces that weren't listed
+	PieceGenerator generator{ pieceKind, seed };
+	generator.seek(pieces.size());
+	while (static_cast<int>(pieces.size()) < depth)
+	{
+		pieces.push_back(generator.next());
+	}
+	if (threads <= 0)
+	{
+		threads = static_cast<int>(std::thread::hardware_concurrency());
+	}
+
+	const TetrisEngine::Board board = getPerftPosition(position);
+	std::string letters;
+	for (int d{ 0 }; d < depth; d++)
+	{
+		letters += SHAPE_LETTERS[static_cast<int>(pieces[d])];
+	}
+	std::cout << "position:  " << getPerftPositionName(position) << "\n";
+	std::cout << "pieces:    " << letters << "\n";
+
+	PerftStats single;
+	for (int d{ 1 }; d <= depth; d++)
+	{
+		single = runPerft("depth " + std::to_string(d) + " (1 thread) ", board, pieces, d, 1);
+	}
+	const PerftStats threaded = runPerft("depth " + std::to_string(depth) + " (" + std::to_string(threads) + " threads)",
+		board, pieces, depth, threads);
+
+	if (divide)
+	{
+		MoveGenerator moves;
+		const std::vector<std::uint64_t> counts = perftDivide(board, pieces, depth);
+		const std::vector<MoveGenerator::Move>& rootMoves = moves.generate(board, pieces[0]);
+		for (std::size_t m{ 0 }; m < rootMoves.size(); m++)
+		{
+			std::cout << "  rotation " << rootMoves[m].rotation << " x " << rootMoves[m].x << " y " << rootMoves[m].y
+				<< ": " << counts[m] << "\n";
+		}
+	}
+
+	if (threaded.sequences != single.sequences || threaded.placements != single.placements)
+	{
+		std::cerr << "the threaded count doesn't match the single threaded count\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,252 @@
+#include "PieceGenerator.h"
+#include <utility>
+
+// constructor
+// - param 1: the Kind of sequence
+// - param 2: the seed (the same kind & seed always deal the same sequence)
+PieceGenerator::PieceGenerator(Kind kind, std::uint64_t seed) : kind{ kind }, seed{ seed }
+{
+	reset(seed);
+}
+
+// deal the next shape of the sequence
+// - params: none
+// - return: the shape at getIndex() (which is then advanced)
+TetShape PieceGenerator::next()
+{
+	TetShape shape;
+	switch (kind)
+	{
+	case Kind::BAG:
+		if (index / SHAPE_COUNT != bagIndex)
+		{
+			bagIndex = index / SHAPE_COUNT;
+			shuffleBag(bagIndex, bag);
+		}
+		shape = bag[index % SHAPE_COUNT];
+		break;
+	case Kind::HISTORY:
+		shape = rollHistoryPiece(index, history);
+		pushHistory(history, shape);
+		break;
+	default:
+		shape = getRandomPiece(index);
+		break;
+	}
+	index++;
+	return shape;
+}
+
+// the shape at any index of the sequence, without changing the generator.
+//   O(1) for RANDOM and BAG; HISTORY replays the sequence up to the index.
+// - param 1: the piece index (0 is the first shape dealt)
+// - return: the shape
+TetShape PieceGenerator::getPiece(std::uint64_t pieceIndex) const
+{
+	switch (kind)
+	{
+	case Kind::BAG:
+	{
+		std::array<TetShape, SHAPE_COUNT> shapes;
+		shuffleBag(pieceIndex / SHAPE_COUNT, shapes);
+		return shapes[pieceIndex % SHAPE_COUNT];
+	}
+	case Kind::HISTORY:
+	{
+		PieceGenerator replay{ kind, seed };
+		replay.seek(pieceIndex);
+		return replay.next();
+	}
+	default:
+		return getRandomPiece(pieceIndex);
+	}
+}
+
+// move the generator so next() deals the shape at an index.
+//   O(1) for RANDOM and BAG; HISTORY replays the sequence up to the index.
+// - param 1: the piece index
+// - return: nothing
+void PieceGenerator::seek(std::uint64_t pieceIndex)
+{
+	if (kind == Kind::HISTORY)
+	{
+		// the history can only be rebuilt going forward
+		if (pieceIndex < index)
+		{
+			reset(seed);
+		}
+		while (index < pieceIndex)
+		{
+			next();
+		}
+		return;
+	}
+
+	index = pieceIndex;
+	if (kind == Kind::BAG && index / SHAPE_COUNT != bagIndex)
+	{
+		bagIndex = index / SHAPE_COUNT;
+		shuffleBag(bagIndex, bag);
+	}
+}
+
+// restore a position saved with getIndex() & getHistory() (eg: from a snapshot)
+//   O(1) for every Kind: the history is restored rather than replayed.
+// - param 1: the piece index
+// - param 2: the history at that index (only used by HISTORY)
+// - return: nothing
+void PieceGenerator::restore(std::uint64_t pieceIndex, const std::array<TetShape, HISTORY_SIZE>& recent)
+{
+	if (kind == Kind::HISTORY)
+	{
+		index = pieceIndex;
+		history = recent;
+	}
+	else
+	{
+		seek(pieceIndex);
+	}
+}
+
+// restart the sequence with a new seed (keeping the Kind)
+// - param 1: the seed
+// - return: nothing
+void PieceGenerator::reset(std::uint64_t seed)
+{
+	this->seed = seed;
+	index = 0;
+	bagIndex = 0;
+	shuffleBag(bagIndex, bag);
+	history = getInitialHistory();
+}
+
+// the shapes the bag the next piece comes from still holds (BAG)
+//   every shape, less the ones dealt from the bag before getIndex()
+// - params: none
+// - return: a bitmask, bit s set if TetShape s is still in the bag
+//           (all 7 at the start of a bag, 0 if the Kind isn't BAG)
+int PieceGenerator::getBagRemaining() const
+{
+	if (kind != Kind::BAG)
+	{
+		return 0;
+	}
+	std::array<TetShape, SHAPE_COUNT> shapes;
+	shuffleBag(index / SHAPE_COUNT, shapes);
+	int remaining{ (1 << SHAPE_COUNT) - 1 };
+	for (std::uint64_t dealt{ 0 }; dealt < index % SHAPE_COUNT; dealt++)
+	{
+		remaining &= ~(1 << static_cast<int>(shapes[dealt]));
+	}
+	return remaining;
+}
+
+// the name of a Kind ("random", "bag" or "history")
+// - param 1: the Kind
+// - return: the name
+std::string PieceGenerator::getKindName(Kind kind)
+{
+	switch (kind)
+	{
+	case Kind::BAG:
+		return "bag";
+	case Kind::HISTORY:
+		return "history";
+	default:
+		return "random";
+	}
+}
+
+// look a Kind up by name
+// - param 1: the name ("random", "bag" or "history")
+// - param 2: set to the Kind if the name is known
+// - return: bool, true if the name is known
+bool PieceGenerator::parseKind(const std::string& name, Kind& kind)
+{
+	for (int k{ 0 }; k < static_cast<int>(Kind::COUNT); k++)
+	{
+		if (getKindName(static_cast<Kind>(k)) == name)
+		{
+			kind = static_cast<Kind>(k);
+			return true;
+		}
+	}
+	return false;
+}
+
+// the uniformly random shape at an index (RANDOM)
+//   each index gets its own stream, so no earlier piece has to be drawn.
+// - param 1: the piece index
+// - return: the shape
+TetShape PieceGenerator::getRandomPiece(std::uint64_t pieceIndex) const
+{
+	Random rng{ Random::streamSeed(seed, pieceIndex) };
+	return Tetromino::getRandomShape(rng);
+}
+
+// shuffle one bag of all 7 shapes (BAG)
+//   a Fisher-Yates shuffle drawn from the bag's own stream.
+// - param 1: the bag index (bag b holds pieces 7b .. 7b+6)
+// - param 2: the array to shuffle the shapes into
+// - return: nothing
+void PieceGenerator::shuffleBag(std::uint64_t bagNumber, std::array<TetShape, SHAPE_COUNT>& shapes) const
+{
+	for (int i{ 0 }; i < SHAPE_COUNT; i++)
+	{
+		shapes[i] = static_cast<TetShape>(i);
+	}
+
+	Random rng{ Random::streamSeed(seed, bagNumber) };
+	for (int i{ SHAPE_COUNT - 1 }; i > 0; i--)
+	{
+		std::swap(shapes[i], shapes[rng.nextInt(i + 1)]);
+	}
+}
+
+// roll the shape at an index given the shapes dealt before it (HISTORY)
+//   up to HISTORY_ROLLS uniform rolls are made; the first one that isn't in the
+//   history is dealt, otherwise the last roll is.
+// - param 1: the piece index
+// - param 2: the last HISTORY_SIZE shapes dealt
+// - return: the shape
+TetShape PieceGenerator::rollHistoryPiece(std::uint64_t pieceIndex, const std::array<TetShape, HISTORY_SIZE>& recent) const
+{
+	Random rng{ Random::streamSeed(seed, pieceIndex) };
+	TetShape shape = TetShape::S;
+	for (int roll{ 0 }; roll < HISTORY_ROLLS; roll++)
+	{
+		shape = Tetromino::getRandomShape(rng);
+		bool isRecent = false;
+		for (TetShape dealt : recent)
+		{
+			isRecent = isRecent || dealt == shape;
+		}
+		if (!isRecent)
+		{
+			break;
+		}
+	}
+	return shape;
+}
+
+// the HISTORY state at the start of a sequence
+//   (starting with S & Z makes the awkward shapes unlikely to open a game)
+// - params: none
+// - return: the initial history
+std::array<TetShape, PieceGenerator::HISTORY_SIZE> PieceGenerator::getInitialHistory()
+{
+	return { TetShape::S, TetShape::Z, TetShape::S, TetShape::Z };
+}
+
+// add a dealt shape to a history (dropping the oldest)
+// - param 1: the history
+// - param 2: the shape dealt
+// - return: nothing
+void PieceGenerator::pushHistory(std::array<TetShape, HISTORY_SIZE>& recent, TetShape shape)
+{
+	for (int i{ 0 }; i < HISTORY_SIZE - 1; i++)
+	{
+		recent[i] = recent[i + 1];
+	}
+	recent[HISTORY_SIZE - 1] = shape;
+}
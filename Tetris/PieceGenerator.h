@@ -0,0 +1,142 @@
+// A PieceGenerator deals the sequence of shapes a game is played with.
+//
+// Three schemes are offered:
+//   - RANDOM:  every shape is drawn uniformly (the classic game),
+//   - BAG:     the 7 shapes are dealt in a shuffled "bag", then a new bag is shuffled,
+//              so droughts are at most 12 shapes long,
+//   - HISTORY: a shape is re-rolled (up to HISTORY_ROLLS times) while it matches one of
+//              the last HISTORY_SIZE shapes dealt.
+//
+// The generator is counter based: piece k of a seed only depends on (seed, k), never on
+// how the earlier pieces were drawn.  For RANDOM and BAG, getPiece(k) is computed
+// directly in constant time, so parallel workers and replays can jump anywhere in a
+// sequence without generating the pieces before it.  HISTORY depends on the shapes dealt
+// before it by design, so seeking there replays the sequence from the start (O(k)).
+
+#ifndef PIECEGENERATOR_H
+#define PIECEGENERATOR_H
+
+#include "Tetromino.h"
+#include <array>
+#include <cstdint>
+#include <string>
+
+class PieceGenerator
+{
+	friend class TestSuite;
+public:
+	// the randomization schemes
+	enum class Kind
+	{
+		RANDOM,		// uniform, independent shapes
+		BAG,		// shuffled bags of all 7 shapes
+		HISTORY,	// re-roll shapes that were dealt recently
+		COUNT
+	};
+
+	static const int SHAPE_COUNT = static_cast<int>(TetShape::COUNT);
+	static const int HISTORY_SIZE = 4;	// the number of recent shapes HISTORY avoids
+	static const int HISTORY_ROLLS = 4;	// the number of rolls HISTORY makes per shape
+
+private:
+	Kind kind;					// the scheme in use
+	std::uint64_t seed;			// the seed of the whole sequence
+	std::uint64_t index{ 0 };	// the index of the next piece next() deals
+
+	// BAG: the most recently shuffled bag (so next() shuffles once per 7 pieces)
+	std::uint64_t bagIndex{ 0 };
+	std::array<TetShape, SHAPE_COUNT> bag;
+
+	// HISTORY: the last HISTORY_SIZE shapes dealt (the most recent last)
+	std::array<TetShape, HISTORY_SIZE> history;
+
+public:
+	// constructor
+	// - param 1: the Kind of sequence
+	// - param 2: the seed (the same kind & seed always deal the same sequence)
+	explicit PieceGenerator(Kind kind = Kind::RANDOM, std::uint64_t seed = 0);
+
+	// deal the next shape of the sequence
+	// - params: none
+	// - return: the shape at getIndex() (which is then advanced)
+	TetShape next();
+
+	// the shape at any index of the sequence, without changing the generator.
+	//   O(1) for RANDOM and BAG; HISTORY replays the sequence up to the index.
+	// - param 1: the piece index (0 is the first shape dealt)
+	// - return: the shape
+	TetShape getPiece(std::uint64_t pieceIndex) const;
+
+	// move the generator so next() deals the shape at an index.
+	//   O(1) for RANDOM and BAG; HISTORY replays the sequence up to the index.
+	// - param 1: the piece index
+	// - return: nothing
+	void seek(std::uint64_t pieceIndex);
+
+	// restart the sequence with a new seed (keeping the Kind)
+	// - param 1: the seed
+	// - return: nothing
+	void reset(std::uint64_t seed);
+
+	// getters
+	Kind getKind() const { return kind; }
+	std::uint64_t getSeed() const { return seed; }
+	std::uint64_t getIndex() const { return index; }
+	const std::array<TetShape, HISTORY_SIZE>& getHistory() const { return history; }
+
+	// restore a position saved with getIndex() & getHistory() (eg: from a snapshot)
+	//   O(1) for every Kind: the history is restored rather than replayed.
+	// - param 1: the piece index
+	// - param 2: the history at that index (only used by HISTORY)
+	// - return: nothing
+	void restore(std::uint64_t pieceIndex, const std::array<TetShape, HISTORY_SIZE>& recent);
+
+	// the shapes the bag the next piece comes from still holds (BAG)
+	//   (only the pieces already dealt are looked at, so nothing is given away)
+	// - params: none
+	// - return: a bitmask, bit s set if TetShape s is still in the bag
+	//           (all 7 at the start of a bag, 0 if the Kind isn't BAG)
+	int getBagRemaining() const;
+
+	// the name of a Kind ("random", "bag" or "history")
+	// - param 1: the Kind
+	// - return: the name
+	static std::string getKindName(Kind kind);
+
+	// look a Kind up by name
+	// - param 1: the name ("random", "bag" or "history")
+	// - param 2: set to the Kind if the name is known
+	// - return: bool, true if the name is known
+	static bool parseKind(const std::string& name, Kind& kind);
+
+private:
+	// the uniformly random shape at an index (RANDOM)
+	// - param 1: the piece index
+	// - return: the shape
+	TetShape getRandomPiece(std::uint64_t pieceIndex) const;
+
+	// shuffle one bag of all 7 shapes (BAG)
+	// - param 1: the bag index (bag b holds pieces 7b .. 7b+6)
+	// - param 2: the array to shuffle the shapes into
+	// - return: nothing
+	void shuffleBag(std::uint64_t bagNumber, std::array<TetShape, SHAPE_COUNT>& shapes) const;
+
+	// roll the shape at an index given the shapes dealt before it (HISTORY)
+	// - param 1: the piece index
+	// - param 2: the last HISTORY_SIZE shapes dealt
+	// - return: the shape
+	TetShape rollHistoryPiece(std::uint64_t pieceIndex, const std::array<TetShape, HISTORY_SIZE>& recent) const;
+
+	// the HISTORY state at the start of a sequence
+	// - params: none
+	// - return: the initial history
+	static std::array<TetShape, HISTORY_SIZE> getInitialHistory();
+
+	// add a dealt shape to a history (dropping the oldest)
+	// - param 1: the history
+	// - param 2: the shape dealt
+	// - return: nothing
+	static void pushHistory(std::array<TetShape, HISTORY_SIZE>& recent, TetShape shape);
+};
+
+#endif /* PIECEGENERATOR_H */
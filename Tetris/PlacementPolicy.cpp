@@ -0,0 +1,290 @@
+#include "PlacementPolicy.h"
+
+// perform a placement on an engine using GameInput only:
+//   play the placement's path if it has one, otherwise rotate into the placement's
+//   rotation state, move towards its column (stopping early if blocked) and hard drop.
+// - param 1: the engine to play on
+// - param 2: the Placement to perform
+// - return: nothing
+void PlacementPolicy::applyPlacement(TetrisEngine& engine, const Placement& placement)
+{
+	if (!placement.path.empty())
+	{
+		for (GameInput input : placement.path)
+		{
+			engine.applyInput(input);
+		}
+		return;
+	}
+
+	for (int r{ 0 }; r < Tetromino::ROTATION_COUNT && engine.getCurrentShape().getRotation() != placement.rotation; r++)
+	{
+		engine.applyInput(GameInput::ROTATE);
+	}
+
+	int x = engine.getCurrentShape().getGridLoc().getX();
+	while (x != placement.x)
+	{
+		engine.applyInput(x < placement.x ? GameInput::RIGHT : GameInput::LEFT);
+		const int movedX = engine.getCurrentShape().getGridLoc().getX();
+		if (movedX == x)
+		{
+			break;	// blocked
+		}
+		x = movedX;
+	}
+
+	engine.applyInput(GameInput::HARD_DROP);
+}
+
+// the row (gridLoc y) a shape would land on if hard dropped from the spawn row
+// in a given rotation & column.
+// - param 1: the engine (game state)
+// - param 2: the shape
+// - param 3: the rotation state
+// - param 4: the gridLoc column
+// - return: the landing gridLoc y, or a value < spawn y if the shape can't
+//           be placed at the spawn row in that rotation & column
+int PlacementPolicy::getLandingRow(const TetrisEngine& engine, TetShape shape, int rotation, int x)
+{
+	int y = engine.getBoard().getSpawnLoc().getY();
+	if (!engine.doesShapeFit(shape, rotation, x, y))
+	{
+		return y - 1;
+	}
+	return engine.getDropRow(shape, rotation, x, y);
+}
+
+// the time a choice with a time budget should stop by
+// - param 1: the budget (0: none)
+// - return: the deadline (Clock::time_point::max() if there is no budget)
+PlacementPolicy::Clock::time_point PlacementPolicy::getDeadline(TetrisEngine::Nanoseconds budget)
+{
+	if (budget <= 0)
+	{
+		return Clock::time_point::max();
+	}
+	return Clock::now() + std::chrono::nanoseconds(budget);
+}
+
+// the pieces a lookahead knows: the engine's current & next shapes
+// - param 1: the engine (game state)
+// - param 2: the vector to fill
+// - return: nothing
+void PlacementPolicy::getKnownPieces(const TetrisEngine& engine, std::vector<TetShape>& pieces)
+{
+	pieces.assign({ engine.getCurrentShape().getShape(), engine.getNextShape().getShape() });
+}
+
+// the placement of a lookahead's answer: the path to its lock position, or if the
+// lookahead found none (the game is about to end) a plain drop where the shape is
+// - param 1: the engine (game state) the lookahead searched
+// - param 2: the generator to find the path with
+// - param 3: bool, true if the lookahead found a lock position
+// - param 4: the lock position
+// - return: the Placement
+Placement PlacementPolicy::getSearchPlacement(const TetrisEngine& engine, MoveGenerator& generator, bool found,
+	const MoveGenerator::Move& move)
+{
+	const GridTetromino& shape = engine.getCurrentShape();
+	Placement placement;
+	placement.rotation = shape.getRotation();
+	placement.x = shape.getGridLoc().getX();
+	if (found)
+	{
+		placement.rotation = move.rotation;
+		placement.x = move.x;
+		generator.generate(engine.getBoard(), shape);
+		generator.getPath(move, placement.path);
+	}
+	return placement;
+}
+
+RandomPolicy::RandomPolicy(std::uint64_t seed) : rng{ seed }
+{
+}
+
+// choose a uniformly random rotation & column.
+Placement RandomPolicy::choosePlacement(const TetrisEngine&)
+{
+	Placement placement;
+	placement.rotation = rng.nextInt(Tetromino::ROTATION_COUNT);
+	placement.x = rng.nextInt(TetrisEngine::Board::MAX_X);
+	return placement;
+}
+
+// choose the rotation & column where the shape lands lowest on the board.
+//   Only placements reachable by a straight slide along the spawn row are considered.
+Placement LowestPolicy::choosePlacement(const TetrisEngine& engine)
+{
+	const GridTetromino& shape = engine.getCurrentShape();
+	const int spawnY = shape.getGridLoc().getY();
+
+	Placement best;
+	best.rotation = shape.getRotation();
+	best.x = shape.getGridLoc().getX();
+	int bestRow = spawnY - 1;
+
+	for (int r{ 0 }; r < Tetromino::ROTATION_COUNT; r++)
+	{
+		// a rotation has to be legal at the spawn location before we can slide it
+		if (!engine.doesShapeFit(shape.getShape(), r, shape.getGridLoc().getX(), spawnY))
+		{
+			continue;
+		}
+
+		// slide left then right from the spawn column until blocked
+		for (int direction : { -1, 1 })
+		{
+			for (int x{ shape.getGridLoc().getX() }; engine.doesShapeFit(shape.getShape(), r, x, spawnY); x += direction)
+			{
+				const int row = getLandingRow(engine, shape.getShape(), r, x);
+				if (row > bestRow || (row == bestRow && x < best.x))
+				{
+					bestRow = row;
+					best.rotation = r;
+					best.x = x;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+GreedyPolicy::GreedyPolicy(const Evaluator::Weights& weights) : evaluator{ weights }
+{
+}
+
+// choose the rotation & column that leaves the best scored board.
+//   The candidates are the placements LowestPolicy considers (a straight slide along
+//   the spawn row, then a hard drop); they are scored in one batch.
+Placement GreedyPolicy::choosePlacement(const TetrisEngine& engine)
+{
+	const GridTetromino& shape = engine.getCurrentShape();
+	const int spawnY = shape.getGridLoc().getY();
+
+	moves.clear();
+	for (int r{ 0 }; r < Tetromino::ROTATION_COUNT; r++)
+	{
+		if (!engine.doesShapeFit(shape.getShape(), r, shape.getGridLoc().getX(), spawnY))
+		{
+			continue;
+		}
+		for (int direction : { -1, 1 })
+		{
+			// the spawn column is only taken once (going left)
+			int x{ shape.getGridLoc().getX() + (direction > 0 ? 1 : 0) };
+			for (; engine.doesShapeFit(shape.getShape(), r, x, spawnY); x += direction)
+			{
+				moves.push_back(MoveGenerator::Move{ r, x, engine.getDropRow(shape.getShape(), r, x, spawnY) });
+			}
+		}
+	}
+
+	Placement best;
+	best.rotation = shape.getRotation();
+	best.x = shape.getGridLoc().getX();
+	evaluator.scoreMoves(engine.getBoard(), shape.getShape(), moves, scores);
+	std::size_t bestMove{ 0 };
+	for (std::size_t m{ 1 }; m < moves.size(); m++)
+	{
+		if (scores[m] > scores[bestMove])
+		{
+			bestMove = m;
+		}
+	}
+	if (!moves.empty())
+	{
+		best.rotation = moves[bestMove].rotation;
+		best.x = moves[bestMove].x;
+	}
+	return best;
+}
+
+const TetrisEngine::Nanoseconds BeamPolicy::DEFAULT_BUDGET = 50000000;
+
+BeamPolicy::BeamPolicy(int beamWidth, TetrisEngine::Nanoseconds budget) : search{ beamWidth }, budget{ budget }
+{
+}
+
+// search the current & next shapes' placements & take the path to the best first one.
+Placement BeamPolicy::choosePlacement(const TetrisEngine& engine)
+{
+	getKnownPieces(engine, pieces);
+	const BeamSearch::Result result = search.search(engine.getBoard(), pieces, getDeadline(budget));
+	return getSearchPlacement(engine, generator, result.found, result.move);
+}
+
+ParallelPolicy::ParallelPolicy(int threads, TetrisEngine::Nanoseconds budget) : search{ threads }, budget{ budget }
+{
+}
+
+// search the current & next shapes' placement sequences & take the path to the best first one.
+Placement ParallelPolicy::choosePlacement(const TetrisEngine& engine)
+{
+	getKnownPieces(engine, pieces);
+	const ParallelSearch::Result result = search.search(engine.getBoard(), pieces, getDeadline(budget));
+	return getSearchPlacement(engine, generator, result.found, result.move);
+}
+
+const TetrisEngine::Nanoseconds ExpectimaxPolicy::DEFAULT_BUDGET = TetrisEngine::MIN_NANOSECONDS_PER_TICK / 2;
+
+ExpectimaxPolicy::ExpectimaxPolicy(int maxUnknown, TetrisEngine::Nanoseconds budget) : search{ maxUnknown }, budget{ budget }
+{
+}
+
+// search the current & next shapes' placements, averaged over the shapes that can
+// follow them, & take the path to the best first one.
+Placement ExpectimaxPolicy::choosePlacement(const TetrisEngine& engine)
+{
+	getKnownPieces(engine, pieces);
+	const ExpectimaxSearch::Result result = search.search(engine.getBoard(), pieces,
+		engine.getPieceGenerator().getBagRemaining(), getDeadline(budget));
+	return getSearchPlacement(engine, generator, result.found, result.move);
+}
+
+// check a policy name (without creating the policy)
+// - param 1: the policy name
+// - return: bool, true if createPolicy() knows the name
+bool isPolicyName(const std::string& name)
+{
+	return name == "random" || name == "lowest" || name == "greedy" || name == "beam"
+		|| name == "parallel" || name == "expectimax";
+}
+
+// create a policy by name
+// - param 1: the policy name ("random", "lowest", "greedy", "beam", "parallel" or "expectimax")
+// - param 2: a seed for policies that make random choices
+// - param 3: the PolicyOptions
+// - return: the policy, or nullptr if the name is unknown
+std::unique_ptr<PlacementPolicy> createPolicy(const std::string& name, std::uint64_t seed, const PolicyOptions& options)
+{
+	if (name == "random")
+	{
+		return std::unique_ptr<PlacementPolicy>(new RandomPolicy(seed));
+	}
+	if (name == "lowest")
+	{
+		return std::unique_ptr<PlacementPolicy>(new LowestPolicy());
+	}
+	if (name == "greedy")
+	{
+		return std::unique_ptr<PlacementPolicy>(new GreedyPolicy());
+	}
+	if (name == "beam")
+	{
+		return std::unique_ptr<PlacementPolicy>(new BeamPolicy(BeamSearch::DEFAULT_BEAM_WIDTH,
+			options.timed ? BeamPolicy::DEFAULT_BUDGET : 0));
+	}
+	if (name == "parallel")
+	{
+		return std::unique_ptr<PlacementPolicy>(new ParallelPolicy(options.searchThreads,
+			options.timed ? BeamPolicy::DEFAULT_BUDGET : 0));
+	}
+	if (name == "expectimax")
+	{
+		return std::unique_ptr<PlacementPolicy>(new ExpectimaxPolicy(ExpectimaxSearch::DEFAULT_MAX_UNKNOWN,
+			options.timed ? ExpectimaxPolicy::DEFAULT_BUDGET : 0));
+	}
+	return nullptr;
+}
@@ -0,0 +1,208 @@
+// A PlacementPolicy decides where the current shape of a (headless) game should go.
+// Policies are what the simulation plays with: each time a new shape spawns the
+// simulation asks the policy for a Placement and then performs it with ordinary
+// engine input (rotate, move left/right, hard drop), so every placement obeys the
+// same rules a player would.
+//
+// New policies only need to implement choosePlacement() and getName(), and be
+// added to createPolicy() (and isPolicyName()) so the simulation binaries can select them by name.
+// A policy is only ever used by one thread at a time (batch simulations create one
+// per worker thread) and is reset() with a new seed before every game.
+
+#ifndef PLACEMENTPOLICY_H
+#define PLACEMENTPOLICY_H
+
+#include "BeamSearch.h"
+#include "Evaluator.h"
+#include "ExpectimaxSearch.h"
+#include "ParallelSearch.h"
+#include "TetrisEngine.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// where to put a shape: the rotation state it should be in and the
+// gridLoc column it should be hard dropped from.
+//   A policy that finds lock positions a straight drop can't reach (tucks & spins)
+//   gives the inputs that get there instead.
+struct Placement
+{
+	int rotation{ 0 };
+	int x{ 0 };
+	std::vector<GameInput> path;	// if not empty: the inputs to play (ending with a HARD_DROP)
+};
+
+class PlacementPolicy
+{
+public:
+	virtual ~PlacementPolicy() = default;
+
+	// the name used to select this policy (eg: on the command line)
+	virtual std::string getName() const = 0;
+
+	// choose a placement for the engine's current shape
+	// - param 1: the engine (game state) to choose for
+	// - return: a Placement
+	virtual Placement choosePlacement(const TetrisEngine& engine) = 0;
+
+	// get ready for a new game (policies that make random choices reseed here)
+	// - param 1: the seed for the game
+	// - return: nothing
+	virtual void reset(std::uint64_t /*seed*/) {}
+
+	// perform a placement on an engine using GameInput only:
+	//   play the placement's path if it has one, otherwise rotate into the placement's
+	//   rotation state, move towards its column (stopping early if blocked) and hard drop.
+	// - param 1: the engine to play on
+	// - param 2: the Placement to perform
+	// - return: nothing
+	static void applyPlacement(TetrisEngine& engine, const Placement& placement);
+
+	// the row (gridLoc y) a shape would land on if hard dropped from the spawn row
+	// in a given rotation & column.
+	// - param 1: the engine (game state)
+	// - param 2: the shape
+	// - param 3: the rotation state
+	// - param 4: the gridLoc column
+	// - return: the landing gridLoc y, or a value < spawn y if the shape can't
+	//           be placed at the spawn row in that rotation & column
+	static int getLandingRow(const TetrisEngine& engine, TetShape shape, int rotation, int x);
+
+protected:
+	typedef std::chrono::steady_clock Clock;
+
+	// the time a choice with a time budget should stop by
+	// - param 1: the budget (0: none)
+	// - return: the deadline (Clock::time_point::max() if there is no budget)
+	static Clock::time_point getDeadline(TetrisEngine::Nanoseconds budget);
+
+	// the pieces a lookahead knows: the engine's current & next shapes
+	// - param 1: the engine (game state)
+	// - param 2: the vector to fill
+	// - return: nothing
+	static void getKnownPieces(const TetrisEngine& engine, std::vector<TetShape>& pieces);
+
+	// the placement of a lookahead's answer: the path to its lock position, or if the
+	// lookahead found none (the game is about to end) a plain drop where the shape is
+	// - param 1: the engine (game state) the lookahead searched
+	// - param 2: the generator to find the path with
+	// - param 3: bool, true if the lookahead found a lock position
+	// - param 4: the lock position
+	// - return: the Placement
+	static Placement getSearchPlacement(const TetrisEngine& engine, MoveGenerator& generator, bool found,
+		const MoveGenerator::Move& move);
+};
+
+// Chooses a uniformly random rotation & column.  The baseline for throughput runs.
+class RandomPolicy : public PlacementPolicy
+{
+private:
+	Random rng;	// this policy's own random stream
+public:
+	explicit RandomPolicy(std::uint64_t seed);
+	std::string getName() const override { return "random"; }
+	Placement choosePlacement(const TetrisEngine& engine) override;
+	void reset(std::uint64_t seed) override { rng = Random{ seed }; }
+};
+
+// Chooses the rotation & column where the shape lands lowest on the board
+// (ties go to the leftmost column).  A cheap policy that keeps games alive.
+class LowestPolicy : public PlacementPolicy
+{
+public:
+	std::string getName() const override { return "lowest"; }
+	Placement choosePlacement(const TetrisEngine& engine) override;
+};
+
+// Scores every rotation & column the LowestPolicy considers with an Evaluator and
+// chooses the best (ties go to the first found).  A one piece lookahead bot.
+class GreedyPolicy : public PlacementPolicy
+{
+private:
+	Evaluator evaluator;						// scores the candidate placements
+	std::vector<MoveGenerator::Move> moves;	// the candidate lock positions (kept between calls)
+	std::vector<double> scores;					// the score of each candidate
+public:
+	explicit GreedyPolicy(const Evaluator::Weights& weights = Evaluator::Weights{});
+	std::string getName() const override { return "greedy"; }
+	Placement choosePlacement(const TetrisEngine& engine) override;
+};
+
+// Looks ahead over the current & next shapes with a BeamSearch (every reachable lock
+// position, tucks & spins included) and plays the path to the best first placement.
+// Each choice stops at a time budget (with a budget of 0 it searches both shapes).
+class BeamPolicy : public PlacementPolicy
+{
+private:
+	BeamSearch search;					// the lookahead
+	TetrisEngine::Nanoseconds budget;	// the time each choice may take
+	MoveGenerator generator;			// finds the path to the chosen lock position
+	std::vector<TetShape> pieces;		// the known pieces (kept between calls)
+public:
+	static const TetrisEngine::Nanoseconds DEFAULT_BUDGET;	// init to 50ms
+
+	BeamPolicy(int beamWidth = BeamSearch::DEFAULT_BEAM_WIDTH, TetrisEngine::Nanoseconds budget = DEFAULT_BUDGET);
+	std::string getName() const override { return "beam"; }
+	Placement choosePlacement(const TetrisEngine& engine) override;
+};
+
+// Searches every placement sequence of the current & next shapes with a
+// ParallelSearch (spread over worker threads) and plays the path to the best first
+// placement.  Each choice stops at a time budget (with a budget of 0 it searches
+// both shapes).
+class ParallelPolicy : public PlacementPolicy
+{
+private:
+	ParallelSearch search;				// the lookahead
+	TetrisEngine::Nanoseconds budget;	// the time each choice may take
+	MoveGenerator generator;			// finds the path to the chosen lock position
+	std::vector<TetShape> pieces;		// the known pieces (kept between calls)
+public:
+	ParallelPolicy(int threads = 0, TetrisEngine::Nanoseconds budget = BeamPolicy::DEFAULT_BUDGET);
+	std::string getName() const override { return "parallel"; }
+	Placement choosePlacement(const TetrisEngine& engine) override;
+};
+
+// Looks ahead over the current & next shapes and the shapes that could follow them
+// with an ExpectimaxSearch (averaging over what the game's generator can deal: the
+// rest of the bag, or any shape) and plays the path to the best first placement.
+// Each choice stops at a time budget that fits within the fastest tick (with a
+// budget of 0 it searches up to the search's maximum of unknown pieces).
+class ExpectimaxPolicy : public PlacementPolicy
+{
+private:
+	ExpectimaxSearch search;			// the lookahead
+	TetrisEngine::Nanoseconds budget;	// the time each choice may take
+	MoveGenerator generator;			// finds the path to the chosen lock position
+	std::vector<TetShape> pieces;		// the known pieces (kept between calls)
+public:
+	static const TetrisEngine::Nanoseconds DEFAULT_BUDGET;	// init to half of TetrisEngine::MIN_NANOSECONDS_PER_TICK
+
+	ExpectimaxPolicy(int maxUnknown = ExpectimaxSearch::DEFAULT_MAX_UNKNOWN, TetrisEngine::Nanoseconds budget = DEFAULT_BUDGET);
+	std::string getName() const override { return "expectimax"; }
+	Placement choosePlacement(const TetrisEngine& engine) override;
+};
+
+// how createPolicy() sets up the searching policies
+struct PolicyOptions
+{
+	int searchThreads{ 0 };		// the parallel policy's search threads (0: one per hardware thread)
+	bool timed{ true };			// false: the lookahead policies (beam, parallel & expectimax) have no
+								// time budget, so their choices don't depend on the machine's speed
+};
+
+// check a policy name (without creating the policy)
+// - param 1: the policy name
+// - return: bool, true if createPolicy() knows the name
+bool isPolicyName(const std::string& name);
+
+// create a policy by name
+// - param 1: the policy name ("random", "lowest", "greedy", "beam", "parallel" or "expectimax")
+// - param 2: a seed for policies that make random choices
+// - param 3: the PolicyOptions
+// - return: the policy, or nullptr if the name is unknown
+std::unique_ptr<PlacementPolicy> createPolicy(const std::string& name, std::uint64_t seed,
+	const PolicyOptions& options = PolicyOptions{});
+
+#endif /* PLACEMENTPOLICY_H */
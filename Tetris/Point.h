@@ -10,16 +10,14 @@ private:
 	int x;
 	int y;
 public:
-	Point() : x{ 0 }, y{0}
+	constexpr Point() : x{ 0 }, y{0}
 	{
 	}
-	Point(int x, int y) 
+	constexpr Point(int x, int y) : x{ x }, y{ y }
 	{
-		this->x = x;
-		this->y = y;
 	}
-	int getX() const{ return x; }
-	int getY() const{ return y; }
+	constexpr int getX() const{ return x; }
+	constexpr int getY() const{ return y; }
 	void setX(int x);
 	void setY(int y); 
 	void setXY(int x, int y);
@@ -0,0 +1,89 @@
+// A small, fast, splittable pseudo random number generator (SplitMix64).
+//
+// Every game (and every policy) owns its own Random instead of sharing the
+// global rand(), so:
+//   - games can run on any number of threads at once,
+//   - the same seed always produces the same sequence,
+//   - a stream can be split into independent child streams (eg: one per game of
+//     a batch) so results don't depend on which thread played which game.
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+class Random
+{
+private:
+	std::uint64_t state;	// advanced by GOLDEN_GAMMA on every draw
+
+public:
+	static constexpr std::uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;	// 2^64 / golden ratio (odd)
+
+	// constructor
+	// - param 1: the seed (any value, including 0)
+	explicit Random(std::uint64_t seed = 0) : state{ seed }
+	{
+	}
+
+	// scramble a 64 bit value (the SplitMix64 output function)
+	// - param 1: the value
+	// - return: the mixed value
+	static constexpr std::uint64_t mix(std::uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// the seed of stream number 'index' derived from a master seed
+	//   (streams of the same master seed are independent of each other)
+	// - param 1: the master seed
+	// - param 2: the stream index
+	// - return: a seed for the stream
+	static constexpr std::uint64_t streamSeed(std::uint64_t masterSeed, std::uint64_t index)
+	{
+		return mix(mix(masterSeed) + GOLDEN_GAMMA * (index + 1));
+	}
+
+	// the next 64 random bits
+	std::uint64_t next()
+	{
+		state += GOLDEN_GAMMA;
+		return mix(state);
+	}
+
+	// a uniformly distributed int in [0, bound) (unbiased, bound > 0)
+	// - param 1: int bound
+	// - return: the int
+	int nextInt(int bound)
+	{
+		// Lemire's multiply-shift with rejection of the biased low range
+		const std::uint32_t range = static_cast<std::uint32_t>(bound);
+		std::uint64_t product = (next() >> 32) * range;
+		std::uint32_t low = static_cast<std::uint32_t>(product);
+		if (low < range)
+		{
+			const std::uint32_t threshold = (0u - range) % range;
+			while (low < threshold)
+			{
+				product = (next() >> 32) * range;
+				low = static_cast<std::uint32_t>(product);
+			}
+		}
+		return static_cast<int>(product >> 32);
+	}
+
+	// split off an independent child stream (advances this stream once)
+	// - return: the child Random
+	Random split()
+	{
+		return Random{ mix(next() ^ 0xD1B54A32D192ED03ull) };
+	}
+
+	// the current state (so a stream can be saved & restored)
+	std::uint64_t getState() const { return state; }
+	void setState(std::uint64_t state) { this->state = state; }
+};
+
+#endif /* RANDOM_H */
@@ -0,0 +1,495 @@
+#include "Replay.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+// Static Constants
+const std::uint8_t Replay::VERSION = 2;
+const int Replay::INPUT_BITS = 3;
+const int Replay::MAX_PACKED_TICKS = 30;
+const int Replay::TICKS_ONLY = 7;
+const int Replay::DEFAULT_KEYFRAME_INTERVAL = 500;
+
+namespace
+{
+	const char MAGIC[4] = { 'T', 'R', 'P', 'L' };
+	const int HEADER_SIZE = 4 + 4 + 8 + 8 + 4 + 8;	// magic, version/width/height/kind, seed, first piece, keyframe interval, event bytes
+	const int ESCAPE_TICKS = 31;			// the packed tick delta meaning "a varint count follows"
+
+	// append a value of BYTES bytes (little endian)
+	template<int BYTES>
+	void writeLittleEndian(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+	{
+		for (int i{ 0 }; i < BYTES; i++)
+		{
+			bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+		}
+	}
+
+	// read a value of BYTES bytes (little endian)
+	template<int BYTES>
+	std::uint64_t readLittleEndian(const std::uint8_t* bytes)
+	{
+		std::uint64_t value{ 0 };
+		for (int i{ 0 }; i < BYTES; i++)
+		{
+			value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+		}
+		return value;
+	}
+
+	void writeU32(std::vector<std::uint8_t>& bytes, std::uint32_t value) { writeLittleEndian<4>(bytes, value); }
+	void writeU64(std::vector<std::uint8_t>& bytes, std::uint64_t value) { writeLittleEndian<8>(bytes, value); }
+	std::uint32_t readU32(const std::uint8_t* bytes) { return static_cast<std::uint32_t>(readLittleEndian<4>(bytes)); }
+	std::uint64_t readU64(const std::uint8_t* bytes) { return readLittleEndian<8>(bytes); }
+
+	const int SHAPE_SIZE = 1 + 1 + 4 + 4;	// shape, rotation, gridLoc x & y
+
+	// the bytes a serialized keyframe takes on a board of the given dimensions
+	std::size_t getKeyframeSize(int width, int height)
+	{
+		return 8 + 8											// event offset, ticks consumed
+			+ static_cast<std::size_t>(width) * height			// board content
+			+ 2 * SHAPE_SIZE									// current & next shapes
+			+ 8 + PieceGenerator::HISTORY_SIZE					// piece index & history
+			+ 4 + 4 + 4 + 1										// removed rows, score, piece count, game over
+			+ 8 + 8 + 8;										// the tick rate, time since the last tick & game time
+	}
+
+	// append a shape's state
+	void writeShape(std::vector<std::uint8_t>& bytes, const GridTetromino& shape)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(shape.getShape()));
+		bytes.push_back(static_cast<std::uint8_t>(shape.getRotation()));
+		writeU32(bytes, static_cast<std::uint32_t>(shape.getGridLoc().getX()));
+		writeU32(bytes, static_cast<std::uint32_t>(shape.getGridLoc().getY()));
+	}
+
+	// read a shape's state (advancing the position)
+	bool readShape(const std::vector<std::uint8_t>& bytes, std::size_t& position, GridTetromino& shape)
+	{
+		if (bytes[position] >= static_cast<std::uint8_t>(TetShape::COUNT))
+		{
+			return false;
+		}
+		shape.setShape(static_cast<TetShape>(bytes[position]));
+		shape.setRotation(bytes[position + 1]);
+		shape.setGridLoc(static_cast<std::int32_t>(readU32(&bytes[position + 2])), static_cast<std::int32_t>(readU32(&bytes[position + 6])));
+		position += SHAPE_SIZE;
+		return true;
+	}
+
+	// append a keyframe (in getKeyframeSize() bytes)
+	void writeKeyframe(std::vector<std::uint8_t>& bytes, const Replay::Keyframe& keyframe)
+	{
+		typedef TetrisEngine::Board Board;
+		const TetrisEngine::Snapshot& snapshot = keyframe.snapshot;
+		writeU64(bytes, keyframe.eventOffset);
+		writeU64(bytes, static_cast<std::uint64_t>(keyframe.ticksConsumed));
+		for (int y{ 0 }; y < Board::MAX_Y; y++)
+		{
+			for (int x{ 0 }; x < Board::MAX_X; x++)
+			{
+				bytes.push_back(static_cast<std::uint8_t>(snapshot.board.getContent(x, y)));
+			}
+		}
+		writeShape(bytes, snapshot.currentShape);
+		writeShape(bytes, snapshot.nextShape);
+		writeU64(bytes, snapshot.pieces.getIndex());
+		for (TetShape shape : snapshot.pieces.getHistory())
+		{
+			bytes.push_back(static_cast<std::uint8_t>(shape));
+		}
+		writeU32(bytes, static_cast<std::uint32_t>(snapshot.totalRemovedRows));
+		writeU32(bytes, static_cast<std::uint32_t>(snapshot.score));
+		writeU32(bytes, static_cast<std::uint32_t>(snapshot.pieceCount));
+		bytes.push_back(snapshot.gameOver ? 1 : 0);
+		writeU64(bytes, static_cast<std::uint64_t>(snapshot.nanosecondsPerTick));
+		writeU64(bytes, static_cast<std::uint64_t>(snapshot.nanosecondsSinceLastTick));
+		writeU64(bytes, static_cast<std::uint64_t>(snapshot.gameTime));
+	}
+
+	// read a keyframe of this engine's board (advancing the position)
+	//   (the snapshot's piece generator must already have the replay's kind & seed)
+	bool readKeyframe(const std::vector<std::uint8_t>& bytes, std::size_t& position, Replay::Keyframe& keyframe)
+	{
+		typedef TetrisEngine::Board Board;
+		TetrisEngine::Snapshot& snapshot = keyframe.snapshot;
+		keyframe.eventOffset = static_cast<std::size_t>(readU64(&bytes[position]));
+		keyframe.ticksConsumed = static_cast<long long>(readU64(&bytes[position + 8]));
+		position += 16;
+		for (int y{ 0 }; y < Board::MAX_Y; y++)
+		{
+			for (int x{ 0 }; x < Board::MAX_X; x++)
+			{
+				const int content = static_cast<signed char>(bytes[position++]);
+				if (content < Board::EMPTY_BLOCK || content >= static_cast<int>(TetShape::COUNT))
+				{
+					return false;
+				}
+				snapshot.board.setContent(x, y, content);
+			}
+		}
+		if (!readShape(bytes, position, snapshot.currentShape) || !readShape(bytes, position, snapshot.nextShape))
+		{
+			return false;
+		}
+
+		const std::uint64_t pieceIndex = readU64(&bytes[position]);
+		position += 8;
+		std::array<TetShape, PieceGenerator::HISTORY_SIZE> history;
+		for (TetShape& shape : history)
+		{
+			if (bytes[position] >= static_cast<std::uint8_t>(TetShape::COUNT))
+			{
+				return false;
+			}
+			shape = static_cast<TetShape>(bytes[position++]);
+		}
+		snapshot.pieces.restore(pieceIndex, history);
+
+		snapshot.totalRemovedRows = static_cast<int>(readU32(&bytes[position]));
+		snapshot.score = static_cast<int>(readU32(&bytes[position + 4]));
+		snapshot.pieceCount = static_cast<int>(readU32(&bytes[position + 8]));
+		snapshot.gameOver = bytes[position + 12] != 0;
+		position += 13;
+		snapshot.nanosecondsPerTick = static_cast<TetrisEngine::Nanoseconds>(readU64(&bytes[position]));
+		snapshot.nanosecondsSinceLastTick = static_cast<TetrisEngine::Nanoseconds>(readU64(&bytes[position + 8]));
+		snapshot.gameTime = static_cast<TetrisEngine::Nanoseconds>(readU64(&bytes[position + 16]));
+		position += 24;
+		return true;
+	}
+}
+
+// start a new recording (discarding any previous one, but keeping the keyframe interval)
+// - param 1: the board width
+// - param 2: the board height
+// - param 3: the piece generator at the start of the game (before any piece is dealt)
+// - return: nothing
+void Replay::begin(int width, int height, const PieceGenerator& pieces)
+{
+	boardWidth = width;
+	boardHeight = height;
+	pieceKind = pieces.getKind();
+	seed = pieces.getSeed();
+	firstPiece = pieces.getIndex();
+	events.clear();
+	keyframes.clear();
+	inputCount = 0;
+	tickCount = 0;
+	pendingTicks = 0;
+}
+
+// record an input (timestamped with the ticks since the previous event)
+// - param 1: the GameInput
+// - return: nothing
+void Replay::recordInput(GameInput input)
+{
+	packEvent(events, static_cast<int>(input), pendingTicks);
+	pendingTicks = 0;
+	inputCount++;
+}
+
+// record that a piece locked (keeps a keyframe every keyframeInterval pieces)
+// - param 1: the engine, just after the lock
+// - return: nothing
+void Replay::recordLock(const TetrisEngine& engine)
+{
+	if (keyframeInterval > 0 && engine.getPieceCount() % keyframeInterval == 0)
+	{
+		Keyframe keyframe;
+		keyframe.eventOffset = events.size();
+		keyframe.ticksConsumed = pendingTicks;
+		keyframe.snapshot = engine.getSnapshot();
+		keyframes.push_back(keyframe);
+	}
+}
+
+// play the replay back on an engine, from a reset.
+//   Drives the engine with tick() & applyInput() only (the engine's clock is
+//   not used), so playback runs as fast as the engine allows.
+// - param 1: the engine (its recording, if any, records the playback)
+// - return: bool, false if the replay is for a different board or is malformed
+bool Replay::playBack(TetrisEngine& engine) const
+{
+	if (boardWidth != TetrisEngine::Board::MAX_X || boardHeight != TetrisEngine::Board::MAX_Y)
+	{
+		return false;
+	}
+
+	PieceGenerator pieces{ pieceKind, seed };
+	pieces.seek(firstPiece);
+	engine.reset(pieces);
+	return playEvents(engine, 0, 0, LLONG_MAX);
+}
+
+// put an engine into the state the game was in when a given number of pieces had
+// locked: restore the nearest keyframe at or before it, then play only the gap.
+//   (seeking past the end of the game leaves the engine at the end of the game)
+// - param 1: the engine (its recording isn't updated)
+// - param 2: the locked piece count to seek to (0: the start of the game)
+// - return: bool, false if the replay is for a different board or is malformed
+bool Replay::seek(TetrisEngine& engine, long long pieceCount) const
+{
+	if (boardWidth != TetrisEngine::Board::MAX_X || boardHeight != TetrisEngine::Board::MAX_Y)
+	{
+		return false;
+	}
+
+	// the last keyframe at or before the piece count (keyframes are in piece count order)
+	auto after = std::upper_bound(keyframes.begin(), keyframes.end(), pieceCount,
+		[](long long count, const Keyframe& keyframe) { return count < keyframe.snapshot.pieceCount; });
+	if (after == keyframes.begin())
+	{
+		// the start of the game (reset on a scratch engine, so the engine's recording isn't restarted)
+		PieceGenerator pieces{ pieceKind, seed };
+		pieces.seek(firstPiece);
+		TetrisEngine start;
+		start.reset(pieces);
+		engine.restoreSnapshot(start.getSnapshot());
+		return pieceCount <= 0 || playEvents(engine, 0, 0, pieceCount);
+	}
+
+	const Keyframe& keyframe = *(after - 1);
+	engine.restoreSnapshot(keyframe.snapshot);
+	return engine.getPieceCount() >= pieceCount ||
+		playEvents(engine, keyframe.eventOffset, keyframe.ticksConsumed, pieceCount);
+}
+
+// the replay in its binary format
+//   "TRPL", version, board width & height, piece kind, seed & first piece,
+//   the keyframe interval, the packed events then the keyframes (little endian).
+// - params: none
+// - return: the bytes
+std::vector<std::uint8_t> Replay::serialize() const
+{
+	std::vector<std::uint8_t> stream = events;
+	if (pendingTicks > 0)
+	{
+		packEvent(stream, TICKS_ONLY, pendingTicks);
+	}
+
+	std::vector<std::uint8_t> bytes(MAGIC, MAGIC + 4);
+	bytes.reserve(HEADER_SIZE + stream.size() + keyframes.size() * getKeyframeSize(boardWidth, boardHeight) + 4);
+	bytes.push_back(VERSION);
+	bytes.push_back(static_cast<std::uint8_t>(boardWidth));
+	bytes.push_back(static_cast<std::uint8_t>(boardHeight));
+	bytes.push_back(static_cast<std::uint8_t>(pieceKind));
+	writeU64(bytes, seed);
+	writeU64(bytes, firstPiece);
+	writeU32(bytes, static_cast<std::uint32_t>(keyframeInterval));
+	writeU64(bytes, stream.size());
+	bytes.insert(bytes.end(), stream.begin(), stream.end());
+
+	writeU32(bytes, static_cast<std::uint32_t>(keyframes.size()));
+	for (const Keyframe& keyframe : keyframes)
+	{
+		writeKeyframe(bytes, keyframe);
+	}
+	return bytes;
+}
+
+// read a replay from its binary format
+// - param 1: the bytes
+// - return: bool, false (and the replay is unchanged) if the bytes aren't a valid replay
+bool Replay::deserialize(const std::vector<std::uint8_t>& bytes)
+{
+	if (bytes.size() < HEADER_SIZE || !std::equal(MAGIC, MAGIC + 4, bytes.begin()) || bytes[4] != VERSION ||
+		bytes[7] >= static_cast<std::uint8_t>(PieceGenerator::Kind::COUNT))
+	{
+		return false;
+	}
+
+	Replay replay;
+	replay.boardWidth = bytes[5];
+	replay.boardHeight = bytes[6];
+	replay.pieceKind = static_cast<PieceGenerator::Kind>(bytes[7]);
+	replay.seed = readU64(&bytes[8]);
+	replay.firstPiece = readU64(&bytes[16]);
+	replay.keyframeInterval = static_cast<int>(readU32(&bytes[24]));
+	const std::uint64_t eventBytes = readU64(&bytes[28]);
+	if (eventBytes > bytes.size() - HEADER_SIZE)
+	{
+		return false;
+	}
+	replay.events.assign(bytes.begin() + HEADER_SIZE, bytes.begin() + HEADER_SIZE + static_cast<std::size_t>(eventBytes));
+
+	// count the events (and reject a truncated stream)
+	std::size_t position{ 0 };
+	while (position < replay.events.size())
+	{
+		int inputCode;
+		long long ticks;
+		if (!unpackEvent(replay.events, position, inputCode, ticks) ||
+			(inputCode != TICKS_ONLY && inputCode >= static_cast<int>(GameInput::COUNT)))
+		{
+			return false;
+		}
+		replay.tickCount += ticks;
+		if (inputCode != TICKS_ONLY)
+		{
+			replay.inputCount++;
+		}
+	}
+
+	// the keyframes (only kept if they are for this engine's board)
+	position = HEADER_SIZE + static_cast<std::size_t>(eventBytes);
+	if (bytes.size() - position < 4)
+	{
+		return false;
+	}
+	const std::uint32_t keyframeCount = readU32(&bytes[position]);
+	position += 4;
+	const std::size_t keyframeSize = getKeyframeSize(replay.boardWidth, replay.boardHeight);
+	if (bytes.size() - position != keyframeCount * keyframeSize)
+	{
+		return false;
+	}
+	if (replay.boardWidth == TetrisEngine::Board::MAX_X && replay.boardHeight == TetrisEngine::Board::MAX_Y)
+	{
+		replay.keyframes.resize(keyframeCount);
+		for (Keyframe& keyframe : replay.keyframes)
+		{
+			keyframe.snapshot.pieces = PieceGenerator{ replay.pieceKind, replay.seed };
+			if (!readKeyframe(bytes, position, keyframe) || keyframe.eventOffset > replay.events.size())
+			{
+				return false;
+			}
+		}
+	}
+
+	*this = replay;
+	return true;
+}
+
+// write the replay to a file
+// - param 1: the file path
+// - return: bool, true if the file was written
+bool Replay::save(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	const std::vector<std::uint8_t> bytes = serialize();
+	file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	return static_cast<bool>(file);
+}
+
+// read a replay from a file
+// - param 1: the file path
+// - return: bool, true if the file held a valid replay
+bool Replay::load(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	const std::vector<std::uint8_t> bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	return deserialize(bytes);
+}
+
+// pack an event: the input code & the tick delta
+//   deltas up to MAX_PACKED_TICKS share the input's byte, longer ones are
+//   escaped and follow as a varint (7 bits per byte, low bits first).
+// - param 1: the byte vector to append to
+// - param 2: the input code (a GameInput, or TICKS_ONLY)
+// - param 3: the ticks since the previous event
+// - return: nothing
+void Replay::packEvent(std::vector<std::uint8_t>& bytes, int inputCode, long long ticks)
+{
+	if (ticks <= MAX_PACKED_TICKS)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(inputCode | (ticks << INPUT_BITS)));
+		return;
+	}
+
+	bytes.push_back(static_cast<std::uint8_t>(inputCode | (ESCAPE_TICKS << INPUT_BITS)));
+	std::uint64_t value = static_cast<std::uint64_t>(ticks);
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+// unpack the event at a position of a byte vector
+// - param 1: the packed events
+// - param 2: the position of the event (advanced past it)
+// - param 3: set to the input code
+// - param 4: set to the ticks since the previous event
+// - return: bool, false if the event is truncated
+bool Replay::unpackEvent(const std::vector<std::uint8_t>& bytes, std::size_t& position, int& inputCode, long long& ticks)
+{
+	inputCode = bytes[position] & ((1 << INPUT_BITS) - 1);
+	ticks = bytes[position] >> INPUT_BITS;
+	position++;
+	if (ticks != ESCAPE_TICKS)
+	{
+		return true;
+	}
+
+	ticks = 0;
+	int shift{ 0 };
+	bool more{ true };
+	while (more)
+	{
+		if (position == bytes.size() || shift > 56)
+		{
+			return false;
+		}
+		ticks |= static_cast<long long>(bytes[position] & 0x7F) << shift;
+		more = (bytes[position] & 0x80) != 0;
+		shift += 7;
+		position++;
+	}
+	return true;
+}
+
+// play the events from a position of the stream until a piece count is reached
+// - param 1: the engine (already in the state the position starts from)
+// - param 2: the position of the first event to play
+// - param 3: the ticks of the first event's delta that were already played
+// - param 4: stop as soon as this many pieces have locked
+// - return: bool, false if the events are malformed
+bool Replay::playEvents(TetrisEngine& engine, std::size_t position, long long ticksConsumed, long long stopAtPieceCount) const
+{
+	while (position < events.size())
+	{
+		int inputCode;
+		long long ticks;
+		if (!unpackEvent(events, position, inputCode, ticks))
+		{
+			return false;
+		}
+
+		for (long long t{ ticksConsumed }; t < ticks; t++)
+		{
+			engine.tick();
+			if (engine.getPieceCount() >= stopAtPieceCount)
+			{
+				return true;
+			}
+		}
+		ticksConsumed = 0;
+		if (inputCode == TICKS_ONLY)
+		{
+			continue;
+		}
+		if (inputCode >= static_cast<int>(GameInput::COUNT))
+		{
+			return false;
+		}
+		engine.applyInput(static_cast<GameInput>(inputCode));
+		if (engine.getPieceCount() >= stopAtPieceCount)
+		{
+			return true;
+		}
+	}
+
+	// ticks recorded since the last event (a recording still in progress)
+	for (long long t{ ticksConsumed }; t < pendingTicks && engine.getPieceCount() < stopAtPieceCount; t++)
+	{
+		engine.tick();
+	}
+	return true;
+}
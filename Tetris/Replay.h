@@ -0,0 +1,173 @@
+// A Replay is a compact recording of one game that can be played back exactly.
+//
+// A game on TetrisEngine is a pure function of its piece sequence and of the order
+// its inputs and gravity ticks happen in, so that is all a replay stores:
+//   - the ruleset: the board dimensions and the piece generator (kind, seed & the
+//     index of the first piece dealt),
+//   - the event stream: each input, delta timestamped with the number of gravity
+//     ticks that fired since the previous event.
+// Each event is packed into a single byte (3 bits of input code, 5 bits of tick
+// delta); longer tick deltas spill into a variable length count.  A typical game
+// takes roughly one byte per input.
+//
+// Keyframes: every getKeyframeInterval() locked pieces the recording also keeps a
+// TetrisEngine::Snapshot with its position in the event stream.  seek() restores the
+// nearest keyframe at or before the requested piece and only simulates the gap, so a
+// long replay can be entered anywhere at a bounded cost.  A shorter interval seeks
+// faster, a longer one (or 0: no keyframes) makes smaller files.
+//
+// Recording: give the engine a Replay with TetrisEngine::setRecording(); every
+// reset() begins a new recording and every input & tick is added as it happens,
+// whoever drives the engine (the SFML front end, a policy, ...).
+// Playback: playBack() drives a headless engine with tick() & applyInput() directly,
+// so a replay plays as fast as the engine allows (no window, no clock).  Playing old
+// replays on a newer engine re-scores them with the current rules.
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "TetrisEngine.h"
+#include <cstdint>
+#include <climits>
+#include <string>
+#include <vector>
+
+class Replay
+{
+	friend class TestSuite;
+public:
+	// STATIC CONSTANTS
+	static const std::uint8_t VERSION;		// the file format version, init to 2
+	static const int INPUT_BITS;			// the bits of an event byte holding the input code, init to 3
+	static const int MAX_PACKED_TICKS;		// the largest tick delta packed into an event byte, init to 30
+	static const int TICKS_ONLY;			// the input code of an event that only carries ticks, init to 7
+	static const int DEFAULT_KEYFRAME_INTERVAL;	// the locked pieces between keyframes, init to 500
+
+	// a snapshot of the game & where it was taken in the event stream
+	struct Keyframe
+	{
+		std::size_t eventOffset{ 0 };	// the packed event the game continues with
+		long long ticksConsumed{ 0 };	// ticks of that event's delta already played
+		TetrisEngine::Snapshot snapshot;
+	};
+
+private:
+	// the ruleset ---------------------------------------------------
+	int boardWidth{ 0 };	// the board dimensions the game was played on
+	int boardHeight{ 0 };
+	PieceGenerator::Kind pieceKind{ PieceGenerator::Kind::RANDOM };
+	std::uint64_t seed{ 0 };
+	std::uint64_t firstPiece{ 0 };	// the generator index of the game's first piece
+
+	// the event stream ----------------------------------------------
+	std::vector<std::uint8_t> events;	// the packed events
+	long long inputCount{ 0 };			// the inputs recorded
+	long long tickCount{ 0 };			// the ticks recorded
+	long long pendingTicks{ 0 };		// ticks since the last packed event
+
+	// keyframes -----------------------------------------------------
+	int keyframeInterval{ DEFAULT_KEYFRAME_INTERVAL };	// locked pieces between keyframes (0: none)
+	std::vector<Keyframe> keyframes;	// in piece count order
+
+public:
+	// start a new recording (discarding any previous one, but keeping the keyframe interval)
+	// - param 1: the board width
+	// - param 2: the board height
+	// - param 3: the piece generator at the start of the game (before any piece is dealt)
+	// - return: nothing
+	void begin(int width, int height, const PieceGenerator& pieces);
+
+	// record a gravity tick
+	// - params: none
+	// - return: nothing
+	void recordTick() { pendingTicks++; tickCount++; }
+
+	// record an input (timestamped with the ticks since the previous event)
+	// - param 1: the GameInput
+	// - return: nothing
+	void recordInput(GameInput input);
+
+	// record that a piece locked (keeps a keyframe every keyframeInterval pieces)
+	// - param 1: the engine, just after the lock
+	// - return: nothing
+	void recordLock(const TetrisEngine& engine);
+
+	// set the number of locked pieces between keyframes (for recordings that begin later)
+	// - param 1: the interval (0: no keyframes)
+	// - return: nothing
+	void setKeyframeInterval(int pieces) { keyframeInterval = pieces < 0 ? 0 : pieces; }
+
+	// play the replay back on an engine, from a reset.
+	//   Drives the engine with tick() & applyInput() only (the engine's clock is
+	//   not used), so playback runs as fast as the engine allows.
+	// - param 1: the engine (its recording, if any, records the playback)
+	// - return: bool, false if the replay is for a different board or is malformed
+	bool playBack(TetrisEngine& engine) const;
+
+	// put an engine into the state the game was in when a given number of pieces had
+	// locked: restore the nearest keyframe at or before it, then play only the gap.
+	//   (seeking past the end of the game leaves the engine at the end of the game)
+	// - param 1: the engine (its recording isn't updated)
+	// - param 2: the locked piece count to seek to (0: the start of the game)
+	// - return: bool, false if the replay is for a different board or is malformed
+	bool seek(TetrisEngine& engine, long long pieceCount) const;
+
+	// the replay in its binary format
+	//   "TRPL", version, board width & height, piece kind, seed & first piece,
+	//   the keyframe interval, the packed events then the keyframes (little endian).
+	// - params: none
+	// - return: the bytes
+	std::vector<std::uint8_t> serialize() const;
+
+	// read a replay from its binary format
+	// - param 1: the bytes
+	// - return: bool, false (and the replay is unchanged) if the bytes aren't a valid replay
+	bool deserialize(const std::vector<std::uint8_t>& bytes);
+
+	// write the replay to a file
+	// - param 1: the file path
+	// - return: bool, true if the file was written
+	bool save(const std::string& path) const;
+
+	// read a replay from a file
+	// - param 1: the file path
+	// - return: bool, true if the file held a valid replay
+	bool load(const std::string& path);
+
+	// getters
+	int getBoardWidth() const { return boardWidth; }
+	int getBoardHeight() const { return boardHeight; }
+	PieceGenerator::Kind getPieceKind() const { return pieceKind; }
+	std::uint64_t getSeed() const { return seed; }
+	std::uint64_t getFirstPiece() const { return firstPiece; }
+	long long getInputCount() const { return inputCount; }
+	long long getTickCount() const { return tickCount; }
+	int getKeyframeInterval() const { return keyframeInterval; }
+	const std::vector<Keyframe>& getKeyframes() const { return keyframes; }
+
+private:
+	// pack an event: the input code & the tick delta
+	// - param 1: the byte vector to append to
+	// - param 2: the input code (a GameInput, or TICKS_ONLY)
+	// - param 3: the ticks since the previous event
+	// - return: nothing
+	static void packEvent(std::vector<std::uint8_t>& bytes, int inputCode, long long ticks);
+
+	// unpack the event at a position of a byte vector
+	// - param 1: the packed events
+	// - param 2: the position of the event (advanced past it)
+	// - param 3: set to the input code
+	// - param 4: set to the ticks since the previous event
+	// - return: bool, false if the event is truncated
+	static bool unpackEvent(const std::vector<std::uint8_t>& bytes, std::size_t& position, int& inputCode, long long& ticks);
+
+	// play the events from a position of the stream until a piece count is reached
+	// - param 1: the engine (already in the state the position starts from)
+	// - param 2: the position of the first event to play
+	// - param 3: the ticks of the first event's delta that were already played
+	// - param 4: stop as soon as this many pieces have locked
+	// - return: bool, false if the events are malformed
+	bool playEvents(TetrisEngine& engine, std::size_t position, long long ticksConsumed, long long stopAtPieceCount) const;
+};
+
+#endif /* REPLAY_H */
@@ -0,0 +1,125 @@
+// tetris_sim - plays many headless games as fast as possible and reports throughput.
+//
+// usage: tetris_sim [--games N] [--seed S] [--policy random|lowest|greedy|beam|parallel|expectimax] [--max-pieces M] [--threads T]
+//                  [--pieces random|bag|history] [--timed]
+//        tetris_sim --replay FILE [--replay FILE ...]
+//
+// The same arguments always play the same games (whatever the thread count), so the
+// numbers can be compared between engine changes.  --threads defaults to one thread
+// per hardware thread.  The lookahead policies (beam, parallel & expectimax) search
+// to their full depth; --timed gives each choice the policy's time budget instead,
+// as in the game - those runs depend on the machine's load and aren't reproducible.
+//
+// --replay plays recorded games back (headless, as fast as possible) and reports
+// their results under the current rules, eg: to re-score games after a scoring change.
+
+#include "Replay.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// play replays back and print each game's results
+// - param 1: the replay file paths
+// - return: the process exit code (1 if any replay couldn't be played)
+int playReplays(const std::vector<std::string>& paths)
+{
+	int exitCode{ 0 };
+	TetrisEngine engine;
+	for (const std::string& path : paths)
+	{
+		Replay replay;
+		if (!replay.load(path) || !replay.playBack(engine))
+		{
+			std::cerr << path << ": can't be read, or isn't a replay of this engine's board\n";
+			exitCode = 1;
+			continue;
+		}
+		std::cout << path << ": score " << engine.getScore() << ", lines " << engine.getTotalRemovedRows()
+			<< ", pieces " << engine.getPieceCount() << (engine.isGameOver() ? "" : " (unfinished)") << "\n";
+	}
+	return exitCode;
+}
+
+int main(int argc, char* argv[])
+{
+	SimulationOptions options;
+	std::vector<std::string> replayPaths;
+
+	for (int i{ 1 }; i < argc; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--games") == 0 && hasValue && std::atoll(argv[i + 1]) > 0)
+		{
+			options.games = std::atoll(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+		{
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--policy") == 0 && hasValue)
+		{
+			options.policy = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--max-pieces") == 0 && hasValue)
+		{
+			options.maxPiecesPerGame = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+		{
+			options.threads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--timed") == 0)
+		{
+			options.timed = true;
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && hasValue)
+		{
+			replayPaths.push_back(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--pieces") == 0 && hasValue && PieceGenerator::parseKind(argv[i + 1], options.pieceKind))
+		{
+			i++;
+		}
+		else
+		{
+			std::cerr << "usage: " << argv[0]
+				<< " [--games N] [--seed S] [--policy random|lowest|greedy|beam|parallel|expectimax] [--max-pieces M] [--threads T] [--pieces random|bag|history] [--timed]\n"
+				<< "       " << argv[0] << " --replay FILE [--replay FILE ...]\n";
+			return 1;
+		}
+	}
+
+	if (!replayPaths.empty())
+	{
+		return playReplays(replayPaths);
+	}
+
+	if (!isPolicyName(options.policy))
+	{
+		std::cerr << "unknown policy: " << options.policy << "\n";
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const SimulationStats stats = runSimulation(options);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const double perSecond = seconds > 0.0 ? 1.0 / seconds : 0.0;
+	std::cout << "policy:       " << options.policy << " (seed " << options.seed << ")\n";
+	std::cout << "generator:    " << PieceGenerator::getKindName(options.pieceKind) << "\n";
+	std::cout << "threads:      " << (options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency())) << "\n";
+	std::cout << "games:        " << stats.games << "\n";
+	std::cout << "pieces:       " << stats.pieces << "\n";
+	std::cout << "lines:        " << stats.lines << "\n";
+	std::cout << "mean score:   " << static_cast<double>(stats.score) / stats.games << "\n";
+	std::cout << "seconds:      " << seconds << "\n";
+	std::cout << "games/sec:    " << stats.games * perSecond << "\n";
+	std::cout << "pieces/sec:   " << stats.pieces * perSecond << "\n";
+	std::cout << "lines/sec:    " << stats.lines * perSecond << "\n";
+	return 0;
+}
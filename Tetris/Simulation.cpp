@@ -0,0 +1,114 @@
+#include "Simulation.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// add another set of totals to this one
+void SimulationStats::merge(const SimulationStats& other)
+{
+	games += other.games;
+	pieces += other.pieces;
+	lines += other.lines;
+	score += other.score;
+}
+
+// play one game (from the engine's current state) until it is over
+// or maxPieces shapes have been locked
+// - param 1: the engine to play on
+// - param 2: the policy choosing every placement
+// - param 3: int maxPieces
+// - return: the game's totals
+SimulationStats playGame(TetrisEngine& engine, PlacementPolicy& policy, int maxPieces)
+{
+	while (!engine.isGameOver() && engine.getPieceCount() < maxPieces)
+	{
+		PlacementPolicy::applyPlacement(engine, policy.choosePlacement(engine));
+	}
+
+	SimulationStats stats;
+	stats.games = 1;
+	stats.pieces = engine.getPieceCount();
+	stats.lines = engine.getTotalRemovedRows();
+	stats.score = engine.getScore();
+	return stats;
+}
+
+// the seeds game number 'gameIndex' of a run is played with
+//   (derived from the run seed & game index only)
+// - param 1: the run seed
+// - param 2: the game index
+// - param 3: set to the engine's seed
+// - param 4: set to the policy's seed
+// - return: nothing
+void getGameSeeds(std::uint64_t runSeed, long long gameIndex, std::uint64_t& engineSeed, std::uint64_t& policySeed)
+{
+	Random game{ Random::streamSeed(runSeed, static_cast<std::uint64_t>(gameIndex)) };
+	engineSeed = game.next();
+	policySeed = game.next();
+}
+
+// play every game of a simulation, spread over options.threads worker threads
+//   Workers claim the next unplayed game index from a shared counter (so a thread
+//   that draws short games simply plays more of them), keep their own totals and
+//   only touch shared state again when their totals are merged at the end.
+//   Each worker's policy searches on that worker's thread alone (the games
+//   already use the cores) and, unless options.timed, with no time budget so
+//   the games only depend on the seed.
+// - param 1: the SimulationOptions
+// - return: the totals over all games (games == 0 if the policy name is unknown)
+SimulationStats runSimulation(const SimulationOptions& options)
+{
+	SimulationStats totals;
+	if (!isPolicyName(options.policy))
+	{
+		return totals;
+	}
+
+	int threadCount = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+	if (threadCount > options.games)
+	{
+		threadCount = static_cast<int>(options.games > 0 ? options.games : 1);
+	}
+
+	std::atomic<long long> nextGame{ 0 };
+	std::vector<SimulationStats> threadTotals(threadCount);
+
+	auto worker = [&options, &nextGame](SimulationStats& workerTotals)
+	{
+		PolicyOptions policyOptions;
+		policyOptions.searchThreads = 1;
+		policyOptions.timed = options.timed;
+		std::unique_ptr<PlacementPolicy> policy = createPolicy(options.policy, 0, policyOptions);
+		TetrisEngine engine{ 0, options.pieceKind };
+		for (long long game = nextGame++; game < options.games; game = nextGame++)
+		{
+			std::uint64_t engineSeed, policySeed;
+			getGameSeeds(options.seed, game, engineSeed, policySeed);
+			engine.reset(engineSeed);
+			policy->reset(policySeed);
+			workerTotals.merge(playGame(engine, *policy, options.maxPiecesPerGame));
+		}
+	};
+
+	// the calling thread is worker 0
+	std::vector<std::thread> threads;
+	for (int t{ 1 }; t < threadCount; t++)
+	{
+		threads.emplace_back(worker, std::ref(threadTotals[t]));
+	}
+	worker(threadTotals[0]);
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (const SimulationStats& workerTotals : threadTotals)
+	{
+		totals.merge(workerTotals);
+	}
+	return totals;
+}
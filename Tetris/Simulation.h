@@ -0,0 +1,64 @@
+// Headless simulation of many tetris games.
+// A simulation plays games on TetrisEngine with a PlacementPolicy, as fast as the
+// engine allows: there is no window, no frame limiter and no gravity - each shape is
+// placed by the policy as soon as it spawns.  The statistics it gathers are what the
+// tetris_sim binary reports (and what we track as the engine's throughput baseline).
+//
+// Games are spread over worker threads, each with its own engine & policy.  Every
+// game is seeded from (run seed, game index) alone, so a run's totals are the same
+// whatever the number of threads and whichever thread happened to play each game.
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "PlacementPolicy.h"
+#include <string>
+
+// totals gathered over one or more games
+struct SimulationStats
+{
+	long long games{ 0 };	// games played
+	long long pieces{ 0 };	// shapes locked
+	long long lines{ 0 };	// rows removed
+	long long score{ 0 };	// sum of the final scores
+
+	// add another set of totals to this one
+	void merge(const SimulationStats& other);
+};
+
+// how a simulation should be run
+struct SimulationOptions
+{
+	long long games{ 1000 };		// the number of games to play
+	std::uint64_t seed{ 1 };		// the seed for the whole run (same seed, same games)
+	std::string policy{ "lowest" };	// the name of the PlacementPolicy to play with
+	int maxPiecesPerGame{ 10000 };	// games still running after this many pieces are stopped
+	int threads{ 0 };				// worker threads (0: one per hardware thread)
+	PieceGenerator::Kind pieceKind{ PieceGenerator::Kind::RANDOM };	// the shape sequence games are dealt
+	bool timed{ false };			// true: the lookahead policies stop at their time budgets (the games
+									// then depend on the machine's load, not only on the seed)
+};
+
+// play one game (from the engine's current state) until it is over
+// or maxPieces shapes have been locked
+// - param 1: the engine to play on
+// - param 2: the policy choosing every placement
+// - param 3: int maxPieces
+// - return: the game's totals
+SimulationStats playGame(TetrisEngine& engine, PlacementPolicy& policy, int maxPieces);
+
+// the seeds game number 'gameIndex' of a run is played with
+//   (derived from the run seed & game index only)
+// - param 1: the run seed
+// - param 2: the game index
+// - param 3: set to the engine's seed
+// - param 4: set to the policy's seed
+// - return: nothing
+void getGameSeeds(std::uint64_t runSeed, long long gameIndex, std::uint64_t& engineSeed, std::uint64_t& policySeed);
+
+// play every game of a simulation, spread over options.threads worker threads
+// - param 1: the SimulationOptions
+// - return: the totals over all games (games == 0 if the policy name is unknown)
+SimulationStats runSimulation(const SimulationOptions& options);
+
+#endif /* SIMULATION_H */
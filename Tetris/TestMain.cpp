@@ -0,0 +1,86 @@
+// tetris_tests - runs the TestSuite without creating a window.
+// (the game itself runs the same suite at startup from main.cpp)
+//
+// The global operator new (the plain, array & nothrow forms, and their deletes)
+// is replaced with one that counts its calls, so the suite can check that the
+// engine's game tick doesn't allocate.
+
+#include "TestSuite.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::uint64_t> allocationCount{ 0 };
+
+	// the number of operator new calls so far
+	// - return: the count
+	std::uint64_t getAllocationCount()
+	{
+		return allocationCount.load();
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	allocationCount++;
+	if (void* memory = std::malloc(size > 0 ? size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	allocationCount++;
+	return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& nothrow) noexcept
+{
+	return operator new(size, nothrow);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
+
+int main()
+{
+	TestSuite::runTestSuite(getAllocationCount);
+	return 0;
+}
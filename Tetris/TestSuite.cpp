@@ -10,20 +10,106 @@
 
 #ifdef GAMEBOARD
 #include "Gameboard.h"
+#include "Zobrist.h"
 #endif
 
 #ifdef GRIDTETROMINO
 #include "GridTetromino.h"
 #endif
 
+#ifdef PIECEGENERATOR
+#include "PieceGenerator.h"
+#endif
+
+#ifdef TETRISENGINE
+#include "TetrisEngine.h"
+#endif
+
+#ifdef MOVEGENERATOR
+#include "MoveGenerator.h"
+#include "Perft.h"
+#include <set>
+#include <vector>
+#endif
+
+#ifdef EVALUATOR
+#include "Evaluator.h"
+#include "PlacementPolicy.h"
+#include "Random.h"
+#include "Simulation.h"
+#include <cstdlib>
+#endif
+
+#ifdef BEAMSEARCH
+#include "BeamSearch.h"
+#include "PlacementPolicy.h"
+#include "Simulation.h"
+#include "Zobrist.h"
+#endif
+
+#ifdef PARALLELSEARCH
+#include "BeamSearch.h"
+#include "ParallelSearch.h"
+#include "PlacementPolicy.h"
+#include "Simulation.h"
+#include "TranspositionTable.h"
+#endif
+
+#ifdef EXPECTIMAXSEARCH
+#include "ExpectimaxSearch.h"
+#include "ParallelSearch.h"
+#include "PlacementPolicy.h"
+#include "Simulation.h"
+#include <cmath>
+#endif
+
+#ifdef REPLAY
+#include "PlacementPolicy.h"
+#include "Replay.h"
+#include <cstdio>
+#endif
+
+#ifdef SIMULATION
+#include "Simulation.h"
+#endif
+
+#ifdef TUNER
+#include "Tuner.h"
+#include <cmath>
+#include <cstdio>
+#endif
+
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <iostream>
 #include <string>
 
+#if defined(PARALLELSEARCH) || defined(EXPECTIMAXSEARCH)
+// the board the lookahead searches are tested on: the bottom row full but for
+// column 3, with a ledge over the 4 right columns in the row above it
+// - return: the board
+static TetrisEngine::Board getLedgeBoard()
+{
+	typedef TetrisEngine::Board Board;
+	Board board;
+	for (int x = 0; x < Board::MAX_X; x++) {
+		if (x != 3) {
+			board.setContent(x, Board::MAX_Y - 1, 1);
+		}
+		if (x > 5) {
+			board.setContent(x, Board::MAX_Y - 2, 1);
+		}
+	}
+	return board;
+}
+#endif
 
+std::uint64_t (*TestSuite::getAllocationCount)() = nullptr;
 
-void TestSuite::runTestSuite()
+void TestSuite::runTestSuite(std::uint64_t (*allocationCounter)())
 {
+	getAllocationCount = allocationCounter;
 	std::cout << "=== Running TestSuite =========================" << "\n";
 	// run some sanity tests on our classes to ensure they're working as expected.
 	//std::cout << "uncomment the #define statements in TestSuite.h when ready to test.\n\n";
@@ -31,6 +117,16 @@ void TestSuite::runTestSuite()
 	testTetrominoClass();
 	testGameboardClass();
 	testGridTetrominoClass();
+	testPieceGeneratorClass();
+	testTetrisEngineClass();
+	testMoveGeneratorClass();
+	testEvaluatorClass();
+	testBeamSearchClass();
+	testParallelSearchClass();
+	testExpectimaxSearchClass();
+	testReplayClass();
+	testSimulation();
+	testTuner();
 	std::cout << "=== TestSuite complete ========================" << "\n\n";
 }
 
@@ -167,36 +263,70 @@ void TestSuite::testTetrominoClass()
 
 	int blockcount = BLOCK_COUNT;
 
-	assert(t.blockLocs.size() == blockcount &&
+	assert(t.getBlockLocs().size() == static_cast<std::size_t>(blockcount) &&
 		"default Tetromino has no blockLocs - likely because no default set in constructor");
 
-	t.setShape(TetShape::S);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be: 4");
-	t.setShape(TetShape::Z);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
-	t.setShape(TetShape::L);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
-	t.setShape(TetShape::J);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
-	t.setShape(TetShape::O);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
-	t.setShape(TetShape::I);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
-	t.setShape(TetShape::T);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
-
+	// every shape and rotation state should hold 4 distinct blocks
+	for (int shape = 0; shape < static_cast<int>(TetShape::COUNT); shape++)
+	{
+		t.setShape(static_cast<TetShape>(shape));
+		assert(t.getRotation() == 0 && "Tetromino::setShape() should reset the rotation");
+		assert(t.getColor() == static_cast<TetColor>(shape) && "Tetromino color should follow the shape");
+		for (int r = 0; r < Tetromino::ROTATION_COUNT; r++)
+		{
+			const RotationState& state = Tetromino::getRotationState(static_cast<TetShape>(shape), r);
+			int maskBlocks = 0;
+			for (int row = 0; row < state.height; row++)
+			{
+				for (int col = 0; col < state.width; col++)
+				{
+					if (state.rowMasks[row] & (1u << col)) maskBlocks++;
+				}
+			}
+			assert(maskBlocks == blockcount && "Tetromino row masks should hold 4 blocks");
+			for (int b = 0; b < blockcount; b++)
+			{
+				const Point& p = state.blocks[b];
+				assert((state.rowMasks[p.getY() - state.minY] & (1u << (p.getX() - state.minX))) &&
+					"Tetromino row masks don't match the block locs");
+			}
+		}
+	}
 
-	// test the rotate functionality of a single block
-	t.blockLocs.clear();
-	t.blockLocs.push_back(Point(1, 2));
-	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == 2 && t.blockLocs[0].getY() == -1 && "Tetromino::rotateClockwise() failed");
-	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == -1 && t.blockLocs[0].getY() == -2 && "Tetromino::rotateClockwise() failed");
+	// test the rotate functionality: each rotation state is the previous one
+	// rotated 90 degrees clockwise around [0,0] (eg: [1,2] becomes [2,-1])
+	t.setShape(TetShape::T);
+	for (int r = 0; r < Tetromino::ROTATION_COUNT; r++)
+	{
+		std::array<Point, Tetromino::BLOCK_COUNT> before = t.getBlockLocs();
+		t.rotateClockwise();
+		assert(t.getRotation() == (r + 1) % Tetromino::ROTATION_COUNT && "Tetromino::rotateClockwise() failed");
+		for (int b = 0; b < blockcount; b++)
+		{
+			assert(t.getBlockLocs()[b].getX() == before[b].getY() && t.getBlockLocs()[b].getY() == -before[b].getX() &&
+				"Tetromino::rotateClockwise() failed");
+		}
+	}
+	t.setShape(TetShape::L);
 	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == -2 && t.blockLocs[0].getY() == 1 && "Tetromino::rotateClockwise() failed");
+	assert(t.getBlockLocs()[0].getX() == 1 && t.getBlockLocs()[0].getY() == 0 && "Tetromino::rotateClockwise() failed");
+	t.setRotation(-1);
+	assert(t.getRotation() == 3 && "Tetromino::setRotation() should wrap negative rotations");
+
+	// the O shape doesn't rotate
+	t.setShape(TetShape::O);
 	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == 1 && t.blockLocs[0].getY() == 2 && "Tetromino::rotateClockwise() failed");
+	for (int b = 0; b < blockcount; b++)
+	{
+		assert(t.getBlockLocs()[b].getX() == Tetromino::getRotationState(TetShape::O, 0).blocks[b].getX() &&
+			t.getBlockLocs()[b].getY() == Tetromino::getRotationState(TetShape::O, 0).blocks[b].getY() &&
+			"Tetromino::rotateClockwise() the O shape should not rotate");
+	}
+
+	// the table is built at compile time
+	static_assert(TetrominoTables::ROTATIONS[static_cast<int>(TetShape::I)][1].width == 4 &&
+		TetrominoTables::ROTATIONS[static_cast<int>(TetShape::I)][1].rowMasks[0] == 0xF,
+		"a rotated I should be one row of 4 blocks");
 
 	// ensure const methods are actually const
 	// These lines will cause compile time errors you have methods in your Tetromino class that
@@ -217,12 +347,13 @@ void TestSuite::testTetrominoClass()
 }
 
 #ifdef GAMEBOARD
-bool isGameboardEmpty(Gameboard& g)
+template<int WIDTH, int HEIGHT>
+bool isGameboardEmpty(Gameboard<WIDTH, HEIGHT>& g)
 {
-	for (int x = 0; x < Gameboard::MAX_X; x++) {
-		for (int y = 0; y < Gameboard::MAX_Y; y++)
+	for (int x = 0; x < WIDTH; x++) {
+		for (int y = 0; y < HEIGHT; y++)
 		{
-			if (g.getContent(x, y) != Gameboard::EMPTY_BLOCK) { return false; }
+			if (g.getContent(x, y) != g.EMPTY_BLOCK) { return false; }
 		}
 	}
 	return true;
@@ -234,36 +365,54 @@ void TestSuite::testGameboardClass()
 {
 #ifdef GAMEBOARD
 	announceTest("Gameboard");
-	Gameboard g;
+	typedef Gameboard<> Board;	// the classic 10x19 board
+	Board g;
 	// test if grid content is initialized to empty blocks
-	for (int x = 0; x < Gameboard::MAX_X; x++) {
-		for (int y = 0; y < Gameboard::MAX_Y; y++) {
-			assert(g.getContent(x, y) == Gameboard::EMPTY_BLOCK && "Gameboard was not initialized with empty blocks");
+	for (int x = 0; x < Board::MAX_X; x++) {
+		for (int y = 0; y < Board::MAX_Y; y++) {
+			assert(g.getContent(x, y) == Board::EMPTY_BLOCK && "Gameboard was not initialized with empty blocks");
 		}
 	}
+	assert(g.getSpawnLoc().getX() == Board::MAX_X / 2 && g.getSpawnLoc().getY() == 0 &&
+		"Gameboard::getSpawnLoc() should be the top middle of the board");
 
 	// test setGridContent()
 	g.setContent(0, 0, 1);
 	assert(g.getContent(0, 0) == 1 && "Gameboard.setContent() - unexpected result");	// was grid content set?
-	g.setContent(Gameboard::MAX_X - 1, Gameboard::MAX_Y - 1, 2);
-	assert(g.getContent(Gameboard::MAX_X - 1, Gameboard::MAX_Y - 1) == 2 &&
+	g.setContent(Board::MAX_X - 1, Board::MAX_Y - 1, 2);
+	assert(g.getContent(Board::MAX_X - 1, Board::MAX_Y - 1) == 2 &&
 		"Gameboard.setContent() - unexpected result"); // was grid content set?
-	g.setContent(Gameboard::MAX_X - 1, Gameboard::MAX_Y - 1, Gameboard::EMPTY_BLOCK);
-	assert(g.getContent(Gameboard::MAX_X - 1, Gameboard::MAX_Y - 1) == Gameboard::EMPTY_BLOCK &&
+	g.setContent(Board::MAX_X - 1, Board::MAX_Y - 1, Board::EMPTY_BLOCK);
+	assert(g.getContent(Board::MAX_X - 1, Board::MAX_Y - 1) == Board::EMPTY_BLOCK &&
 		"Gameboard.setContent() - unexpected result"); // was grid content set?
 
 
+	// test the occupancy bitboard stays in sync with the content
+	g.empty();
+	g.setContent(3, 5, 1);
+	assert(g.rows[5] == Board::cellMask(3) && "Gameboard.setContent() did not set the occupancy bit");
+	g.setContent(3, 5, 0);
+	assert(g.rows[5] == Board::cellMask(3) && "Gameboard.setContent() - content 0 is a color, not empty");
+	g.setContent(3, 5, Board::EMPTY_BLOCK);
+	assert(g.rows[5] == 0 && "Gameboard.setContent() did not clear the occupancy bit");
+	g.fillRow(6, 4);
+	assert(g.rows[6] == Board::FULL_ROW && "Gameboard.fillRow() did not fill the occupancy row");
+	g.copyRowIntoRow(6, 7);
+	assert(g.rows[7] == Board::FULL_ROW && g.getContent(0, 7) == 4 &&
+		"Gameboard.copyRowIntoRow() did not copy both occupancy and color");
+	g.empty();
+
 	// test fillRow() & isRowCompleted()
 	g.fillRow(0, 1);
 	assert(g.getContent(0, 0) == 1 &&
 		"Gameboard.fillRow() - row should be filled with 1, but first element is not 1");	// is the first spot in the row what we expect?
-	assert(g.getContent(Gameboard::MAX_X - 1, 0) == 1 &&
+	assert(g.getContent(Board::MAX_X - 1, 0) == 1 &&
 		"Gameboard.fillRow() - row should be filled, but last element is still 1");  // is the last spot in the row what we expect?
 	assert(g.isRowCompleted(0) == true &&
 		"Gameboard.fillRow() - row should be filled, but does not appear to be completed");	// was row 0 completed?
 
 	// test isRowCompleted()
-	g.setContent(0, 0, Gameboard::EMPTY_BLOCK);
+	g.setContent(0, 0, Board::EMPTY_BLOCK);
 	assert(g.isRowCompleted(0) == false &&
 		"Gameboard.isRowCompleted() clearing a single entry should make row incomplete");	// did a single incomplete entry make the row incomplete?
 
@@ -271,7 +420,7 @@ void TestSuite::testGameboardClass()
 	g.fillRow(0, 1);
 	assert(g.isRowCompleted(0) == true &&
 		"Gameboard.fillRow() - row should be filled with 1, but does not appear to be completed");	// ensure row filled
-	g.fillRow(0, Gameboard::EMPTY_BLOCK);
+	g.fillRow(0, Board::EMPTY_BLOCK);
 	assert(g.isRowCompleted(0) == false &&
 		"Gameboard.fillRow() - row should be empty, but appears to be completed");	// did row 0 get cleared
 
@@ -284,7 +433,7 @@ void TestSuite::testGameboardClass()
 	assert(isGameboardEmpty(g) == true && "Gameboard.isGameboardEmpty() returned false when true expected");
 
 	// test empty()
-	for (int y = 0; y < Gameboard::MAX_Y; y++) {	// fill the whole board
+	for (int y = 0; y < Board::MAX_Y; y++) {	// fill the whole board
 		g.fillRow(y, 1);
 	}
 	g.empty();	// empty the board
@@ -294,12 +443,12 @@ void TestSuite::testGameboardClass()
 	// test copyRowIntoRow()
 	g.empty();
 	assert(g.isRowCompleted(1) == false);
-	for (int x = 0; x < Gameboard::MAX_X; x++) {  // fill row 0 with 0, 1, 2, 3,...
+	for (int x = 0; x < Board::MAX_X; x++) {  // fill row 0 with 0, 1, 2, 3,...
 		g.setContent(x, 1, x);
 	}
 	g.copyRowIntoRow(1, 3);					// copy row 0 into row 1
 	assert(g.isRowCompleted(3) == true);	// row 3 should now be completed
-	for (int x = 0; x < Gameboard::MAX_X; x++) {
+	for (int x = 0; x < Board::MAX_X; x++) {
 		assert(g.getContent(x, 1) == g.getContent(x, 3) &&
 			"Gameboard.copyRowIntoRow(), rows expected to match but do not"); // compare row 1 with row 3, does it match?
 	}
@@ -309,7 +458,7 @@ void TestSuite::testGameboardClass()
 	g.fillRow(1, 1);
 	g.fillRow(2, 2);
 	g.removeRow(2);
-	assert(g.getContent(0, 0) == Gameboard::EMPTY_BLOCK && "Gameboard.removeRow() expected row to be empty, but it is not");
+	assert(g.getContent(0, 0) == Board::EMPTY_BLOCK && "Gameboard.removeRow() expected row to be empty, but it is not");
 	assert(g.getContent(0, 1) == 0 && "Gameboard.removeRow() expected row to be empty, but it is not");
 	assert(g.getContent(0, 2) == 1 && "Gameboard.removeRow() expected row to be empty, but it is not");
 
@@ -322,12 +471,26 @@ void TestSuite::testGameboardClass()
 	g.fillRow(4, 4);
 	std::vector<int> rowsToRemove = { 1, 3 };
 	g.removeRows(rowsToRemove);
-	assert(g.getContent(0, 0) == Gameboard::EMPTY_BLOCK && "Gameboard.removeRows() seems to have failed");
-	assert(g.getContent(0, 1) == Gameboard::EMPTY_BLOCK && "Gameboard.removeRows() seems to have failed");
+	assert(g.getContent(0, 0) == Board::EMPTY_BLOCK && "Gameboard.removeRows() seems to have failed");
+	assert(g.getContent(0, 1) == Board::EMPTY_BLOCK && "Gameboard.removeRows() seems to have failed");
 	assert(g.getContent(0, 2) == 0 && "Gameboard.removeRows() seems to have failed");
 	assert(g.getContent(0, 3) == 2 && "Gameboard.removeRows() seems to have failed");
 	assert(g.getContent(0, 4) == 4 && "Gameboard.removeRows() seems to have failed");
 
+	// test removeRows() removes every row in one pass, regardless of index order
+	g.empty();
+	for (int y = Board::MAX_Y - 6; y < Board::MAX_Y; y++) {
+		g.fillRow(y, y % 10);
+	}
+	rowsToRemove = { Board::MAX_Y - 1, Board::MAX_Y - 3, Board::MAX_Y - 4 };
+	g.removeRows(rowsToRemove);
+	assert(g.getContent(0, Board::MAX_Y - 1) == (Board::MAX_Y - 2) % 10 &&
+		g.getContent(0, Board::MAX_Y - 2) == (Board::MAX_Y - 5) % 10 &&
+		g.getContent(0, Board::MAX_Y - 3) == (Board::MAX_Y - 6) % 10 &&
+		"Gameboard.removeRows() surviving rows did not land in their final positions");
+	assert(g.getHighestOccupiedRow() == Board::MAX_Y - 3 &&
+		"Gameboard.removeRows() vacated rows should be empty");
+
 	// test getCompletedRowIndices()
 	g.empty();
 	assert(g.getCompletedRowIndices().size() == 0 &&
@@ -353,16 +516,16 @@ void TestSuite::testGameboardClass()
 	g.fillRow(1, 1);
 	g.fillRow(2, 2);
 	g.fillRow(3, 3);
-	g.setContent(0, 0, Gameboard::EMPTY_BLOCK);
-	g.setContent(0, 1, Gameboard::EMPTY_BLOCK);
-	g.setContent(0, 2, Gameboard::EMPTY_BLOCK);
+	g.setContent(0, 0, Board::EMPTY_BLOCK);
+	g.setContent(0, 1, Board::EMPTY_BLOCK);
+	g.setContent(0, 2, Board::EMPTY_BLOCK);
 	// at this point row 3 is the only complete row
 	g.removeCompletedRows();
-	assert(g.getContent(1, 0) == Gameboard::EMPTY_BLOCK && "Gameboard.removeCompletedRows() first row should be empty");
+	assert(g.getContent(1, 0) == Board::EMPTY_BLOCK && "Gameboard.removeCompletedRows() first row should be empty");
 	assert(g.getContent(1, 1) == 0 && "Gameboard.removeCompletedRows() unexpected results");	// row 0 copied into row 1
 	assert(g.getContent(1, 2) == 1 && "Gameboard.removeCompletedRows() unexpected results");	// row 1 copied into row 2
 	assert(g.getContent(1, 3) == 2 && "Gameboard.removeCompletedRows() unexpected results");	// row 2 copied into row 3
-	assert(g.getContent(1, 4) == Gameboard::EMPTY_BLOCK && "Gameboard.removeCompletedRows() unexpected results");	// row 4 is still empty
+	assert(g.getContent(1, 4) == Board::EMPTY_BLOCK && "Gameboard.removeCompletedRows() unexpected results");	// row 4 is still empty
 
 
 	// test areLocsEmpty()
@@ -395,7 +558,7 @@ void TestSuite::testGameboardClass()
 	g.printToConsole();
 	std::cout << "\n";
 	// print out the board with filled in rows)
-	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	for (int y = 0; y < Board::MAX_Y; y++)
 	{
 		g.fillRow(y, y % 10);
 	}
@@ -410,7 +573,7 @@ void TestSuite::testGameboardClass()
 	// should be labelled as const (because the methods don't change the internal member
 	// variables of yoru class).
 	// (see LearnCpp 13.2- const class objects and member functions)
-	const Gameboard g2;
+	const Board g2;
 	g2.getContent(0, 0);
 	g2.getContent(Point(1, 1));
 	std::vector<Point> pts = { Point(2,2) };
@@ -424,7 +587,7 @@ void TestSuite::testGameboardClass()
 
 	// These methods should ignore invalid points
 	// undefined behaviour would result if they didn't.
-	Gameboard g3;
+	Board g3;
 	std::cout << "Testing gameboard.setContent() methods()...";
 	g3.setContent(-1, -1, 1);
 	g3.setContent(25, 25, 1);
@@ -433,6 +596,215 @@ void TestSuite::testGameboardClass()
 	std::vector<Point> invalidPoints2{ Point(-5,-5), Point(50,50) };
 	g3.setContent(invalidPoints2, 1);
 
+	// test isMaskPlaceable() - a tiny L shaped pattern:  x.
+	//                                                   xx
+	const std::uint16_t pattern[2] = { 0x1, 0x3 };
+	g.empty();
+	assert(g.isMaskPlaceable(pattern, 2, 2, 0, 0) == true && "Gameboard.isMaskPlaceable() expected true on an empty board");
+	assert(g.isMaskPlaceable(pattern, 2, 2, 0, -1) == true && "Gameboard.isMaskPlaceable() rows above the board never collide");
+	assert(g.isMaskPlaceable(pattern, 2, 2, -1, 0) == false && "Gameboard.isMaskPlaceable() left border");
+	assert(g.isMaskPlaceable(pattern, 2, 2, Board::MAX_X - 1, 0) == false && "Gameboard.isMaskPlaceable() right border");
+	assert(g.isMaskPlaceable(pattern, 2, 2, 0, Board::MAX_Y - 1) == false && "Gameboard.isMaskPlaceable() bottom border");
+	g.setContent(1, 4, 1);
+	assert(g.isMaskPlaceable(pattern, 2, 2, 0, 3) == false && "Gameboard.isMaskPlaceable() expected a collision");
+	assert(g.isMaskPlaceable(pattern, 2, 2, 1, 2) == true && "Gameboard.isMaskPlaceable() (1,3) is empty");
+	assert(g.isMaskPlaceable(pattern, 2, 2, 1, 3) == false && "Gameboard.isMaskPlaceable() expected a collision");
+
+	// dirty tracking: getChangedRowsSince() reports exactly the rows written since a generation
+	g.empty();
+	std::uint64_t seen = g.getGeneration();
+	assert(g.getChangedRowsSince(seen) == 0 && "Gameboard.getChangedRowsSince() nothing changed yet");
+	g.setContent(3, 5, 1);
+	g.setContent(4, 7, 1);
+	assert(g.getChangedRowsSince(seen) == ((Board::RowSet{ 1 } << 5) | (Board::RowSet{ 1 } << 7)) &&
+		"Gameboard.getChangedRowsSince() should report the rows written");
+	assert(g.getGeneration() > seen && "Gameboard.getGeneration() should advance on writes");
+	seen = g.getGeneration();
+	g.getContent(3, 5);
+	g.isMaskPlaceable(pattern, 2, 2, 0, 0);
+	assert(g.getChangedRowsSince(seen) == 0 && "Gameboard.getChangedRowsSince() reads shouldn't mark rows");
+	g.fillRow(Board::MAX_Y - 1, 1);
+	seen = g.getGeneration();
+	assert(g.removeCompletedRows() == 1 && "Gameboard.removeCompletedRows() expected 1 row");
+	Board::RowSet shifted{ 0 };
+	for (int y = 5; y <= Board::MAX_Y - 1; y++) {
+		shifted |= Board::RowSet{ 1 } << y;
+	}
+	assert((g.getChangedRowsSince(seen) & shifted) == shifted &&
+		"Gameboard.getChangedRowsSince() every shifted row should be reported");
+	assert((g.getChangedRowsSince(seen) & 0xF) == 0 &&
+		"Gameboard.getChangedRowsSince() rows above the stack are untouched by a row removal");
+
+	// column heights follow every write (setContent, fillRow & row removal)
+	auto columnHeightsMatch = [](const Board& board) {
+		for (int x = 0; x < Board::MAX_X; x++) {
+			int y = 0;
+			while (y < Board::MAX_Y && board.getContent(x, y) == Board::EMPTY_BLOCK) y++;
+			if (board.getColumnHeight(x) != Board::MAX_Y - y) return false;
+		}
+		return true;
+	};
+	g.empty();
+	assert(g.getColumnHeight(0) == 0 && columnHeightsMatch(g) && "Gameboard.getColumnHeight() an empty board has no height");
+	g.setContent(2, Board::MAX_Y - 1, 1);
+	g.setContent(2, 10, 1);
+	assert(g.getColumnHeight(2) == Board::MAX_Y - 10 && "Gameboard.getColumnHeight() should be the highest cell");
+	g.setContent(2, 10, Board::EMPTY_BLOCK);
+	assert(g.getColumnHeight(2) == 1 && "Gameboard.getColumnHeight() emptying the top should find the next cell down");
+	for (int step = 0; step < 2000; step++) {
+		const int x = (step * 7) % Board::MAX_X;
+		const int y = Board::MAX_Y / 2 + (step * 13) % (Board::MAX_Y - Board::MAX_Y / 2);
+		if (step % 97 == 0) {
+			g.fillRow(y, step % 2 ? 1 : Board::EMPTY_BLOCK);
+		}
+		else {
+			g.setContent(x, y, (step * 5) % 3 ? 1 : Board::EMPTY_BLOCK);
+		}
+		g.removeCompletedRows();
+		assert(columnHeightsMatch(g) && "Gameboard.getColumnHeight() out of date");
+	}
+	Board copy;
+	copy.copyContentFrom(g);
+	assert(columnHeightsMatch(copy) && "Gameboard.copyContentFrom() should copy the column heights");
+
+	// Zobrist hashes follow every write, and match hashes computed from scratch
+	auto hashesMatch = [](const Board& board) {
+		std::uint64_t content{ 0 };
+		std::uint64_t occupancy{ 0 };
+		for (int y = 0; y < Board::MAX_Y; y++) {
+			for (int x = 0; x < Board::MAX_X; x++) {
+				if (board.getContent(x, y) != Board::EMPTY_BLOCK) {
+					content ^= Zobrist::contentKey(x, y, board.getContent(x, y));
+					occupancy ^= Zobrist::cellKey(x, y);
+				}
+			}
+		}
+		return board.getHash() == content && board.getOccupancyHash() == occupancy;
+	};
+	assert(copy.getHash() == g.getHash() && copy.getOccupancyHash() == g.getOccupancyHash() &&
+		"Gameboard.copyContentFrom() should copy the hashes");
+	g.empty();
+	assert(g.getHash() == 0 && g.getOccupancyHash() == 0 && "Gameboard.getHash() an empty board hashes to 0");
+	for (int step = 0; step < 2000; step++) {
+		const int x = (step * 7) % Board::MAX_X;
+		const int y = Board::MAX_Y / 2 + (step * 11) % (Board::MAX_Y - Board::MAX_Y / 2);
+		if (step % 89 == 0) {
+			g.fillRow(y, step % 2 ? 3 : Board::EMPTY_BLOCK);
+		}
+		else {
+			g.setContent(x, y, (step * 5) % 4 ? step % 7 : Board::EMPTY_BLOCK);
+		}
+		g.removeCompletedRows();
+		assert(hashesMatch(g) && "Gameboard.getHash() out of date");
+	}
+	Board recolored;
+	for (int y = 0; y < Board::MAX_Y; y++) {
+		for (int x = 0; x < Board::MAX_X; x++) {
+			if (g.getContent(x, y) != Board::EMPTY_BLOCK) {
+				recolored.setContent(x, y, g.getContent(x, y) + 1);
+			}
+		}
+	}
+	assert(recolored.getOccupancyHash() == g.getOccupancyHash() && recolored.getHash() != g.getHash() &&
+		"Gameboard.getOccupancyHash() should ignore the colors, getHash() shouldn't");
+	// a row removal hashes the same as the board built directly
+	g.empty();
+	recolored.empty();
+	g.setContent(0, Board::MAX_Y - 2, 4);
+	g.setContent(5, Board::MAX_Y - 3, 2);
+	g.fillRow(Board::MAX_Y - 1, 1);
+	g.removeCompletedRows();
+	recolored.setContent(0, Board::MAX_Y - 1, 4);
+	recolored.setContent(5, Board::MAX_Y - 2, 2);
+	assert(g.getHash() == recolored.getHash() && g.getOccupancyHash() == recolored.getOccupancyHash() &&
+		"Gameboard.removeCompletedRows() the hash should only depend on the content");
+
+	// place() & undo() restore the board exactly, line clears included
+	auto sameBoard = [](const Board& a, const Board& b) {
+		for (int y = 0; y < Board::MAX_Y; y++) {
+			for (int x = 0; x < Board::MAX_X; x++) {
+				if (a.getContent(x, y) != b.getContent(x, y)) return false;
+			}
+		}
+		for (int x = 0; x < Board::MAX_X; x++) {
+			if (a.getColumnHeight(x) != b.getColumnHeight(x)) return false;
+		}
+		return a.getHash() == b.getHash() && a.getOccupancyHash() == b.getOccupancyHash();
+	};
+	const Point horizontal[4] = { Point(0, 0), Point(1, 0), Point(2, 0), Point(3, 0) };
+	const Point vertical[4] = { Point(0, 0), Point(0, 1), Point(0, 2), Point(0, 3) };
+	g.empty();
+	for (int y = Board::MAX_Y - 6; y < Board::MAX_Y; y++) {
+		for (int x = 0; x < Board::MAX_X; x++) {
+			if (x != 9 && (x + y) % 5 != 0) {
+				g.setContent(x, y, x % 7);
+			}
+		}
+	}
+	for (int y = Board::MAX_Y - 4; y < Board::MAX_Y; y++) {
+		for (int x = 0; x < Board::MAX_X - 1; x++) {
+			g.setContent(x, y, 2);		// 4 rows only missing column 9
+		}
+	}
+	copy.copyContentFrom(g);
+	Board::UndoRecord tetris = g.place(vertical, 4, Point(9, Board::MAX_Y - 4), 5);
+	assert(tetris.removedRows == (Board::RowSet{ 0xF } << (Board::MAX_Y - 4)) && tetris.cellCount == 4 &&
+		"Gameboard.place() should remove the 4 rows completed");
+	assert(g.getContent(9, Board::MAX_Y - 1) == Board::EMPTY_BLOCK && g.getContent(2, Board::MAX_Y - 1) == 2 &&
+		"Gameboard.place() the rows above should move down");
+	Board::UndoRecord nested = g.place(horizontal, 4, Point(2, 2), 6);
+	assert(nested.removedRows == 0 && g.getContent(5, 2) == 6 && "Gameboard.place() expected 4 cells & no row removed");
+	g.undo(nested);
+	g.undo(tetris);
+	assert(sameBoard(g, copy) && "Gameboard.undo() should restore the board exactly");
+	Board::UndoRecord partial = g.place(vertical, 4, Point(9, -2), 3);
+	assert(partial.cellCount == 2 && "Gameboard.place() cells above the board are ignored");
+	g.undo(partial);
+	assert(sameBoard(g, copy) && "Gameboard.undo() should restore the board exactly");
+	for (int step = 0; step < 500; step++) {
+		const bool flat = step % 3 != 0;
+		const int x = (step * 7) % (Board::MAX_X - (flat ? 3 : 0));
+		int y = 0;
+		while (y + (flat ? 0 : 3) < Board::MAX_Y - 1 && g.getContent(x, y + (flat ? 1 : 4)) == Board::EMPTY_BLOCK &&
+			(!flat || (g.getContent(x + 1, y + 1) == Board::EMPTY_BLOCK && g.getContent(x + 2, y + 1) == Board::EMPTY_BLOCK &&
+				g.getContent(x + 3, y + 1) == Board::EMPTY_BLOCK))) {
+			y++;
+		}
+		copy.copyContentFrom(g);
+		const Board::UndoRecord record = g.place(flat ? horizontal : vertical, 4, Point(x, y), step % 7);
+		assert(hashesMatch(g) && "Gameboard.place() hashes out of date");
+		assert(columnHeightsMatch(g) && "Gameboard.place() column heights out of date");
+		if (step % 2) {
+			g.undo(record);
+			assert(sameBoard(g, copy) && "Gameboard.undo() should restore the board exactly");
+		}
+		if (g.getColumnHeight(x) > Board::MAX_Y - 5) {
+			g.empty();
+		}
+	}
+
+	// other board specializations
+	Gameboard<4, 4> tiny;
+	static_assert(Gameboard<4, 4>::FULL_ROW == 0xF, "4 wide board should have a 4 bit row mask");
+	tiny.fillRow(3, 1);
+	tiny.setContent(0, 2, 2);
+	assert(tiny.removeCompletedRows() == 1 && tiny.getContent(0, 3) == 2 && isGameboardEmpty(tiny) == false &&
+		"Gameboard<4, 4>.removeCompletedRows() unexpected results");
+
+	Gameboard<10, 40> tall;
+	tall.fillRow(39, 1);
+	tall.fillRow(0, 1);
+	assert(tall.removeCompletedRows() == 2 && isGameboardEmpty(tall) == true &&
+		"Gameboard<10, 40>.removeCompletedRows() unexpected results");
+
+	Gameboard<20, 10> wide;
+	static_assert(sizeof(Gameboard<20, 10>::Row) == 4, "20 wide board needs a 32 bit row");
+	wide.fillRow(9, 1);
+	wide.setContent(19, 9, Gameboard<20, 10>::EMPTY_BLOCK);
+	assert(wide.isRowCompleted(9) == false && "Gameboard<20, 10>.isRowCompleted() unexpected results");
+	wide.setContent(19, 9, 1);
+	assert(wide.isRowCompleted(9) == true && "Gameboard<20, 10>.isRowCompleted() unexpected results");
+
 
 	announceTestCompletion();
 #else
@@ -467,10 +839,43 @@ void TestSuite::testGameboardClass()
 
 
 	// test getBlockLocsMappedToGrid()
-	gt.blockLocs = { Point(1,2) };
+	gt.setShape(TetShape::L);
+	gt.rotateClockwise();	// first block is now [1,0]
 	gt.setGridLoc(5, 5);
-	std::vector<Point> locs = gt.getBlockLocsMappedToGrid();
-	assert(locs[0].getX() == 6 && locs[0].getY() == 7);
+	std::array<Point, Tetromino::BLOCK_COUNT> locs = gt.getBlockLocsMappedToGrid();
+	assert(locs[0].getX() == 6 && locs[0].getY() == 5);
+
+#ifdef GAMEBOARD
+	// the row masks in the rotation table should agree with the mapped block locs
+	// for every shape, rotation and position on a patterned board
+	Gameboard<> board;
+	for (int y = 8; y < Gameboard<>::MAX_Y; y++) {
+		for (int x = 0; x < Gameboard<>::MAX_X; x++) {
+			if ((x * 7 + y * 3) % 4 == 0) board.setContent(x, y, 1);
+		}
+	}
+	for (int shape = 0; shape < static_cast<int>(TetShape::COUNT); shape++) {
+		gt.setShape(static_cast<TetShape>(shape));
+		for (int r = 0; r < Tetromino::ROTATION_COUNT; r++, gt.rotateClockwise()) {
+			const RotationState& state = gt.getRotationState();
+			for (int y = -3; y < Gameboard<>::MAX_Y + 3; y++) {
+				for (int x = -3; x < Gameboard<>::MAX_X + 3; x++) {
+					gt.setGridLoc(x, y);
+					bool expected = true;
+					for (const Point& p : gt.getBlockLocsMappedToGrid()) {
+						if (p.getX() < 0 || p.getX() >= Gameboard<>::MAX_X || p.getY() >= Gameboard<>::MAX_Y ||
+							(p.getY() >= 0 && board.getContent(p) != Gameboard<>::EMPTY_BLOCK)) {
+							expected = false;
+						}
+					}
+					assert(board.isMaskPlaceable(state.rowMasks.data(), state.width, state.height,
+						x + state.minX, y + state.minY) == expected &&
+						"Gameboard.isMaskPlaceable() disagrees with the tetromino's mapped block locs");
+				}
+			}
+		}
+	}
+#endif
 
 	// A const gridTetromino should be able to call the following methods
 	// (since these methods don't change the state of the class)
@@ -489,7 +894,1114 @@ void TestSuite::testGameboardClass()
 #endif	
 }
 
+void TestSuite::testPieceGeneratorClass()
+{
+#ifdef PIECEGENERATOR
+	announceTest("PieceGenerator");
+	typedef PieceGenerator::Kind Kind;
+	const int SHAPES = PieceGenerator::SHAPE_COUNT;
+
+	for (int k = 0; k < static_cast<int>(Kind::COUNT); k++) {
+		const Kind kind = static_cast<Kind>(k);
+
+		// next() deals the same sequence as getPiece(), and the same seed deals the same sequence
+		PieceGenerator gen{ kind, 123 }, same{ kind, 123 };
+		std::array<TetShape, 200> dealt;
+		for (int i = 0; i < 200; i++) {
+			dealt[i] = gen.next();
+			assert(dealt[i] == same.next() && "PieceGenerator the same seed should deal the same sequence");
+			assert(static_cast<int>(dealt[i]) >= 0 && static_cast<int>(dealt[i]) < SHAPES && "PieceGenerator dealt an invalid shape");
+		}
+		assert(gen.getIndex() == 200 && "PieceGenerator::getIndex() should count the pieces dealt");
+		for (int i : { 0, 6, 7, 13, 50, 199 }) {
+			assert(gen.getPiece(i) == dealt[i] && "PieceGenerator::getPiece() doesn't match next()");
+		}
+
+		// seek() jumps forwards and backwards
+		gen.seek(57);
+		assert(gen.next() == dealt[57] && "PieceGenerator::seek() forward failed");
+		gen.seek(3);
+		assert(gen.next() == dealt[3] && gen.next() == dealt[4] && "PieceGenerator::seek() backward failed");
+
+		// reset() restarts the sequence
+		gen.reset(123);
+		assert(gen.getIndex() == 0 && gen.next() == dealt[0] && "PieceGenerator::reset() should restart the sequence");
+
+		// kind names round trip
+		Kind parsed = Kind::COUNT;
+		assert(PieceGenerator::parseKind(PieceGenerator::getKindName(kind), parsed) && parsed == kind &&
+			"PieceGenerator::parseKind() should accept getKindName()");
+	}
+	Kind parsed;
+	assert(!PieceGenerator::parseKind("no such kind", parsed) && "PieceGenerator::parseKind() should reject unknown names");
+
+	// every bag holds each shape once, even far into the sequence
+	PieceGenerator bag{ Kind::BAG, 9 };
+	for (std::uint64_t bagStart : { std::uint64_t{ 0 }, std::uint64_t{ 7 }, std::uint64_t{ 7000000000000ull } }) {
+		std::array<int, SHAPES> counts{};
+		for (int i = 0; i < SHAPES; i++) {
+			counts[static_cast<int>(bag.getPiece(bagStart + i))]++;
+		}
+		for (int count : counts) {
+			assert(count == 1 && "PieceGenerator BAG should deal each shape once per bag");
+		}
+	}
+
+	// HISTORY never repeats a shape twice in a row unless every roll hit the history
+	PieceGenerator history{ Kind::HISTORY, 5 };
+	int repeats = 0;
+	TetShape last = history.next();
+	for (int i = 0; i < 1000; i++) {
+		TetShape shape = history.next();
+		repeats += shape == last ? 1 : 0;
+		last = shape;
+	}
+	PieceGenerator uniform{ Kind::RANDOM, 5 };
+	int uniformRepeats = 0;
+	last = uniform.next();
+	for (int i = 0; i < 1000; i++) {
+		TetShape shape = uniform.next();
+		uniformRepeats += shape == last ? 1 : 0;
+		last = shape;
+	}
+	assert(repeats < uniformRepeats && "PieceGenerator HISTORY should repeat shapes less often than RANDOM");
 
+	// different seeds deal different sequences
+	PieceGenerator seedA{ Kind::RANDOM, 1 }, seedB{ Kind::RANDOM, 2 };
+	int differences = 0;
+	for (int i = 0; i < 50; i++) {
+		differences += seedA.next() != seedB.next() ? 1 : 0;
+	}
+	assert(differences > 0 && "PieceGenerator different seeds should deal different sequences");
 
+	announceTestCompletion();
+#else
+	announceNotTested("PieceGenerator");
+#endif	
+}
 
+void TestSuite::testTetrisEngineClass()
+{
+#ifdef TETRISENGINE
+	announceTest("TetrisEngine");
+	typedef TetrisEngine::Board Board;
+
+	// a new game
+	TetrisEngine e;
+	assert(e.getScore() == 0 && e.getPieceCount() == 0 && e.getTotalRemovedRows() == 0 && e.isGameOver() == false &&
+		"TetrisEngine ctor - game not reset");
+	assert(e.getCurrentShape().getGridLoc().getX() == e.getBoard().getSpawnLoc().getX() &&
+		e.getCurrentShape().getGridLoc().getY() == e.getBoard().getSpawnLoc().getY() &&
+		"TetrisEngine ctor - current shape not at the spawn location");
+	assert(e.isPositionLegal(e.getCurrentShape()) && "TetrisEngine ctor - spawned shape should be legal");
+
+	// gravity: a tick's worth of time moves the current shape down one row
+	const int spawnY = e.getCurrentShape().getGridLoc().getY();
+	const TetrisEngine::Nanoseconds tickTime = TetrisEngine::MAX_NANOSECONDS_PER_TICK;
+	e.processGameLoop(tickTime / 2);
+	assert(e.getCurrentShape().getGridLoc().getY() == spawnY && "TetrisEngine.processGameLoop() ticked too early");
+	assert(e.processGameLoop(tickTime / 2) == 1 && "TetrisEngine.processGameLoop() should have fired a tick");
+	assert(e.getCurrentShape().getGridLoc().getY() == spawnY + 1 && "TetrisEngine.processGameLoop() should have ticked");
+
+	// a long loop fires every tick that is due
+	assert(e.processGameLoop(3 * tickTime) == 3 && "TetrisEngine.processGameLoop() should catch up on every pending tick");
+	assert(e.getCurrentShape().getGridLoc().getY() == spawnY + 4 && "TetrisEngine.processGameLoop() lost a tick");
+	assert(e.getGameTime() == 4 * tickTime && "TetrisEngine.getGameTime() should count the time consumed");
+
+	// ... up to the catch-up cap (the partial tick is kept, the rest is dropped)
+	e.reset();
+	assert(e.processGameLoop(100 * tickTime + 5) == TetrisEngine::MAX_TICKS_PER_LOOP &&
+		"TetrisEngine.processGameLoop() should stop at the catch-up cap");
+	assert(e.getGameTime() == TetrisEngine::MAX_TICKS_PER_LOOP * tickTime + 5 &&
+		"TetrisEngine.getGameTime() dropped time should not be counted");
+
+	// the same total time fires the same ticks however it is split between loops
+	TetrisEngine wall{ 3 }, simulated{ 3 };
+	const TetrisEngine::Nanoseconds frame = TetrisEngine::NANOSECONDS_PER_SECOND / 60;
+	int wallTicks = 0;
+	TetrisEngine::Nanoseconds totalTime = 0;
+	for (int f = 0; f < 600; f++) {
+		const TetrisEngine::Nanoseconds jitteryFrame = frame + (f % 7) * 1000 - 3000;
+		wallTicks += wall.processGameLoop(jitteryFrame);
+		totalTime += jitteryFrame;
+	}
+	int simulatedTicks = 0;
+	const TetrisEngine::Nanoseconds step = 1000000;	// 1ms steps, then the remainder
+	for (TetrisEngine::Nanoseconds t = 0; t < totalTime; t += step) {
+		simulatedTicks += simulated.processGameLoop(std::min(step, totalTime - t));
+	}
+	assert(wallTicks == simulatedTicks && wall.getGameTime() == simulated.getGameTime() &&
+		wall.getPieceCount() == simulated.getPieceCount() &&
+		"TetrisEngine.processGameLoop() results should only depend on the total time");
+	for (int y = 0; y < Board::MAX_Y; y++) {
+		for (int x = 0; x < Board::MAX_X; x++) {
+			assert(wall.getBoard().getContent(x, y) == simulated.getBoard().getContent(x, y) &&
+				"TetrisEngine.processGameLoop() boards should match");
+		}
+	}
 
+	// moving left & right
+	e.currentShape.setShape(TetShape::O);
+	e.currentShape.setGridLoc(4, 5);
+	e.applyInput(GameInput::LEFT);
+	assert(e.getCurrentShape().getGridLoc().getX() == 3 && "TetrisEngine.applyInput(LEFT) failed");
+	e.applyInput(GameInput::RIGHT);
+	e.applyInput(GameInput::RIGHT);
+	assert(e.getCurrentShape().getGridLoc().getX() == 5 && "TetrisEngine.applyInput(RIGHT) failed");
+	e.currentShape.setGridLoc(Board::MAX_X - 2, 5);
+	e.applyInput(GameInput::RIGHT);
+	assert(e.getCurrentShape().getGridLoc().getX() == Board::MAX_X - 2 && "TetrisEngine.applyInput(RIGHT) moved through the border");
+
+	// a hard drop locks the shape at the bottom and spawns the next one
+	e.reset();
+	e.currentShape.setShape(TetShape::O);
+	e.currentShape.setGridLoc(0, 0);
+	const TetShape onDeck = e.getNextShape().getShape();
+	e.applyInput(GameInput::HARD_DROP);
+	assert(e.getPieceCount() == 1 && "TetrisEngine.applyInput(HARD_DROP) should lock the shape");
+	assert(e.getBoard().getContent(0, Board::MAX_Y - 1) == static_cast<int>(TetColor::BLUE_LIGHT) &&
+		e.getBoard().getContent(1, Board::MAX_Y - 2) == static_cast<int>(TetColor::BLUE_LIGHT) &&
+		"TetrisEngine.applyInput(HARD_DROP) shape not locked at the bottom");
+	assert(e.getCurrentShape().getShape() == onDeck && "TetrisEngine - next shape was not spawned");
+
+	// completing a row removes it and scores it
+	e.reset();
+	e.board.fillRow(Board::MAX_Y - 1, 1);
+	e.board.setContent(0, Board::MAX_Y - 1, Board::EMPTY_BLOCK);
+	e.currentShape.setShape(TetShape::I);	// vertical, blocks from y-1 to y+2
+	e.currentShape.setGridLoc(0, 1);
+	e.applyInput(GameInput::HARD_DROP);
+	assert(e.getTotalRemovedRows() == 1 && e.getScore() == TetrisEngine::getScore(1) &&
+		"TetrisEngine.applyInput(HARD_DROP) should have completed a row");
+	assert(e.getBoard().getContent(0, Board::MAX_Y - 1) == static_cast<int>(TetColor::BLUE_DARK) &&
+		e.getBoard().getContent(1, Board::MAX_Y - 1) == Board::EMPTY_BLOCK &&
+		"TetrisEngine - rows above the removed row should move down");
+	assert(TetrisEngine::getScore(0) == 0 && TetrisEngine::getScore(4) == 1200 && "TetrisEngine::getScore() unexpected results");
+
+	// getDropRow() agrees with probing, on the surface and under an overhang
+	e.reset();
+	for (int y = 10; y < Board::MAX_Y; y++) {
+		for (int x = 0; x < Board::MAX_X; x++) {
+			if ((x * 5 + y * 3) % 7 < 3) e.board.setContent(x, y, 1);
+		}
+	}
+	for (int shape = 0; shape < static_cast<int>(TetShape::COUNT); shape++) {
+		for (int r = 0; r < Tetromino::ROTATION_COUNT; r++) {
+			for (int y = -1; y < Board::MAX_Y; y++) {
+				for (int x = -2; x < Board::MAX_X + 2; x++) {
+					if (!e.doesShapeFit(static_cast<TetShape>(shape), r, x, y)) continue;
+					int expected = y;
+					while (e.doesShapeFit(static_cast<TetShape>(shape), r, x, expected + 1)) expected++;
+					assert(e.getDropRow(static_cast<TetShape>(shape), r, x, y) == expected &&
+						"TetrisEngine.getDropRow() disagrees with probing");
+				}
+			}
+		}
+	}
+	e.reset();
+	e.board.fillRow(11, 1);
+	e.currentShape.setShape(TetShape::O);
+	e.currentShape.setGridLoc(0, 12);	// tucked under row 11
+	e.drop(e.currentShape);
+	assert(e.getCurrentShape().getGridLoc().getY() == Board::MAX_Y - 2 && "TetrisEngine.drop() should drop under an overhang");
+
+	// the ghost is the current shape at its landing row, reprojected only when something changed
+	e.reset();
+	e.currentShape.setShape(TetShape::O);
+	e.currentShape.setGridLoc(3, 2);
+	assert(e.getGhostShape().getGridLoc().getX() == 3 && e.getGhostShape().getGridLoc().getY() == Board::MAX_Y - 2 &&
+		e.getGhostShape().getShape() == TetShape::O && "TetrisEngine.getGhostShape() should be at the landing row");
+	const std::uint64_t projectedOn = e.ghostGeneration;
+	e.applyInput(GameInput::SOFT_DROP);
+	assert(e.getGhostShape().getGridLoc().getY() == Board::MAX_Y - 2 && e.ghostSourceLoc.getY() == 3 &&
+		"TetrisEngine.getGhostShape() should follow the current shape");
+	e.board.fillRow(Board::MAX_Y - 1, 1);
+	assert(e.getGhostShape().getGridLoc().getY() == Board::MAX_Y - 3 && e.ghostGeneration != projectedOn &&
+		"TetrisEngine.getGhostShape() should be reprojected when the board changes");
+	e.applyInput(GameInput::ROTATE);
+	e.applyInput(GameInput::LEFT);
+	assert(e.getGhostShape().getGridLoc().getX() == 2 && e.getGhostShape().getRotation() == e.getCurrentShape().getRotation() &&
+		"TetrisEngine.getGhostShape() should follow moves & rotations");
+
+	// the game is over when the next shape can't spawn
+	e.reset();
+	for (int y = 1; y < Board::MAX_Y; y++) {
+		e.board.fillRow(y, 1);
+		e.board.setContent(Board::MAX_X - 1, y, Board::EMPTY_BLOCK);
+	}
+	e.currentShape.setShape(TetShape::O);
+	e.currentShape.setGridLoc(0, -1);
+	e.nextShape.setShape(TetShape::I);	// (vertical, it reaches the filled rows at the spawn location)
+	e.applyInput(GameInput::SOFT_DROP);
+	assert(e.isGameOver() == true && "TetrisEngine - the game should be over");
+	const int lockedPieces = e.getPieceCount();
+	e.applyInput(GameInput::HARD_DROP);
+	e.tick();
+	assert(e.getPieceCount() == lockedPieces && "TetrisEngine - input after the game is over should be ignored");
+	e.reset();
+	assert(e.isGameOver() == false && e.getBoard().getHighestOccupiedRow() == Board::MAX_Y &&
+		"TetrisEngine.reset() should start a new game");
+
+	// ticks, input and the lock & spawn path don't allocate (with recording off)
+	if (getAllocationCount != nullptr) {
+		const GameInput inputs[] = { GameInput::ROTATE, GameInput::LEFT, GameInput::SOFT_DROP, GameInput::RIGHT,
+			GameInput::RIGHT, GameInput::ROTATE, GameInput::HARD_DROP };
+		TetrisEngine played{ 3 };
+		std::uint64_t allocations = 0;
+		int locks = 0;
+		for (int i = 0; i < 20000; i++) {
+			if (played.isGameOver()) {
+				locks += played.getPieceCount();
+				played.reset();	// (not counted)
+			}
+			const std::uint64_t before = getAllocationCount();
+			played.tick();
+			played.applyInput(inputs[i % 7]);
+			played.applyInput(inputs[(i / 7) % 7]);
+			allocations += getAllocationCount() - before;
+		}
+		locks += played.getPieceCount();
+		assert(locks > 1000 && "TetrisEngine - the allocation check should lock many shapes");
+		assert(allocations == 0 && "TetrisEngine - a game tick should not allocate");
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("TetrisEngine");
+#endif
+}
+
+void TestSuite::testMoveGeneratorClass()
+{
+#ifdef MOVEGENERATOR
+	announceTest("MoveGenerator");
+	typedef TetrisEngine::Board Board;
+	typedef std::vector<std::pair<int, int>> Cells;
+
+	// the cells a shape covers at a gridLoc (sorted, so equal footprints compare equal)
+	auto getCells = [](TetShape shape, int rotation, int x, int y) {
+		Cells cells;
+		for (const Point& p : Tetromino::getRotationState(shape, rotation).blocks) {
+			cells.push_back({ x + p.getX(), y + p.getY() });
+		}
+		std::sort(cells.begin(), cells.end());
+		return cells;
+	};
+
+	// boards with wells, overhangs & a cave that needs a tuck or a spin to reach
+	std::vector<Board> boards(4);
+	for (int y = 12; y < Board::MAX_Y; y++) {
+		for (int x = 0; x < Board::MAX_X; x++) {
+			if ((x * 7 + y * 5) % 9 < 5) boards[1].setContent(x, y, 1);
+		}
+	}
+	for (int x = 2; x < Board::MAX_X; x++) {
+		boards[2].setContent(x, 14, 2);
+	}
+	for (int x = 0; x < Board::MAX_X; x++) {
+		if (x != 4) boards[3].setContent(x, Board::MAX_Y - 1, 3);
+		if (x > 5) boards[3].setContent(x, Board::MAX_Y - 3, 3);
+	}
+
+	MoveGenerator generator;
+	std::vector<GameInput> path;
+	for (const Board& board : boards) {
+		for (int s = 0; s < static_cast<int>(TetShape::COUNT); s++) {
+			const TetShape shape = static_cast<TetShape>(s);
+			TetrisEngine e;
+			e.board.copyContentFrom(board);
+			e.currentShape.setShape(shape);
+			e.currentShape.setGridLoc(board.getSpawnLoc());
+
+			// every lock footprint a naive search (with doesShapeFit()) reaches ...
+			std::set<Cells> expected;
+			std::set<std::array<int, 3>> seen;
+			std::vector<std::array<int, 3>> open{ { 0, board.getSpawnLoc().getX(), board.getSpawnLoc().getY() } };
+			seen.insert(open.back());
+			while (!open.empty()) {
+				const std::array<int, 3> at = open.back();
+				open.pop_back();
+				if (!e.doesShapeFit(shape, at[0], at[1], at[2] + 1)) {
+					expected.insert(getCells(shape, at[0], at[1], at[2]));
+				}
+				const std::array<int, 3> nexts[4] = { { at[0], at[1] - 1, at[2] }, { at[0], at[1] + 1, at[2] },
+					{ (at[0] + 1) % 4, at[1], at[2] }, { at[0], at[1], at[2] + 1 } };
+				for (const std::array<int, 3>& next : nexts) {
+					if (e.doesShapeFit(shape, next[0], next[1], next[2]) && seen.insert(next).second) {
+						open.push_back(next);
+					}
+				}
+			}
+
+			// ... is generated exactly once
+			const std::vector<MoveGenerator::Move>& moves = generator.generate(board, shape);
+			std::set<Cells> generated;
+			for (const MoveGenerator::Move& move : moves) {
+				assert(generated.insert(getCells(shape, move.rotation, move.x, move.y)).second &&
+					"MoveGenerator.generate() listed a footprint twice");
+			}
+			assert(generated == expected && "MoveGenerator.generate() disagrees with a naive search");
+
+			// and its path locks the shape there
+			for (const MoveGenerator::Move& move : moves) {
+				assert(generator.getPath(move, path) && !path.empty() && path.back() == GameInput::HARD_DROP &&
+					"MoveGenerator.getPath() should end with a hard drop");
+				TetrisEngine trial = e;
+				for (GameInput input : path) {
+					trial.applyInput(input);
+				}
+				Board placed;
+				placed.copyContentFrom(board);
+				for (const std::pair<int, int>& cell : getCells(shape, move.rotation, move.x, move.y)) {
+					placed.setContent(cell.first, cell.second, 1);
+				}
+				placed.removeCompletedRows();
+				assert(trial.getPieceCount() == 1 && "MoveGenerator.getPath() should lock the shape");
+				for (int y = 0; y < Board::MAX_Y; y++) {
+					assert(trial.getBoard().getRow(y) == placed.getRow(y) && "MoveGenerator.getPath() locked somewhere else");
+				}
+			}
+		}
+	}
+
+	// the cave on board 3 (under the ledge at row MAX_Y - 3) needs a tuck
+	bool tucked = false;
+	for (const MoveGenerator::Move& move : generator.generate(boards[3], TetShape::I)) {
+		if (move.y + Tetromino::getRotationState(TetShape::I, move.rotation).minY == Board::MAX_Y - 2 && move.x > 6) {
+			tucked = true;
+			assert(generator.getPath(move, path) && std::count(path.begin(), path.end(), GameInput::SOFT_DROP) > 0 &&
+				"MoveGenerator.getPath() a tuck needs soft drops");
+		}
+	}
+	assert(tucked && "MoveGenerator.generate() should find the tuck under the ledge");
+
+	// an O has one footprint per column, whatever its rotation; a shape that can't spawn has none
+	assert(generator.generate(Board{}, TetShape::O).size() == Board::MAX_X - 1 && "MoveGenerator.generate() O duplicates");
+	Board full;
+	for (int y = 0; y < Board::MAX_Y; y++) {
+		full.fillRow(y, 1);
+	}
+	assert(generator.generate(full, TetShape::T).empty() && "MoveGenerator.generate() nothing fits on a full board");
+	MoveGenerator::Move bogus;
+	bogus.y = 3;
+	assert(!generator.getPath(bogus, path) && path.empty() && "MoveGenerator.getPath() should reject unreachable moves");
+
+	// perft: depth 1 is the move count, the counts don't depend on the threads,
+	// a divide adds up to the count, and the counts of the built-in positions never change
+	const std::vector<TetShape> pieces{ TetShape::T, TetShape::I, TetShape::S };
+	const std::uint64_t expected[PERFT_POSITION_COUNT][2]{ { 596, 10631 }, { 692, 12716 }, { 588, 10413 } };
+	for (int p = 0; p < PERFT_POSITION_COUNT; p++) {
+		const Board position = getPerftPosition(p);
+		assert(perft(position, pieces, 1).sequences == generator.generate(position, pieces[0]).size() &&
+			"perft() depth 1 should count the moves");
+		const PerftStats single = perft(position, pieces, 3, 1);
+		const PerftStats threaded = perft(position, pieces, 3, 3);
+		assert(single.sequences == threaded.sequences && single.placements == threaded.placements &&
+			"perft() the threads changed the count");
+		assert(perft(position, pieces, 2).sequences == expected[p][0] && single.sequences == expected[p][1] &&
+			"perft() the count of a built-in position changed");
+		const std::vector<std::uint64_t> counts = perftDivide(position, pieces, 3);
+		std::uint64_t sum = 0;
+		for (std::uint64_t count : counts) {
+			sum += count;
+		}
+		assert(sum == single.sequences && "perftDivide() should add up to the perft() count");
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("MoveGenerator");
+#endif
+}
+
+void TestSuite::testEvaluatorClass()
+{
+#ifdef EVALUATOR
+	announceTest("Evaluator");
+	typedef TetrisEngine::Board Board;
+
+	// the features of a board, one cell at a time
+	auto naiveFeatures = [](const Board& board) {
+		auto occupied = [&board](int x, int y) {
+			return x < 0 || x >= Board::MAX_X || y >= Board::MAX_Y || board.getContent(x, y) != Board::EMPTY_BLOCK;
+		};
+		Evaluator::Features features;
+		int heights[Board::MAX_X]{};
+		for (int x = 0; x < Board::MAX_X; x++) {
+			bool covered = false;
+			int wellDepth = 0;
+			for (int y = 0; y < Board::MAX_Y; y++) {
+				if (occupied(x, y) && !covered) {
+					heights[x] = Board::MAX_Y - y;
+					covered = true;
+				}
+				if (!occupied(x, y) && covered) {
+					features.holes++;
+				}
+				wellDepth = !occupied(x, y) && !covered && occupied(x - 1, y) && occupied(x + 1, y) ? wellDepth + 1 : 0;
+				features.wellSums += wellDepth;
+				features.columnTransitions += occupied(x, y) != occupied(x, y + 1) ? 1 : 0;
+			}
+			features.aggregateHeight += heights[x];
+			features.bumpiness += x > 0 ? std::abs(heights[x] - heights[x - 1]) : 0;
+		}
+		for (int y = 0; y < Board::MAX_Y; y++) {
+			for (int x = -1; x < Board::MAX_X; x++) {
+				features.rowTransitions += occupied(x, y) != occupied(x + 1, y) ? 1 : 0;
+			}
+		}
+		return features;
+	};
+
+	// the bitboard features match the cell by cell features on random boards
+	Random rng{ 11 };
+	for (int b = 0; b < 300; b++) {
+		Board board;
+		const int stack = rng.nextInt(Board::MAX_Y + 1);
+		for (int y = Board::MAX_Y - stack; y < Board::MAX_Y; y++) {
+			for (int x = 0; x < Board::MAX_X; x++) {
+				if (rng.nextInt(10) < 6) {
+					board.setContent(x, y, 1);
+				}
+			}
+		}
+		Evaluator::Candidate candidate;
+		Evaluator::getRows(board, candidate.rows);
+		const Evaluator::Features expected = naiveFeatures(board);
+		const Evaluator::Features features = Evaluator::getFeatures(candidate);
+		assert(features.aggregateHeight == expected.aggregateHeight && "Evaluator::getFeatures() aggregate height");
+		assert(features.holes == expected.holes && "Evaluator::getFeatures() holes");
+		assert(features.bumpiness == expected.bumpiness && "Evaluator::getFeatures() bumpiness");
+		assert(features.rowTransitions == expected.rowTransitions && "Evaluator::getFeatures() row transitions");
+		assert(features.columnTransitions == expected.columnTransitions && "Evaluator::getFeatures() column transitions");
+		assert(features.wellSums == expected.wellSums && "Evaluator::getFeatures() well sums");
+	}
+
+	// a well 3 deep next to the wall adds 1 + 2 + 3
+	Board walled;
+	for (int y = Board::MAX_Y - 3; y < Board::MAX_Y; y++) {
+		walled.setContent(1, y, 1);
+	}
+	Evaluator::Candidate candidate;
+	Evaluator::getRows(walled, candidate.rows);
+	assert(Evaluator::getFeatures(candidate).wellSums == 6 && "Evaluator::getFeatures() a well next to the wall");
+
+	// placing removes the completed rows & records the landing height
+	Board nearlyFull;
+	nearlyFull.fillRow(Board::MAX_Y - 1, 1);
+	nearlyFull.setContent(0, Board::MAX_Y - 1, Board::EMPTY_BLOCK);
+	nearlyFull.setContent(5, Board::MAX_Y - 2, 1);
+	Evaluator::Rows rows;
+	Evaluator::getRows(nearlyFull, rows);
+	MoveGenerator generator;
+	const std::vector<MoveGenerator::Move>& moves = generator.generate(nearlyFull, TetShape::I);
+	bool cleared = false;
+	for (const MoveGenerator::Move& move : moves) {
+		Evaluator::place(rows, TetShape::I, move, candidate);
+		Board placed = nearlyFull;
+		for (const Point& block : Tetromino::getRotationState(TetShape::I, move.rotation).blocks) {
+			placed.setContent(move.x + block.getX(), move.y + block.getY(), 1);
+		}
+		const int removed = placed.removeCompletedRows();
+		assert(candidate.removedRows == removed && "Evaluator::place() removed rows");
+		for (int y = 0; y < Board::MAX_Y; y++) {
+			assert(candidate.rows[y] == placed.getRow(y) && "Evaluator::place() should match the board");
+		}
+		if (removed == 1 && move.x == 0) {
+			cleared = true;
+			assert(candidate.landingHeight == 1.5 && "Evaluator::place() a vertical I in the bottom row is 1.5 high");
+		}
+	}
+	assert(cleared && "Evaluator::place() the vertical I should complete the bottom row");
+
+	// a shape locking across the top row keeps only its blocks on the board
+	const RotationState& vertical = Tetromino::getRotationState(TetShape::I, 1);
+	MoveGenerator::Move overTop;
+	overTop.rotation = 1;
+	overTop.x = -vertical.minX;
+	overTop.y = -1 - vertical.minY;
+	Evaluator::Rows emptyRows;
+	Evaluator::getRows(Board{}, emptyRows);
+	Evaluator::place(emptyRows, TetShape::I, overTop, candidate);
+	Board overTopBoard;
+	for (const Point& block : vertical.blocks) {
+		overTopBoard.setContent(overTop.x + block.getX(), overTop.y + block.getY(), 1);
+	}
+	for (int y = 0; y < Board::MAX_Y; y++) {
+		assert(candidate.rows[y] == overTopBoard.getRow(y) && "Evaluator::place() blocks above the top row are dropped");
+	}
+
+	// a batch scores the same as one candidate at a time
+	Evaluator evaluator;
+	std::vector<double> scores;
+	evaluator.scoreMoves(nearlyFull, TetShape::I, moves, scores);
+	assert(scores.size() == moves.size() && "Evaluator::scoreMoves() one score per move");
+	for (std::size_t m = 0; m < moves.size(); m++) {
+		Evaluator::place(rows, TetShape::I, moves[m], candidate);
+		assert(scores[m] == evaluator.score(candidate) && "Evaluator::scoreMoves() should match score()");
+	}
+	const Evaluator::Weights onlyRows{ 0, 0, 0, 0, 0, 0, 0, 1 };
+	evaluator.setWeights(onlyRows);
+	evaluator.scoreMoves(nearlyFull, TetShape::I, moves, scores);
+	assert(*std::max_element(scores.begin(), scores.end()) == 1 && "Evaluator::score() should follow the weights");
+
+	// the greedy policy keeps a game going
+	std::unique_ptr<PlacementPolicy> greedy = createPolicy("greedy", 1);
+	assert(greedy != nullptr && greedy->getName() == "greedy" && "createPolicy() should make the greedy policy");
+	TetrisEngine e{ 5, PieceGenerator::Kind::RANDOM };
+	const SimulationStats stats = playGame(e, *greedy, 500);
+	assert(stats.pieces == 500 && stats.lines > 150 && "GreedyPolicy should survive 500 pieces");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Evaluator");
+#endif
+}
+
+void TestSuite::testBeamSearchClass()
+{
+#ifdef BEAMSEARCH
+	announceTest("BeamSearch");
+	typedef TetrisEngine::Board Board;
+	const BeamSearch::Clock::time_point noDeadline = BeamSearch::Clock::time_point::max();
+
+	// a board's Zobrist hash is the XOR of its cells' keys, however the board was built
+	Board board;
+	std::uint64_t expectedHash = 0;
+	for (int y = Board::MAX_Y - 4; y < Board::MAX_Y; y++) {
+		for (int x = 0; x < Board::MAX_X; x++) {
+			if ((x + 2 * y) % 3 != 0) {
+				board.setContent(x, y, 1);
+				expectedHash ^= Zobrist::cellKey(x, y);
+			}
+		}
+	}
+	Evaluator::Rows rows;
+	Evaluator::getRows(board, rows);
+	const std::uint64_t hash = Zobrist::hashRows<Board::MAX_X, Board::MAX_Y>(rows.data());
+	assert(hash == expectedHash && "Zobrist::hashRows() XOR of the cell keys");
+	const Evaluator::Rows emptyRows{};
+	const std::uint64_t emptyHash = Zobrist::hashRows<Board::MAX_X, Board::MAX_Y>(emptyRows.data());
+	assert(emptyHash == 0 && "Zobrist::hashRows() an empty board hashes to 0");
+	assert(Zobrist::cellKey(0, 1) != Zobrist::cellKey(1, 0) && "Zobrist::cellKey() cells should have different keys");
+
+	// one piece: the best placement the Evaluator scores
+	BeamSearch search{ 16 };
+	Evaluator evaluator;
+	MoveGenerator generator;
+	std::vector<double> scores;
+	const std::vector<MoveGenerator::Move> moves = generator.generate(board, TetShape::T);
+	evaluator.scoreMoves(board, TetShape::T, moves, scores);
+	BeamSearch::Result result = search.search(board, { TetShape::T }, noDeadline);
+	assert(result.found && result.depth == 1 && result.nodes == moves.size() && "BeamSearch::search() one piece, one depth");
+	assert(result.value == *std::max_element(scores.begin(), scores.end()) && "BeamSearch::search() the best scored placement");
+
+	// the lookahead completes every depth, and its first move is a lock position of the first piece
+	result = search.search(board, { TetShape::T, TetShape::I, TetShape::L }, noDeadline);
+	assert(result.found && result.depth == 3 && "BeamSearch::search() should search every piece");
+	bool listed = false;
+	for (const MoveGenerator::Move& move : moves) {
+		listed = listed || (move.rotation == result.move.rotation && move.x == result.move.x && move.y == result.move.y);
+	}
+	assert(listed && "BeamSearch::search() the move should be a lock position of the first piece");
+
+	// a deadline that has passed still gets the first piece's answer
+	result = search.search(board, { TetShape::T, TetShape::I, TetShape::L }, BeamSearch::Clock::now());
+	assert(result.found && result.depth == 1 && "BeamSearch::search() the first depth ignores the deadline");
+
+	// two Os side by side make the same board in either order
+	result = search.search(Board{}, { TetShape::O, TetShape::O }, noDeadline);
+	assert(result.duplicates > 0 && "BeamSearch::search() the transposition table should merge equal boards");
+
+	// nothing fits on a full board
+	Board full;
+	for (int y = 0; y < Board::MAX_Y; y++) {
+		full.fillRow(y, 1);
+	}
+	assert(!search.search(full, { TetShape::T }, noDeadline).found && "BeamSearch::search() no placement on a full board");
+
+	// the beam policy plays every placement through its path
+	std::unique_ptr<PlacementPolicy> beam = createPolicy("beam", 1);
+	assert(beam != nullptr && beam->getName() == "beam" && "createPolicy() should make the beam policy");
+	TetrisEngine e{ 5, PieceGenerator::Kind::RANDOM };
+	const Placement placement = beam->choosePlacement(e);
+	assert(!placement.path.empty() && placement.path.back() == GameInput::HARD_DROP && "BeamPolicy should give a path");
+	const SimulationStats stats = playGame(e, *beam, 300);
+	assert(stats.pieces == 300 && stats.lines > 100 && "BeamPolicy should survive 300 pieces");
+
+	announceTestCompletion();
+#else
+	announceNotTested("BeamSearch");
+#endif
+}
+
+void TestSuite::testParallelSearchClass()
+{
+#ifdef PARALLELSEARCH
+	announceTest("ParallelSearch");
+	typedef TetrisEngine::Board Board;
+	const ParallelSearch::Clock::time_point noDeadline = ParallelSearch::Clock::time_point::max();
+
+	// the table finds what was stored, and only that
+	TranspositionTable table{ 10 };
+	double value = 0;
+	assert(!table.probe(42, value) && "TranspositionTable::probe() an empty table has nothing");
+	table.store(42, -3.5);
+	assert(table.probe(42, value) && value == -3.5 && "TranspositionTable::probe() should find a stored value");
+	assert(!table.probe(42 + (std::uint64_t{ 1 } << 40), value) && "TranspositionTable::probe() another key in the slot");
+	table.clear();
+	assert(!table.probe(42, value) && "TranspositionTable::clear() should forget every value");
+
+	const Board board = getLedgeBoard();
+
+	// one piece: the BeamSearch's answer; two pieces: every sequence, as a beam wide enough to keep them all
+	ParallelSearch search{ 3 };
+	assert(search.getThreadCount() == 3 && ParallelSearch{ 0 }.getThreadCount() >= 1 && "ParallelSearch() thread count");
+	BeamSearch wideBeam{ 1000 };
+	ParallelSearch::Result result = search.search(board, { TetShape::L }, noDeadline);
+	BeamSearch::Result beamResult = wideBeam.search(board, { TetShape::L }, noDeadline);
+	assert(result.found && result.depth == 1 && result.value == beamResult.value && "ParallelSearch::search() one piece");
+	result = search.search(board, { TetShape::L, TetShape::I }, noDeadline);
+	beamResult = wideBeam.search(board, { TetShape::L, TetShape::I }, noDeadline);
+	assert(result.depth == 2 && result.value == beamResult.value && result.move.x == beamResult.move.x &&
+		result.move.rotation == beamResult.move.rotation && result.move.y == beamResult.move.y &&
+		"ParallelSearch::search() two pieces should match an exhaustive beam");
+
+	// the answer doesn't depend on the threads, and a repeated search reuses the shared table
+	const std::vector<TetShape> pieces{ TetShape::T, TetShape::S, TetShape::O };
+	ParallelSearch single{ 1 };
+	const ParallelSearch::Result first = single.search(board, pieces, noDeadline);
+	const ParallelSearch::Result threaded = search.search(board, pieces, noDeadline);
+	assert(first.depth == 3 && threaded.depth == 3 && first.value == threaded.value &&
+		first.move.x == threaded.move.x && first.move.rotation == threaded.move.rotation && first.move.y == threaded.move.y &&
+		"ParallelSearch::search() the threads changed the answer");
+	const ParallelSearch::Result again = single.search(board, pieces, noDeadline);
+	assert(again.value == first.value && again.tableHits > first.tableHits && again.nodes < first.nodes &&
+		"ParallelSearch::search() a repeated search should hit the table");
+
+	// a deadline that has passed still gets the first piece's answer
+	result = ParallelSearch{ 2 }.search(board, pieces, ParallelSearch::Clock::now());
+	assert(result.found && result.depth == 1 && "ParallelSearch::search() the first depth ignores the deadline");
+
+	// the parallel policy plays every placement through its path
+	std::unique_ptr<PlacementPolicy> parallel = createPolicy("parallel", 1);
+	assert(parallel != nullptr && parallel->getName() == "parallel" && "createPolicy() should make the parallel policy");
+	TetrisEngine e{ 9, PieceGenerator::Kind::BAG };
+	const SimulationStats stats = playGame(e, *parallel, 200);
+	assert(stats.pieces == 200 && stats.lines > 60 && "ParallelPolicy should survive 200 pieces");
+
+	announceTestCompletion();
+#else
+	announceNotTested("ParallelSearch");
+#endif
+}
+
+void TestSuite::testExpectimaxSearchClass()
+{
+#ifdef EXPECTIMAXSEARCH
+	announceTest("ExpectimaxSearch");
+	typedef TetrisEngine::Board Board;
+	const ExpectimaxSearch::Clock::time_point noDeadline = ExpectimaxSearch::Clock::time_point::max();
+
+	// the bag still holds what hasn't been dealt from it (and nothing is known of other kinds)
+	PieceGenerator bagged{ PieceGenerator::Kind::BAG, 5 };
+	bagged.seek(9);
+	const int remaining = bagged.getBagRemaining();
+	assert((remaining & (1 << static_cast<int>(bagged.getPiece(7)))) == 0 &&
+		(remaining & (1 << static_cast<int>(bagged.getPiece(8)))) == 0 &&
+		(remaining & (1 << static_cast<int>(bagged.getPiece(9)))) != 0 &&
+		(remaining & (1 << static_cast<int>(bagged.getPiece(13)))) != 0 &&
+		"PieceGenerator::getBagRemaining() should hold the shapes not dealt from the bag");
+	bagged.seek(14);
+	assert(bagged.getBagRemaining() == 0x7F && "PieceGenerator::getBagRemaining() a new bag holds every shape");
+	assert(PieceGenerator{}.getBagRemaining() == 0 && "PieceGenerator::getBagRemaining() only a BAG has a bag");
+
+	const Board board = getLedgeBoard();
+
+	// the known pieces alone, or a bag that can only deal one shape: every sequence, as the ParallelSearch's
+	ParallelSearch exhaustive{ 1 };
+	const ParallelSearch::Result known = exhaustive.search(board, { TetShape::L, TetShape::I }, noDeadline);
+	ExpectimaxSearch knownOnly{ 0 };
+	ExpectimaxSearch::Result result = knownOnly.search(board, { TetShape::L, TetShape::I }, ExpectimaxSearch::UNIFORM, noDeadline);
+	assert(result.found && result.unknown == 0 && result.value == known.value && result.move.x == known.move.x &&
+		result.move.rotation == known.move.rotation && "ExpectimaxSearch::search() the known pieces alone");
+	ExpectimaxSearch search{ 1 };
+	result = search.search(board, { TetShape::L }, 1 << static_cast<int>(TetShape::I), noDeadline);
+	assert(result.unknown == 1 && result.value == known.value && result.move.x == known.move.x &&
+		result.move.rotation == known.move.rotation && "ExpectimaxSearch::search() a bag of one shape isn't a chance");
+
+	// uniform: the best first placement's average over the 7 shapes of their best placement
+	const Evaluator evaluator;
+	const Evaluator::Weights& weights = evaluator.getWeights();
+	Evaluator::Rows rows;
+	Evaluator::getRows(board, rows);
+	MoveGenerator rootGenerator;
+	MoveGenerator generator;
+	double bestExpected = ExpectimaxSearch::TOPPED_OUT;
+	for (const MoveGenerator::Move& move : rootGenerator.generate(board, TetShape::L)) {
+		Evaluator::Candidate root;
+		Evaluator::place(rows, TetShape::L, move, root);
+		const Evaluator::Features rootFeatures = Evaluator::getFeatures(root);
+		double sum = 0;
+		for (int shape = 0; shape < PieceGenerator::SHAPE_COUNT; shape++) {
+			GridTetromino spawned;
+			spawned.setShape(static_cast<TetShape>(shape));
+			spawned.setGridLoc(board.getSpawnLoc());
+			double best = ExpectimaxSearch::TOPPED_OUT;
+			for (const MoveGenerator::Move& next : generator.generate(root.rows.data(), spawned)) {
+				Evaluator::Candidate child;
+				Evaluator::place(root.rows, static_cast<TetShape>(shape), next, child);
+				best = std::max(best, evaluator.score(Evaluator::getFeatures(child)));
+			}
+			sum += best;
+		}
+		bestExpected = std::max(bestExpected, weights.landingHeight * rootFeatures.landingHeight +
+			weights.removedRows * rootFeatures.removedRows + sum / PieceGenerator::SHAPE_COUNT);
+	}
+	const ExpectimaxSearch::Result uniform = search.search(board, { TetShape::L }, ExpectimaxSearch::UNIFORM, noDeadline);
+	assert(uniform.unknown == 1 && std::fabs(uniform.value - bestExpected) < 1e-9 &&
+		"ExpectimaxSearch::search() should average uniformly over the unknown piece");
+
+	// a repeated search is answered from the table
+	const ExpectimaxSearch::Result again = search.search(board, { TetShape::L }, ExpectimaxSearch::UNIFORM, noDeadline);
+	assert(again.value == uniform.value && again.tableHits > uniform.tableHits && again.nodes < uniform.nodes &&
+		"ExpectimaxSearch::search() a repeated search should hit the table");
+
+	// a deadline that has passed still gets the known pieces' answer
+	result = ExpectimaxSearch{ 2 }.search(board, { TetShape::T, TetShape::S }, 0x7F, ExpectimaxSearch::Clock::now());
+	assert(result.found && result.unknown == 0 && "ExpectimaxSearch::search() the known pieces ignore the deadline");
+
+	// the expectimax policy plays every placement through its path, and with no time
+	// budget its choices only depend on the game
+	PolicyOptions untimed;
+	untimed.timed = false;
+	std::unique_ptr<PlacementPolicy> expectimax = createPolicy("expectimax", 1, untimed);
+	assert(expectimax != nullptr && expectimax->getName() == "expectimax" && "createPolicy() should make the expectimax policy");
+	const int pieces = 12;
+	TetrisEngine e{ 9, PieceGenerator::Kind::BAG };
+	const SimulationStats stats = playGame(e, *expectimax, pieces);
+	assert(stats.pieces == pieces && "ExpectimaxPolicy should survive 12 pieces");
+	TetrisEngine replayed{ 9, PieceGenerator::Kind::BAG };
+	const SimulationStats replayedStats = playGame(replayed, *createPolicy("expectimax", 1, untimed), pieces);
+	assert(replayedStats.score == stats.score && replayed.getBoard().getHash() == e.getBoard().getHash() &&
+		"ExpectimaxPolicy with no time budget should play the same game again");
+
+	announceTestCompletion();
+#else
+	announceNotTested("ExpectimaxSearch");
+#endif
+}
+
+void TestSuite::testReplayClass()
+{
+#ifdef REPLAY
+	announceTest("Replay");
+	typedef TetrisEngine::Board Board;
+
+	// true if two engines are in the same state
+	auto sameGame = [](const TetrisEngine& a, const TetrisEngine& b) {
+		if (a.getScore() != b.getScore() || a.getPieceCount() != b.getPieceCount() ||
+			a.getTotalRemovedRows() != b.getTotalRemovedRows() || a.isGameOver() != b.isGameOver() ||
+			a.getCurrentShape().getShape() != b.getCurrentShape().getShape() ||
+			a.getCurrentShape().getRotation() != b.getCurrentShape().getRotation() ||
+			a.getCurrentShape().getGridLoc().getX() != b.getCurrentShape().getGridLoc().getX() ||
+			a.getCurrentShape().getGridLoc().getY() != b.getCurrentShape().getGridLoc().getY()) {
+			return false;
+		}
+		for (int y = 0; y < Board::MAX_Y; y++) {
+			for (int x = 0; x < Board::MAX_X; x++) {
+				if (a.getBoard().getContent(x, y) != b.getBoard().getContent(x, y)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	// record a game driven by the clock & (random) player input
+	Replay replay;
+	TetrisEngine e{ 17, PieceGenerator::Kind::BAG };
+	e.setRecording(&replay);
+	e.reset();	// (a recording begins on reset - this game starts 2 pieces into the sequence)
+	Random player{ 4 };
+	for (int loop = 0; loop < 20000 && !e.isGameOver(); loop++) {
+		e.processGameLoop(TetrisEngine::NANOSECONDS_PER_SECOND / 60);
+		if (player.nextInt(4) == 0) {
+			e.applyInput(static_cast<GameInput>(player.nextInt(static_cast<int>(GameInput::COUNT))));
+		}
+	}
+	e.processGameLoop(100 * TetrisEngine::MAX_NANOSECONDS_PER_TICK);	// some trailing ticks
+	assert(replay.getFirstPiece() == 2 && replay.getPieceKind() == PieceGenerator::Kind::BAG && replay.getSeed() == 17 &&
+		"Replay.begin() should record the piece generator");
+	assert(replay.getInputCount() > 0 && replay.getTickCount() > 0 && "Replay should record inputs & ticks");
+
+	// the binary format round trips and plays back the same game
+	const std::vector<std::uint8_t> bytes = replay.serialize();
+	assert(bytes.size() < static_cast<std::size_t>(32 + replay.getInputCount() * 2) && "Replay.serialize() events should pack into about a byte each");
+	Replay loaded;
+	assert(loaded.deserialize(bytes) && "Replay.deserialize() should accept serialize() output");
+	assert(loaded.getInputCount() == replay.getInputCount() && loaded.getTickCount() == replay.getTickCount() &&
+		"Replay.deserialize() event counts don't match");
+	TetrisEngine played;
+	assert(loaded.playBack(played) && "Replay.playBack() failed");
+	assert(sameGame(e, played) && "Replay.playBack() should reproduce the recorded game");
+
+	// long tick deltas are escaped
+	Replay ticks;
+	TetrisEngine slow{ 5 };
+	slow.setRecording(&ticks);
+	slow.reset(5);
+	for (int t = 0; t < 1000; t++) {
+		slow.tick();
+	}
+	slow.applyInput(GameInput::LEFT);
+	Replay ticksLoaded;
+	assert(ticksLoaded.deserialize(ticks.serialize()) && ticksLoaded.getTickCount() == ticks.getTickCount() &&
+		"Replay escaped tick deltas don't round trip");
+	assert(ticksLoaded.playBack(played) && sameGame(slow, played) && "Replay.playBack() escaped tick deltas");
+
+	// a recorded policy game plays back the same
+	Replay botReplay;
+	TetrisEngine bot{ 8 };
+	bot.setRecording(&botReplay);
+	bot.reset(8);
+	LowestPolicy policy;
+	while (!bot.isGameOver() && bot.getPieceCount() < 300) {
+		PlacementPolicy::applyPlacement(bot, policy.choosePlacement(bot));
+	}
+	assert(botReplay.playBack(played) && sameGame(bot, played) && "Replay.playBack() policy game doesn't match");
+
+	// keyframes: seek() lands on the same state as playing up to the piece
+	Replay keyed;
+	keyed.setKeyframeInterval(5);
+	TetrisEngine live{ 21, PieceGenerator::Kind::HISTORY };
+	live.setRecording(&keyed);
+	live.reset(21);
+	std::vector<TetrisEngine::Snapshot> afterLock(1, live.getSnapshot());	// [n]: the game after n pieces locked
+	Random keyedPlayer{ 6 };
+	for (int loop = 0; loop < 40000 && !live.isGameOver(); loop++) {
+		live.processGameLoop(TetrisEngine::NANOSECONDS_PER_SECOND / 60);
+		if (static_cast<int>(afterLock.size()) <= live.getPieceCount()) {
+			afterLock.push_back(live.getSnapshot());
+		}
+		if (keyedPlayer.nextInt(3) == 0) {
+			live.applyInput(static_cast<GameInput>(keyedPlayer.nextInt(static_cast<int>(GameInput::HARD_DROP))));
+		}
+		if (static_cast<int>(afterLock.size()) <= live.getPieceCount()) {
+			afterLock.push_back(live.getSnapshot());
+		}
+	}
+	assert(static_cast<int>(afterLock.size()) == live.getPieceCount() + 1 && "Replay seek test - a piece count was skipped");
+	assert(keyed.getKeyframes().size() == static_cast<std::size_t>(live.getPieceCount() / 5) && "Replay should keep a keyframe every 5 pieces");
+
+	Replay keyedLoaded;
+	assert(keyedLoaded.deserialize(keyed.serialize()) && keyedLoaded.getKeyframes().size() == keyed.getKeyframes().size() &&
+		"Replay.deserialize() should read the keyframes back");
+	TetrisEngine expected, seeked;
+	for (const Replay* source : { &keyed, &keyedLoaded }) {
+		for (int count : { 0, 1, 4, 5, 6, 13, live.getPieceCount() - 1, live.getPieceCount() }) {
+			expected.restoreSnapshot(afterLock[count]);
+			assert(source->seek(seeked, count) && sameGame(expected, seeked) && "Replay.seek() didn't reach the expected state");
+		}
+		assert(source->seek(seeked, live.getPieceCount() + 100) && sameGame(live, seeked) &&
+			"Replay.seek() past the end should stop at the end of the game");
+	}
+	Replay unkeyed;
+	assert(unkeyed.deserialize(keyed.serialize()));
+	unkeyed.keyframes.clear();
+	expected.restoreSnapshot(afterLock[13]);
+	assert(unkeyed.seek(seeked, 13) && sameGame(expected, seeked) && "Replay.seek() without keyframes should replay from the start");
+
+	// save() & load() write & read the same bytes
+	const std::string path = "testsuite.replay";
+	Replay fromFile;
+	assert(botReplay.save(path) && fromFile.load(path) && "Replay.save()/load() failed");
+	std::remove(path.c_str());
+	assert(fromFile.serialize() == botReplay.serialize() && "Replay.load() should read what save() wrote");
+	assert(!fromFile.load(path) && "Replay.load() should fail on a missing file");
+
+	// malformed replays are rejected (and leave the replay unchanged)
+	std::vector<std::uint8_t> corrupt = bytes;
+	corrupt[0] = 'X';
+	assert(!loaded.deserialize(corrupt) && "Replay.deserialize() should check the magic");
+	corrupt = bytes;
+	corrupt[4] = Replay::VERSION + 1;
+	assert(!loaded.deserialize(corrupt) && "Replay.deserialize() should check the version");
+	corrupt = std::vector<std::uint8_t>(bytes.begin(), bytes.begin() + 10);
+	assert(!loaded.deserialize(corrupt) && "Replay.deserialize() should reject a truncated header");
+	Replay truncated = replay;
+	truncated.events.assign(1, static_cast<std::uint8_t>(31 << Replay::INPUT_BITS));	// an escaped tick delta with no count
+	truncated.pendingTicks = 0;
+	assert(!loaded.deserialize(truncated.serialize()) && "Replay.deserialize() should reject a truncated event");
+	corrupt = bytes;
+	corrupt.pop_back();
+	assert(!loaded.deserialize(corrupt) && "Replay.deserialize() should reject a truncated keyframe section");
+	assert(loaded.getInputCount() == replay.getInputCount() && "Replay.deserialize() failures should leave the replay unchanged");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Replay");
+#endif
+}
+
+void TestSuite::testSimulation()
+{
+#ifdef SIMULATION
+	announceTest("Simulation");
+	typedef TetrisEngine::Board Board;
+
+	// applyPlacement() rotates, slides & hard drops with ordinary input
+	TetrisEngine e;
+	e.currentShape.setShape(TetShape::I);
+	e.currentShape.setGridLoc(e.getBoard().getSpawnLoc());
+	Placement placement;
+	placement.rotation = 1;	// horizontal
+	placement.x = 2;
+	assert(PlacementPolicy::getLandingRow(e, TetShape::I, 1, 2) == Board::MAX_Y - 1 &&
+		"PlacementPolicy::getLandingRow() a horizontal I should land on the bottom row");
+	PlacementPolicy::applyPlacement(e, placement);
+	assert(e.getPieceCount() == 1 && "PlacementPolicy::applyPlacement() should lock the shape");
+	const RotationState& horizontalI = Tetromino::getRotationState(TetShape::I, 1);
+	for (int x = 2 + horizontalI.minX; x < 2 + horizontalI.minX + horizontalI.width; x++) {
+		assert(e.getBoard().getContent(x, Board::MAX_Y - 1) != Board::EMPTY_BLOCK &&
+			"PlacementPolicy::applyPlacement() shape not placed where expected");
+	}
+
+	// placements into a wall stop at the wall
+	e.reset();
+	placement.rotation = 0;
+	placement.x = -5;
+	PlacementPolicy::applyPlacement(e, placement);
+	assert(e.getPieceCount() == 1 && "PlacementPolicy::applyPlacement() should lock the shape against the wall");
+
+	// unknown policies are rejected
+	assert(createPolicy("no such policy", 1) == nullptr && "createPolicy() should reject unknown names");
+	assert(isPolicyName("expectimax") && !isPolicyName("no such policy") && "isPolicyName() should know the createPolicy() names");
+
+	// the same options always play the same games
+	SimulationOptions options;
+	options.games = 5;
+	options.seed = 42;
+	options.maxPiecesPerGame = 500;
+	const SimulationStats first = runSimulation(options);
+	const SimulationStats second = runSimulation(options);
+	assert(first.games == 5 && first.pieces > 0 && "runSimulation() should play every game");
+	assert(first.pieces == second.pieces && first.lines == second.lines && first.score == second.score &&
+		"runSimulation() the same seed should play the same games");
+	assert(first.pieces <= options.games * options.maxPiecesPerGame && "runSimulation() ignored maxPiecesPerGame");
+
+	// the totals don't depend on how many threads played the games
+	options.games = 12;
+	options.threads = 1;
+	const SimulationStats oneThread = runSimulation(options);
+	options.threads = 4;
+	const SimulationStats fourThreads = runSimulation(options);
+	assert(oneThread.games == 12 && fourThreads.games == 12 && "runSimulation() should play every game on every thread count");
+	assert(oneThread.pieces == fourThreads.pieces && oneThread.lines == fourThreads.lines &&
+		oneThread.score == fourThreads.score && "runSimulation() results should not depend on the thread count");
+	options.policy = "random";
+	options.threads = 3;
+	const SimulationStats randomThreaded = runSimulation(options);
+	options.threads = 1;
+	const SimulationStats randomSingle = runSimulation(options);
+	assert(randomThreaded.pieces == randomSingle.pieces && randomThreaded.score == randomSingle.score &&
+		"runSimulation() random policy results should not depend on the thread count");
+	// the lookahead policies search with no time budget, so they don't either
+	options.policy = "parallel";
+	options.games = 3;
+	options.maxPiecesPerGame = 60;
+	const SimulationStats parallelSingle = runSimulation(options);
+	options.threads = 3;
+	const SimulationStats parallelThreaded = runSimulation(options);
+	assert(parallelSingle.pieces == parallelThreaded.pieces && parallelSingle.score == parallelThreaded.score &&
+		"runSimulation() lookahead policy results should not depend on the thread count");
+
+	// Random streams are repeatable & independent
+	Random a{ 7 }, b{ 7 };
+	for (int i = 0; i < 100; i++) {
+		const int value = a.nextInt(7);
+		assert(value == b.nextInt(7) && "Random the same seed should give the same sequence");
+		assert(value >= 0 && value < 7 && "Random::nextInt() out of range");
+	}
+	assert(Random::streamSeed(7, 0) != Random::streamSeed(7, 1) && "Random::streamSeed() streams should differ");
+	Random child = a.split();
+	assert(child.next() != a.next() && "Random::split() child should not repeat its parent");
+
+	// engines with the same seed deal the same shapes
+	TetrisEngine seeded1{ 99 }, seeded2{ 99 };
+	for (int i = 0; i < 20; i++) {
+		assert(seeded1.getCurrentShape().getShape() == seeded2.getCurrentShape().getShape() &&
+			seeded1.getNextShape().getShape() == seeded2.getNextShape().getShape() &&
+			"TetrisEngine the same seed should deal the same shapes");
+		seeded1.applyInput(GameInput::HARD_DROP);
+		seeded2.applyInput(GameInput::HARD_DROP);
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("Simulation");
+#endif
+}
+
+void TestSuite::testTuner()
+{
+#ifdef TUNER
+	announceTest("Tuner");
+
+	// the weights survive the trip through a TunerVector
+	Evaluator::Weights weights;
+	weights.bumpiness = -1.25;
+	const TunerVector vector = toTunerVector(weights);
+	const Evaluator::Weights back = toWeights(vector);
+	assert(back.holes == weights.holes && back.bumpiness == -1.25 && back.removedRows == weights.removedRows &&
+		getTunerWeightName(1) == "holes" && "toWeights() should undo toTunerVector()");
+
+	// the refit: the elites' mean & variance (plus the noise)
+	TunerOptions options;
+	options.population = 4;
+	options.elites = 2;
+	options.games = 2;
+	options.maxPiecesPerGame = 40;
+	options.noise = 0.5;
+	TunerState state = createTunerState(options);
+	std::vector<TunerVector> candidates(4);
+	for (int c = 0; c < 4; c++) {
+		candidates[c].fill(static_cast<double>(c));
+	}
+	updateTunerState(state, candidates, { 10, 40, 30, 20 });
+	assert(state.generation == 1 && state.mean[0] == 1.5 && std::fabs(state.sigma[3] - std::sqrt(0.25 + 0.5)) < 1e-12 &&
+		state.bestFitness == 40 && state.best[0] == 1 && state.meanFitness == 25 &&
+		"updateTunerState() should refit to the elites");
+
+	// common random numbers: the same weights play the same games, whatever the threads
+	state = createTunerState(options);
+	candidates = sampleCandidates(state);
+	candidates[2] = candidates[0];
+	const std::vector<double> single = evaluateCandidates(candidates, options, 0, 1);
+	const std::vector<double> threaded = evaluateCandidates(candidates, options, 0, 3);
+	assert(single == threaded && "evaluateCandidates() the threads changed the fitness");
+	assert(single[2] == single[0] && "evaluateCandidates() every candidate should play the same games");
+
+	// a run resumed from a checkpoint is the run that was never interrupted
+	TunerState straight = createTunerState(options);
+	runTunerGeneration(straight, 2);
+	runTunerGeneration(straight, 2);
+	TunerState interrupted = createTunerState(options);
+	runTunerGeneration(interrupted, 1);
+	const std::string path = "tetris_tuner_test.checkpoint";
+	assert(saveTunerState(interrupted, path) && "saveTunerState() should write the checkpoint");
+	TunerState resumed;
+	assert(loadTunerState(path, resumed) && resumed.generation == 1 && resumed.mean == interrupted.mean &&
+		resumed.sigma == interrupted.sigma && resumed.options.noise == options.noise &&
+		"loadTunerState() should read back exactly what was saved");
+	std::remove(path.c_str());
+	runTunerGeneration(resumed, 3);
+	assert(resumed.generation == 2 && resumed.mean == straight.mean && resumed.sigma == straight.sigma &&
+		resumed.bestFitness == straight.bestFitness && "a resumed run should match an uninterrupted one");
+	assert(!loadTunerState(path, resumed) && "loadTunerState() there's no checkpoint left");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Tuner");
+#endif
+}
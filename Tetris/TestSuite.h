@@ -10,17 +10,39 @@
 #define TETROMINO
 #define GAMEBOARD
 #define GRIDTETROMINO
-
+#define PIECEGENERATOR
+#define TETRISENGINE
+#define MOVEGENERATOR
+#define EVALUATOR
+#define BEAMSEARCH
+#define PARALLELSEARCH
+#define EXPECTIMAXSEARCH
+#define REPLAY
+#define SIMULATION
+#define TUNER
+
+#include <cstdint>
 #include <string>
 
 class TestSuite {
 
 private:
 	static const int BLOCK_COUNT{ 4 };	// # of blocks in a Tetromino
+	static std::uint64_t (*getAllocationCount)();	// counts operator new calls (if the caller can)
 	static void testPointClass();		// tests for the Point class
 	static void testTetrominoClass();	// tests for the Tetromino class
 	static void testGameboardClass();
 	static void testGridTetrominoClass(); // tests for the GridTetromino class
+	static void testPieceGeneratorClass(); // tests for the PieceGenerator class
+	static void testTetrisEngineClass();  // tests for the (headless) TetrisEngine class
+	static void testMoveGeneratorClass(); // tests for the MoveGenerator class
+	static void testEvaluatorClass();	  // tests for the Evaluator class
+	static void testBeamSearchClass();	  // tests for the BeamSearch class & Zobrist hashing
+	static void testParallelSearchClass(); // tests for the ParallelSearch & TranspositionTable classes
+	static void testExpectimaxSearchClass(); // tests for the ExpectimaxSearch class
+	static void testReplayClass();		  // tests for recording & playing back games
+	static void testSimulation();		  // tests for placement policies & the headless simulation
+	static void testTuner();			  // tests for the weight tuner
 
 	static void announceTest(const std::string& className);
 	static void announceTestCompletion();
@@ -29,7 +51,9 @@ private:
 public:
 	// This will run a series of tests on the Point and Tetromino classes
 	// when the #define statements at the top of this file are active.
-	static void runTestSuite();
+	// - param 1: a function returning the number of operator new calls so far, to
+	//            check the allocation free paths with (nullptr: they're not checked)
+	static void runTestSuite(std::uint64_t (*allocationCounter)() = nullptr);
 };
 
 
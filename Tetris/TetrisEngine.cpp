@@ -0,0 +1,439 @@
+#include "TetrisEngine.h"
+#include "Replay.h"
+#include <algorithm>
+
+// Static Constants
+const TetrisEngine::Nanoseconds TetrisEngine::NANOSECONDS_PER_SECOND = 1000000000;
+const TetrisEngine::Nanoseconds TetrisEngine::MAX_NANOSECONDS_PER_TICK = 750000000;
+const TetrisEngine::Nanoseconds TetrisEngine::MIN_NANOSECONDS_PER_TICK = 200000000;
+const int TetrisEngine::MAX_TICKS_PER_LOOP = 10;
+
+// constructor
+//   set up the piece generator & reset() the game
+// - param 1: the seed (the same seed always deals the same shapes)
+// - param 2: the PieceGenerator::Kind of sequence to deal
+TetrisEngine::TetrisEngine(std::uint64_t seed, PieceGenerator::Kind pieceKind) : pieces{ pieceKind, seed }
+{
+	reset();
+}
+
+// reset everything for a new game (use existing functions)
+//  - begin a new recording (if recording)
+//  - set the score, removed rows & piece count to 0
+//  - call determineNanosecondsPerTick() to determine the tick rate.
+//  - clear the gameboard,
+//  - pick & spawn next shape
+//  - pick next shape again (for the "on-deck" shape)
+// - params: none
+// - return: nothing
+void TetrisEngine::reset()
+{
+	if (recording)
+	{
+		recording->begin(Board::MAX_X, Board::MAX_Y, pieces);
+	}
+	score = 0;
+	totalRemovedRows = 0;
+	pieceCount = 0;
+	gameOver = false;
+	nanosecondsSinceLastTick = 0;
+	gameTime = 0;
+	determineNanosecondsPerTick();
+	board.empty();
+	pickNextShape();
+	spawnNextShape();
+	pickNextShape();
+}
+
+// restart the piece sequence with a new seed then reset() for a new game
+// - param 1: the seed for the new game
+// - return: nothing
+void TetrisEngine::reset(std::uint64_t seed)
+{
+	pieces.reset(seed);
+	reset();
+}
+
+// replace the piece generator then reset() for a new game
+//   (the new game is dealt from the generator's current index)
+// - param 1: the PieceGenerator
+// - return: nothing
+void TetrisEngine::reset(const PieceGenerator& generator)
+{
+	pieces = generator;
+	reset();
+}
+
+// capture the game's state
+// - params: none
+// - return: a Snapshot
+TetrisEngine::Snapshot TetrisEngine::getSnapshot() const
+{
+	Snapshot snapshot;
+	snapshot.board.copyContentFrom(board);
+	snapshot.currentShape = currentShape;
+	snapshot.nextShape = nextShape;
+	snapshot.pieces = pieces;
+	snapshot.totalRemovedRows = totalRemovedRows;
+	snapshot.score = score;
+	snapshot.pieceCount = pieceCount;
+	snapshot.gameOver = gameOver;
+	snapshot.nanosecondsPerTick = nanosecondsPerTick;
+	snapshot.nanosecondsSinceLastTick = nanosecondsSinceLastTick;
+	snapshot.gameTime = gameTime;
+	return snapshot;
+}
+
+// put the game back into a captured state
+//   (the board content is copied with Gameboard::copyContentFrom(), so observers
+//   of the board see every row as changed; the recording isn't touched)
+// - param 1: the Snapshot
+// - return: nothing
+void TetrisEngine::restoreSnapshot(const Snapshot& snapshot)
+{
+	board.copyContentFrom(snapshot.board);
+	currentShape = snapshot.currentShape;
+	nextShape = snapshot.nextShape;
+	pieces = snapshot.pieces;
+	totalRemovedRows = snapshot.totalRemovedRows;
+	score = snapshot.score;
+	pieceCount = snapshot.pieceCount;
+	gameOver = snapshot.gameOver;
+	nanosecondsPerTick = snapshot.nanosecondsPerTick;
+	nanosecondsSinceLastTick = snapshot.nanosecondsSinceLastTick;
+	gameTime = snapshot.gameTime;
+}
+
+// apply a player action to the current shape (ignored once the game is over)
+//   ROTATE, LEFT, RIGHT and SOFT_DROP attempt a single move,
+//   a SOFT_DROP that can't move and a HARD_DROP lock() the current shape.
+// - param 1: GameInput input
+// - return: nothing
+void TetrisEngine::applyInput(GameInput input)
+{
+	if (gameOver)
+	{
+		return;
+	}
+	if (recording)
+	{
+		recording->recordInput(input);
+	}
+
+	switch (input)
+	{
+	case GameInput::ROTATE:
+		attemptRotate(currentShape);
+		break;
+	case GameInput::LEFT:
+		attemptMove(currentShape, -1, 0);
+		break;
+	case GameInput::RIGHT:
+		attemptMove(currentShape, 1, 0);
+		break;
+	case GameInput::SOFT_DROP:
+		if (!attemptMove(currentShape, 0, 1))
+		{
+			lock(currentShape);
+		}
+		break;
+	case GameInput::HARD_DROP:
+		drop(currentShape);
+		lock(currentShape);
+		break;
+	default:
+		break;
+	}
+}
+
+// called every game loop to handle ticks
+//   Fires every tick that is due (not just one), so a long loop doesn't lose
+//   gravity steps - up to MAX_TICKS_PER_LOOP of them.  Time beyond the cap is
+//   dropped (whole ticks only, the partial tick is kept) so a very long stall
+//   doesn't drop the shape the whole way down at once.
+// - param 1: the nanoseconds since the last loop
+// - return: int, the number of ticks fired
+int TetrisEngine::processGameLoop(Nanoseconds nanosecondsSinceLastLoop)
+{
+	if (gameOver || nanosecondsSinceLastLoop <= 0)
+	{
+		return 0;
+	}
+
+	nanosecondsSinceLastTick += nanosecondsSinceLastLoop;
+	gameTime += nanosecondsSinceLastLoop;
+
+	int ticks{ 0 };
+	while (!gameOver && nanosecondsSinceLastTick >= nanosecondsPerTick)
+	{
+		if (ticks == MAX_TICKS_PER_LOOP)
+		{
+			const Nanoseconds dropped = nanosecondsSinceLastTick - nanosecondsSinceLastTick % nanosecondsPerTick;
+			nanosecondsSinceLastTick -= dropped;
+			gameTime -= dropped;
+			break;
+		}
+		// (a tick can lock a shape & change the tick rate, so the rate is re-read every time)
+		nanosecondsSinceLastTick -= nanosecondsPerTick;
+		tick();
+		ticks++;
+	}
+	return ticks;
+}
+
+// A tick() forces the currentShape to move (if there were no tick,
+// the currentShape would float in position forever). This should
+// call attemptMove() on the currentShape.  If not successful, lock()
+// the currentShape (it can move no further).
+// - params: none
+// - return: nothing
+void TetrisEngine::tick()
+{
+	if (gameOver)
+	{
+		return;
+	}
+	if (recording)
+	{
+		recording->recordTick();
+	}
+
+	if (!attemptMove(currentShape, 0, 1))
+	{
+		lock(currentShape);
+	}
+}
+
+// where the currentShape would land if hard dropped (a "ghost" landing preview)
+//   The projection is kept in ghostShape along with the shape's gridLoc and the
+//   board generation it was made from, and only redone when any of them changed.
+// - params: none
+// - return: a GridTetromino, the currentShape at its landing gridLoc
+const GridTetromino& TetrisEngine::getGhostShape() const
+{
+	const Point loc = currentShape.getGridLoc();
+	if (!ghostValid || ghostGeneration != board.getGeneration() ||
+		ghostSourceLoc.getX() != loc.getX() || ghostSourceLoc.getY() != loc.getY() ||
+		ghostShape.getShape() != currentShape.getShape() || ghostShape.getRotation() != currentShape.getRotation())
+	{
+		ghostShape = currentShape;
+		if (isPositionLegal(currentShape))
+		{
+			ghostShape.move(0, getDropRow(currentShape.getShape(), currentShape.getRotation(), loc.getX(), loc.getY()) - loc.getY());
+		}
+		ghostSourceLoc = loc;
+		ghostGeneration = board.getGeneration();
+		ghostValid = true;
+	}
+	return ghostShape;
+}
+
+// the points awarded for removing a number of rows at once
+//   1 row: 40, 2 rows: 100, 3 rows: 300, 4 rows: 1200
+// - param 1: int completedRowsNum
+// - return: int, the points (0 if no rows were removed)
+int TetrisEngine::getScore(int completedRowsNum)
+{
+	switch (completedRowsNum)
+	{
+	case 1:
+		return 40;
+	case 2:
+		return 100;
+	case 3:
+		return 300;
+	case 4:
+		return 1200;
+	default:
+		return 0;
+	}
+}
+
+// Determine if a shape in a given rotation state can legally sit at a given
+// gridLoc.  Looks up the shape's row masks in the rotation table and hands
+// them to Gameboard::isMaskPlaceable() - no copies, no allocations.
+// - param 1: TetShape shape
+// - param 2: int rotation, the rotation state
+// - param 3: int x, the gridLoc x
+// - param 4: int y, the gridLoc y
+// - return: bool, true if within the left, right & bottom borders and every
+//           covered board location is empty (false otherwise).
+bool TetrisEngine::doesShapeFit(TetShape shape, int rotation, int x, int y) const
+{
+	const RotationState& state = Tetromino::getRotationState(shape, rotation % Tetromino::ROTATION_COUNT);
+	return board.isMaskPlaceable(state.rowMasks.data(), state.width, state.height, x + state.minX, y + state.minY);
+}
+
+// the row (gridLoc y) a shape that fits at a given gridLoc lands on when hard dropped.
+//   The shape rests where the lowest block of one of its columns meets that
+//   column's surface (Gameboard::getColumnHeight()).  If that is above the shape,
+//   the shape is under an overhang and the landing row is probed instead.
+// - param 1: TetShape shape
+// - param 2: int rotation, the rotation state
+// - param 3: int x, the gridLoc x
+// - param 4: int y, the gridLoc y (the shape must fit there)
+// - return: int, the landing gridLoc y (>= y)
+int TetrisEngine::getDropRow(TetShape shape, int rotation, int x, int y) const
+{
+	const RotationState& state = Tetromino::getRotationState(shape, rotation % Tetromino::ROTATION_COUNT);
+	const int left = x + state.minX;
+	int landingTop{ Board::MAX_Y };
+	for (int c{ 0 }; c < state.width; c++)
+	{
+		// the row just above the column's highest occupied cell (or the bottom row)
+		const int restingRow = Board::MAX_Y - board.getColumnHeight(left + c) - 1;
+		landingTop = std::min(landingTop, restingRow - state.columnBottoms[c]);
+	}
+
+	if (landingTop >= y + state.minY)
+	{
+		// every cell between the shape and the surface of its columns is empty
+		return landingTop - state.minY;
+	}
+	while (doesShapeFit(shape, rotation, x, y + 1))
+	{
+		y++;
+	}
+	return y;
+}
+
+// Determine if a Tetromino can legally be placed at its current position
+// on the gameboard.
+//   (doesShapeFit() for the shape's shape, rotation & gridLoc)
+// - param 1: GridTetromino shape
+// - return: bool, true if shape is within borders and
+//           the shape's mapped board locs are empty (false otherwise).
+bool TetrisEngine::isPositionLegal(const GridTetromino& shape) const
+{
+	const Point loc = shape.getGridLoc();
+	return doesShapeFit(shape.getShape(), shape.getRotation(), loc.getX(), loc.getY());
+}
+
+// Determine if the shape is within the left, right, & bottom gameboard borders
+//   * Ignore the upper border because we want shapes to be able to drop
+//     in from the top of the gameboard.
+//   All of a shape's blocks must be inside these 3 borders to return true
+// - param 1: GridTetromino shape
+// - return: bool, true if the shape is within the left, right, and lower border
+//	         of the grid, but *NOT* the top border (false otherwise)
+bool TetrisEngine::isWithinBorders(const GridTetromino& shape) const
+{
+	// the rotation state's bounding box covers every block
+	const RotationState& state = shape.getRotationState();
+	const int left = shape.getGridLoc().getX() + state.minX;
+	const int bottom = shape.getGridLoc().getY() + state.minY + state.height - 1;
+	return left >= 0 && left + state.width <= Board::MAX_X && bottom < Board::MAX_Y;
+}
+
+// assign nextShape.setShape the next shape the piece generator deals
+// - params: none
+// - return: nothing
+void TetrisEngine::pickNextShape()
+{
+	nextShape.setShape(pieces.next());
+}
+
+// copy the nextShape into the currentShape (through assignment)
+//   position the currentShape to its spawn location.
+// - params: none
+// - return: bool, true/false based on isPositionLegal()
+bool TetrisEngine::spawnNextShape()
+{
+	currentShape = nextShape;
+	currentShape.setGridLoc(board.getSpawnLoc());
+	return isPositionLegal(currentShape);
+}
+
+// Test if a rotation is legal on the tetromino and if so, rotate it.
+//  To accomplish this (without copying the tetromino):
+//	 1) test if the next rotation state fits at the current gridLoc (doesShapeFit()),
+//	 2) if so - rotate the original tetromino.
+// - param 1: GridTetromino shape
+// - return: bool, true/false to indicate successful movement
+bool TetrisEngine::attemptRotate(GridTetromino& shape)
+{
+	const Point loc = shape.getGridLoc();
+	if (doesShapeFit(shape.getShape(), shape.getRotation() + 1, loc.getX(), loc.getY()))
+	{
+		shape.rotateClockwise();
+		return true;
+	}
+
+	return false;
+}
+
+// test if a move is legal on the tetromino, if so, move it.
+//  To do this (without copying the tetromino):
+//	 1) test if the current rotation state fits at the offset gridLoc (doesShapeFit()),
+//	 2) if so - move the original.
+// - param 1: GridTetromino shape
+// - param 2: int x;
+// - param 3: int y;
+// - return: true/false to indicate successful movement
+bool TetrisEngine::attemptMove(GridTetromino& shape, int x, int y)
+{
+	const Point loc = shape.getGridLoc();
+	if (doesShapeFit(shape.getShape(), shape.getRotation(), loc.getX() + x, loc.getY() + y))
+	{
+		shape.move(x, y);
+		return true;
+	}
+	return false;
+}
+
+// drops the tetromino vertically as far as it can
+//   legally go.  The landing row comes straight from getDropRow().
+// - param 1: GridTetromino shape
+// - return: nothing;
+void TetrisEngine::drop(GridTetromino& shape)
+{
+	const Point loc = shape.getGridLoc();
+	shape.move(0, getDropRow(shape.getShape(), shape.getRotation(), loc.getX(), loc.getY()) - loc.getY());
+}
+
+// copy the contents (color) of the tetromino's mapped block locs to the grid,
+// then resolve the placement straight away:
+//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
+//   2) use the board's setContent() method to set the content at each mapped location.
+//   3) remove completed rows & update the score (getScore())
+//   4) spawn the next shape & pick a new one (the game is over if it can't spawn)
+//   5) let the recording know (it may keep a keyframe)
+// - param 1: GridTetromino shape
+// - return: nothing
+void TetrisEngine::lock(const GridTetromino& shape)
+{
+	for (const Point& p : shape.getBlockLocsMappedToGrid())
+	{
+		board.setContent(p, static_cast<int>(shape.getColor()));
+	}
+	pieceCount++;
+
+	const int removedRows = board.removeCompletedRows();
+	totalRemovedRows += removedRows;
+	score += getScore(removedRows);
+	determineNanosecondsPerTick();
+
+	if (spawnNextShape())
+	{
+		pickNextShape();
+	}
+	else
+	{
+		gameOver = true;
+	}
+
+	if (recording)
+	{
+		recording->recordLock(*this);
+	}
+}
+
+// set nanosecondsPerTick
+//   - basic: use MAX_NANOSECONDS_PER_TICK
+//   - advanced: base it on score (higher score results in lower nanosecondsPerTick)
+// params: none
+// return: nothing
+void TetrisEngine::determineNanosecondsPerTick()
+{
+	nanosecondsPerTick = MAX_NANOSECONDS_PER_TICK;
+}
@@ -0,0 +1,299 @@
+// This class encapsulates the rules of a single tetris game, with no knowledge of
+// how (or whether) it is being drawn.  It has no SFML dependency, so it can be
+// constructed and run on machines without a display (eg: batch simulations).
+// TetrisGame is a thin SFML front end over it: it translates keyboard events
+// into GameInputs, forwards the game loop timing and draws the engine's state.
+//
+// This class is responsible for:
+//   - setting up the board,
+//   - spawning tetrominoes,
+//   - applying player input,
+//   - gravity (ticks),
+//   - moving and placing (locking) tetrominoes,
+//   - removing completed rows & scoring
+//
+//  [expected .cpp size: ~ 250 lines]
+
+#ifndef TETRISENGINE_H
+#define TETRISENGINE_H
+
+#include "Gameboard.h"
+#include "GridTetromino.h"
+#include "PieceGenerator.h"
+
+// The actions a player (or a bot) can take.
+//  (a front end maps its own input events onto these)
+enum class GameInput
+{
+	ROTATE,		// rotate the current shape clockwise
+	LEFT,		// move the current shape one block left
+	RIGHT,		// move the current shape one block right
+	SOFT_DROP,	// move the current shape one block down (lock it if it can't move)
+	HARD_DROP,	// drop the current shape as far as it can go and lock it
+	COUNT
+};
+
+class Replay;
+
+class TetrisEngine
+{
+	friend class TestSuite;
+public:
+	// game time is kept on an integer nanosecond clock, so the same loop times always
+	// fire the same ticks (there is no floating point drift to depend on the frame rate)
+	typedef std::int64_t Nanoseconds;
+
+	// STATIC CONSTANTS
+	static const Nanoseconds NANOSECONDS_PER_SECOND;	// init to 1,000,000,000
+	static const Nanoseconds MAX_NANOSECONDS_PER_TICK;	// the slowest "tick" rate, init to 0.75 seconds
+	static const Nanoseconds MIN_NANOSECONDS_PER_TICK;	// the fastest "tick" rate, init to 0.20 seconds
+	static const int MAX_TICKS_PER_LOOP;				// the catch-up cap (ticks fired by one processGameLoop()), init to 10
+
+	// the gameboard specialization games are played on (the classic 10x19 board).
+	// Change the dimensions here to play on a different sized board.
+	typedef Gameboard<10, 19> Board;
+
+	// everything a game's state is made of (see getSnapshot() & restoreSnapshot())
+	//   (a recording isn't part of the game's state)
+	struct Snapshot
+	{
+		Board board;
+		GridTetromino currentShape;
+		GridTetromino nextShape;
+		PieceGenerator pieces;
+		int totalRemovedRows{ 0 };
+		int score{ 0 };
+		int pieceCount{ 0 };
+		bool gameOver{ false };
+		Nanoseconds nanosecondsPerTick{ 0 };
+		Nanoseconds nanosecondsSinceLastTick{ 0 };
+		Nanoseconds gameTime{ 0 };
+	};
+
+private:
+	// MEMBER VARIABLES
+
+	// State members ---------------------------------------------
+	int totalRemovedRows{ 0 };	// the number of rows removed this game.
+	int score{ 0 };				// the current game score.
+	int pieceCount{ 0 };		// the number of shapes locked onto the board this game.
+	bool gameOver{ false };		// set when a new shape can't be spawned.
+	PieceGenerator pieces;		// deals this game's sequence of shapes.
+	Replay* recording{ nullptr };	// records every game's inputs & ticks (if set).
+	Board board;				// the gameboard (grid) to represent where all the blocks are.
+	GridTetromino nextShape;	// the tetromino shape that is "on deck".
+	GridTetromino currentShape;	// the tetromino that is currently falling.
+
+	// Ghost members (a cache, not game state) -------------------
+	// the currentShape's landing position is only recomputed when the shape's
+	// shape, rotation or gridLoc, or the board (its generation) changed since.
+	mutable GridTetromino ghostShape;			// the currentShape moved to where it would land
+	mutable Point ghostSourceLoc;				// the currentShape gridLoc ghostShape was projected from
+	mutable std::uint64_t ghostGeneration{ 0 };	// the board generation ghostShape was projected on
+	mutable bool ghostValid{ false };			// false until the first projection
+
+	// Time members ----------------------------------------------
+	// Note: a "tick" is the amount of time it takes a block to fall one line.
+	Nanoseconds nanosecondsPerTick = MAX_NANOSECONDS_PER_TICK;	// the time per tick (changes depending on score)
+	Nanoseconds nanosecondsSinceLastTick{ 0 };	// update this every game loop until it is >= nanosecondsPerTick,
+	// we then know to trigger a tick.  Reduce this var (by a tick) & repeat.
+	Nanoseconds gameTime{ 0 };	// the game time this game has consumed (time dropped by the catch-up cap isn't counted)
+
+public:
+	// MEMBER FUNCTIONS
+
+	// constructor
+	//   set up the piece generator & reset() the game
+	// - param 1: the seed (the same seed always deals the same shapes)
+	// - param 2: the PieceGenerator::Kind of sequence to deal
+	explicit TetrisEngine(std::uint64_t seed = 1, PieceGenerator::Kind pieceKind = PieceGenerator::Kind::RANDOM);
+
+	// reset everything for a new game (use existing functions)
+	//  - begin a new recording (if recording)
+	//  - set the score, removed rows & piece count to 0
+	//  - call determineNanosecondsPerTick() to determine the tick rate.
+	//  - clear the gameboard,
+	//  - pick & spawn next shape
+	//  - pick next shape again (for the "on-deck" shape)
+	// - params: none
+	// - return: nothing
+	void reset();
+
+	// restart the piece sequence with a new seed then reset() for a new game
+	// - param 1: the seed for the new game
+	// - return: nothing
+	void reset(std::uint64_t seed);
+
+	// replace the piece generator then reset() for a new game
+	//   (the new game is dealt from the generator's current index)
+	// - param 1: the PieceGenerator
+	// - return: nothing
+	void reset(const PieceGenerator& generator);
+
+	// record games into a Replay: every reset() begins a new recording, then
+	// every input & tick is added to it as it happens.
+	// - param 1: the Replay to record into (nullptr stops recording)
+	// - return: nothing
+	void setRecording(Replay* replay) { recording = replay; }
+
+	// capture the game's state
+	// - params: none
+	// - return: a Snapshot
+	Snapshot getSnapshot() const;
+
+	// put the game back into a captured state
+	//   (the board content is copied with Gameboard::copyContentFrom(), so observers
+	//   of the board see every row as changed; the recording isn't touched)
+	// - param 1: the Snapshot
+	// - return: nothing
+	void restoreSnapshot(const Snapshot& snapshot);
+
+	// apply a player action to the current shape (ignored once the game is over)
+	//   ROTATE, LEFT, RIGHT and SOFT_DROP attempt a single move,
+	//   a SOFT_DROP that can't move and a HARD_DROP lock() the current shape.
+	// - param 1: GameInput input
+	// - return: nothing
+	void applyInput(GameInput input);
+
+	// called every game loop to handle ticks
+	//   Fires every tick that is due (not just one), so a long loop doesn't lose
+	//   gravity steps - up to MAX_TICKS_PER_LOOP of them.  Time beyond the cap is
+	//   dropped (whole ticks only, the partial tick is kept) so a very long stall
+	//   doesn't drop the shape the whole way down at once.
+	//   The ticks only depend on the total time passed in, not on how it was split
+	//   between calls (as long as the cap isn't hit), so a game driven by wall time
+	//   and a headless game driven by simulated time behave identically.
+	// - param 1: the nanoseconds since the last loop
+	// - return: int, the number of ticks fired
+	int processGameLoop(Nanoseconds nanosecondsSinceLastLoop);
+
+	// A tick() forces the currentShape to move (if there were no tick,
+	// the currentShape would float in position forever). This should
+	// call attemptMove() on the currentShape.  If not successful, lock()
+	// the currentShape (it can move no further).
+	// - params: none
+	// - return: nothing
+	void tick();
+
+	// getters for the game state (for front ends, bots & simulations)
+	const Board& getBoard() const { return board; }
+	const GridTetromino& getCurrentShape() const { return currentShape; }
+	const GridTetromino& getNextShape() const { return nextShape; }
+	int getScore() const { return score; }
+	int getTotalRemovedRows() const { return totalRemovedRows; }
+	int getPieceCount() const { return pieceCount; }
+	bool isGameOver() const { return gameOver; }
+	Nanoseconds getGameTime() const { return gameTime; }
+	Nanoseconds getNanosecondsPerTick() const { return nanosecondsPerTick; }
+	const PieceGenerator& getPieceGenerator() const { return pieces; }
+
+	// where the currentShape would land if hard dropped (a "ghost" landing preview)
+	//   The projection (getDropRow()) is cached: calling this every frame only costs
+	//   a comparison until the current shape moves or rotates, or the board changes.
+	// - params: none
+	// - return: a GridTetromino, the currentShape at its landing gridLoc
+	const GridTetromino& getGhostShape() const;
+
+	// the points awarded for removing a number of rows at once
+	//   1 row: 40, 2 rows: 100, 3 rows: 300, 4 rows: 1200
+	// - param 1: int completedRowsNum
+	// - return: int, the points (0 if no rows were removed)
+	static int getScore(int completedRowsNum);
+
+	// Determine if a shape in a given rotation state can legally sit at a given
+	// gridLoc.  This is the collision query used by every move, rotate, drop and spawn:
+	// it looks up the shape's row masks in the rotation table and hands them to
+	// Gameboard::isMaskPlaceable(), so no tetromino is copied and nothing is allocated.
+	// - param 1: TetShape shape
+	// - param 2: int rotation, the rotation state
+	// - param 3: int x, the gridLoc x
+	// - param 4: int y, the gridLoc y
+	// - return: bool, true if within the left, right & bottom borders and every
+	//           covered board location is empty (false otherwise).
+	bool doesShapeFit(TetShape shape, int rotation, int x, int y) const;
+
+	// the row (gridLoc y) a shape that fits at a given gridLoc lands on when hard dropped.
+	//   Computed from the board's column heights: the shape rests on the first
+	//   column surface that one of its columns' lowest block reaches, so no rows
+	//   are probed.  Only a shape already below the surface of one of its columns
+	//   (tucked under an overhang) falls back to probing doesShapeFit() row by row.
+	// - param 1: TetShape shape
+	// - param 2: int rotation, the rotation state
+	// - param 3: int x, the gridLoc x
+	// - param 4: int y, the gridLoc y (the shape must fit there)
+	// - return: int, the landing gridLoc y (>= y)
+	int getDropRow(TetShape shape, int rotation, int x, int y) const;
+
+	// Determine if a Tetromino can legally be placed at its current position
+	// on the gameboard.
+	//   (doesShapeFit() for the shape's shape, rotation & gridLoc)
+	// - param 1: GridTetromino shape
+	// - return: bool, true if shape is within borders and
+	//           the shape's mapped board locs are empty (false otherwise).
+	bool isPositionLegal(const GridTetromino& shape) const;
+
+	// Determine if the shape is within the left, right, & bottom gameboard borders
+	//   * Ignore the upper border because we want shapes to be able to drop
+	//     in from the top of the gameboard.
+	//   All of a shape's blocks must be inside these 3 borders to return true
+	// - param 1: GridTetromino shape
+	// - return: bool, true if the shape is within the left, right, and lower border
+	//	         of the grid, but *NOT* the top border (false otherwise)
+	bool isWithinBorders(const GridTetromino& shape) const;
+
+private:
+	// assign nextShape.setShape the next shape the piece generator deals
+	// - params: none
+	// - return: nothing
+	void pickNextShape();
+
+	// copy the nextShape into the currentShape (through assignment)
+	//   position the currentShape to its spawn location.
+	// - params: none
+	// - return: bool, true/false based on isPositionLegal()
+	bool spawnNextShape();
+
+	// Test if a rotation is legal on the tetromino and if so, rotate it.
+	//  To accomplish this (without copying the tetromino):
+	//	 1) test if the next rotation state fits at the current gridLoc (doesShapeFit()),
+	//	 2) if so - rotate the original tetromino.
+	// - param 1: GridTetromino shape
+	// - return: bool, true/false to indicate successful movement
+	bool attemptRotate(GridTetromino& shape);
+
+	// test if a move is legal on the tetromino, if so, move it.
+	//  To do this (without copying the tetromino):
+	//	 1) test if the current rotation state fits at the offset gridLoc (doesShapeFit()),
+	//	 2) if so - move the original.
+	// - param 1: GridTetromino shape
+	// - param 2: int x;
+	// - param 3: int y;
+	// - return: true/false to indicate successful movement
+	bool attemptMove(GridTetromino& shape, int x, int y);
+
+	// drops the tetromino vertically as far as it can
+	//   legally go.  The landing row comes straight from getDropRow().
+	// - param 1: GridTetromino shape
+	// - return: nothing;
+	void drop(GridTetromino& shape);
+
+	// copy the contents (color) of the tetromino's mapped block locs to the grid,
+	// then resolve the placement straight away:
+	//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
+	//   2) use the board's setContent() method to set the content at each mapped location.
+	//   3) remove completed rows & update the score (getScore())
+	//   4) spawn the next shape & pick a new one (the game is over if it can't spawn)
+	//   5) let the recording know (it may keep a keyframe)
+	// - param 1: GridTetromino shape
+	// - return: nothing
+	void lock(const GridTetromino& shape);
+
+	// set nanosecondsPerTick
+	//   - basic: use MAX_NANOSECONDS_PER_TICK
+	//   - advanced: base it on score (higher score results in lower nanosecondsPerTick)
+	// params: none
+	// return: nothing
+	void determineNanosecondsPerTick();
+};
+
+#endif /* TETRISENGINE_H */
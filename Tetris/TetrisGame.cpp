@@ -1,22 +1,22 @@
 #include "TetrisGame.h"
+#include <algorithm>
 
 // Static Constants
 const int TetrisGame::BLOCK_WIDTH = 32;
 const int TetrisGame::BLOCK_HEIGHT = 32;
-const double TetrisGame::MAX_SECONDS_PER_TICK = 0.75;
-const double TetrisGame::MIN_SECONDS_PER_TICK = 0.20;
+const std::string TetrisGame::LAST_REPLAY_PATH = "last_game.replay";
+const sf::Color TetrisGame::GHOST_TINT{ 255, 255, 255, 80 };
 
 // constructor
 //   initialize/assign private member vars names that match param names
-//   reset() the game
 //   load font from file: fonts/RedOctober.ttf
 //   setup scoreText
+//   start recording & start the first game
 // - params: already specified
-TetrisGame::TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const Point& gameboardOffset, const Point& nextShapeOffset)
-	: window{ window }, blockSprite{ blockSprite }, gameboardOffset{ gameboardOffset }, nextShapeOffset{ nextShapeOffset }
+// - param 5: the seed every game's seed is drawn from (eg: the time)
+TetrisGame::TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const Point& gameboardOffset, const Point& nextShapeOffset, std::uint64_t seed)
+	: seeds{ seed }, window{ window }, blockSprite{ blockSprite }, gameboardOffset{ gameboardOffset }, nextShapeOffset{ nextShapeOffset }
 {
-	reset();
-
 	// setup our font for drawing the score
 	if (!scoreFont.loadFromFile("fonts/RedOctober.ttf"))
 	{
@@ -26,23 +26,57 @@ TetrisGame::TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const
 	scoreText.setCharacterSize(18);
 	scoreText.setFillColor(sf::Color::White);
 	scoreText.setPosition(425, 325);
+
+	engine.setRecording(&replay);
+	engine.reset(seeds.next());
+	updateScoreDisplay();
+
+	// the retained board quads (filled in by the first draw())
+	boardVertices.resize(Board::MAX_X * Board::MAX_Y * 4);
+	if (sf::VertexBuffer::isAvailable())
+	{
+		boardBuffer.create(boardVertices.size());
+	}
 }
 
 // Draw anything to do with the game,
 //   includes the board, currentShape, nextShape, score
 //   called every game loop
+//   The locked cells live in a retained vertex buffer that only has the rows the
+//   board changed since the last frame refreshed (see updateBoardVertices()), so a
+//   steady-state frame only rebuilds the current & next shapes' 8 quads
+//   (plus the ghost's 4, whose landing position the engine caches).
+//   The blocks cost 2 draw calls however full the board is.
 // - params: none
 // - return: nothing
 void TetrisGame::draw() const
 {
-	drawTetromino(currentShape, gameboardOffset);
-	drawTetromino(nextShape, nextShapeOffset);
-	drawGameboard();
+	const sf::RenderStates states(blockSprite.getTexture());
+
+	updateBoardVertices();
+	if (sf::VertexBuffer::isAvailable())
+	{
+		window.draw(boardBuffer, states);
+	}
+	else
+	{
+		window.draw(boardVertices.data(), boardVertices.size(), sf::Quads, states);
+	}
+
+	blockQuads.clear();	// (keeps its storage, so frames don't allocate)
+	if (!engine.isGameOver())
+	{
+		addTetromino(engine.getGhostShape(), gameboardOffset, GHOST_TINT);
+	}
+	addTetromino(engine.getCurrentShape(), gameboardOffset);
+	addTetromino(engine.getNextShape(), nextShapeOffset);
+	window.draw(blockQuads, states);
 	window.draw(scoreText);
 }
 
 // Event and game loop processing
-// handles keypress events (up, left, right, down, space)
+// handles keypress events (up, left, right, down, space, B)
+//   by mapping them onto engine GameInputs, B toggles the bot
 // - param 1: sf::Event event
 // - return: nothing
 void TetrisGame::onKeyPressed(const sf::Event& event)
@@ -50,316 +84,224 @@ void TetrisGame::onKeyPressed(const sf::Event& event)
 	switch (event.key.code)
 	{
 	case sf::Keyboard::Up:
-		attemptRotate(currentShape);
+		engine.applyInput(GameInput::ROTATE);
 		break;
 	case sf::Keyboard::Left:
-		attemptMove(currentShape, -1, 0);
+		engine.applyInput(GameInput::LEFT);
 		break;
 	case sf::Keyboard::Right:
-		attemptMove(currentShape, 1, 0);
+		engine.applyInput(GameInput::RIGHT);
 		break;
 	case sf::Keyboard::Down:
-		if (!attemptMove(currentShape, 0, 1))
-		{
-			lock(currentShape);
-		}
+		engine.applyInput(GameInput::SOFT_DROP);
 		break;
 	case sf::Keyboard::Space:
-		drop(currentShape);
-		lock(currentShape);
+		engine.applyInput(GameInput::HARD_DROP);
+		break;
+	case sf::Keyboard::B:
+		botPlaying = !botPlaying;
+		botWait = 0;
 		break;
 	default:
 		break;
 	}
 }
 
-// called every game loop to handle ticks & tetromino placement (locking)
-// - param 1: float secondsSinceLastLoop
+// called every game loop to handle ticks (in the engine), let the bot place a
+//   shape once per tick while it plays (when its search is ready),
+//   save the replay & restart the game if it is over, keep the score display current
+// - param 1: sf::Time timeSinceLastLoop (passed to the engine in whole nanoseconds)
 // return: nothing
-void TetrisGame::processGameLoop(float secondsSinceLastLoop)
+void TetrisGame::processGameLoop(sf::Time timeSinceLastLoop)
 {
-	secondsSinceLastTick += secondsSinceLastLoop;
-	if (secondsSinceLastTick >= secondsPerTick)
-	{
-		tick();
-		secondsSinceLastTick -= secondsPerTick;
-	}
+	const TetrisEngine::Nanoseconds nanoseconds = static_cast<TetrisEngine::Nanoseconds>(timeSinceLastLoop.asMicroseconds()) * 1000;
+	engine.processGameLoop(nanoseconds);
 
-	if (shapePlacedSinceLastGameLoop)
+	if (botPlaying && !engine.isGameOver())
 	{
-		shapePlacedSinceLastGameLoop = false;
-		if (spawnNextShape())
+		botWait += nanoseconds;
+		if (!botSearch.valid() && engine.getPieceCount() != botPiece)
 		{
-			pickNextShape();
-			switch (board.removeCompletedRows())
-			{
-			case 1:
-				score += 40;
-				updateScoreDisplay();
-				break;
-			case 2:
-				score += 100;
-				updateScoreDisplay();
-				break;
-			case 3:
-				score += 300;
-				updateScoreDisplay();
-				break;
-			case 4:
-				score += 1200;
-				updateScoreDisplay();
-				break;
-			default:
-				break;
-			}
-			determineSecondsPerTick();
+			startBotSearch();
 		}
-		else
+		if (botSearch.valid() && botWait >= engine.getNanosecondsPerTick()
+			&& botSearch.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
 		{
-			reset();
+			Placement placement = botSearch.get();
+			// a search of an earlier shape is dropped; if gravity moved the shape
+			// meanwhile, its path no longer starts where the shape is
+			const GridTetromino& shape = engine.getCurrentShape();
+			if (engine.getPieceCount() == botPiece)
+			{
+				if (shape.getGridLoc().getX() != botFrom.getX() || shape.getGridLoc().getY() != botFrom.getY()
+					|| shape.getRotation() != botRotation)
+				{
+					placement.path.clear();
+				}
+				botWait = 0;
+				PlacementPolicy::applyPlacement(engine, placement);
+			}
 		}
 	}
 
-}
-// A tick() forces the currentShape to move (if there were no tick,
-// the currentShape would float in position forever). This should
-// call attemptMove() on the currentShape.  If not successful, lock() 
-// the currentShape (it can move no further).
-// - params: none
-// - return: nothing
-void TetrisGame::tick()
-{
-	if (!attemptMove(currentShape, 0, 1))
-	{
-		lock(currentShape);
-	}
-}
-
-// reset everything for a new game (use existing functions) 
-//  - set the score to 0 and call updateScoreDisplay()
-//  - call determineSecondsPerTick() to determine the tick rate.
-//  - clear the gameboard,
-//  - pick & spawn next shape
-//  - pick next shape again (for the "on-deck" shape)
-// - params: none
-// - return: nothing
-void TetrisGame::reset()
-{
-	score = 0;
-	updateScoreDisplay();
-	determineSecondsPerTick();
-	board.empty();
-	pickNextShape();
-	spawnNextShape();
-	pickNextShape();
-}
-
-// assign nextShape.setShape a new random shape  
-// - params: none
-// - return: nothing
-void TetrisGame::pickNextShape()
-{
-	nextShape.setShape(Tetromino::getRandomShape());
-}
-
-// copy the nextShape into the currentShape (through assignment)
-//   position the currentShape to its spawn location.
-// - params: none
-// - return: bool, true/false based on isPositionLegal()
-bool TetrisGame::spawnNextShape()
-{
-	currentShape = nextShape;
-	currentShape.setGridLoc(board.getSpawnLoc());
-	if (isPositionLegal(currentShape))
-	{
-		return true;
-	}
-
-	return false;	
-}
-
-// Test if a rotation is legal on the tetromino and if so, rotate it. 
-//  To accomplish this:
-//	 1) create a (local) temporary copy of the tetromino
-//	 2) rotate it (temp.rotateClockwise())
-//	 3) test if temp rotation was legal (isPositionLegal()), 
-//      if so - rotate the original tetromino.
-// - param 1: GridTetromino shape
-// - return: bool, true/false to indicate successful movement
-bool TetrisGame::attemptRotate(GridTetromino& shape)
-{
-	GridTetromino temp = shape;
-	temp.rotateClockwise();
-	
-	if (isPositionLegal(temp))
+	if (engine.isGameOver())
 	{
-		shape.rotateClockwise();
-		return true;
+		replay.save(LAST_REPLAY_PATH);
+		engine.reset(seeds.next());
+		botPiece = -1;
 	}
 
-	return false;
-}
-
-// test if a move is legal on the tetromino, if so, move it.
-//  To do this:
-//	 1) create a (local) temporary copy of the tetromino
-//	 2) move it (temp.move())
-//	 3) test if temp move was legal (isPositionLegal(),
-//      if so - move the original.	
-// - param 1: GridTetromino shape
-// - param 2: int x;
-// - param 3: int y;
-// - return: true/false to indicate successful movement
-bool TetrisGame::attemptMove(GridTetromino& shape, int x, int y)
-{
-	GridTetromino temp = shape;
-	temp.move(x, y);
-	if (isPositionLegal(temp)) 
+	if (engine.getScore() != displayedScore)
 	{
-		shape.move(x, y);
-		return true;
+		updateScoreDisplay();
 	}
-	return false;
-}
-
-// drops the tetromino vertically as far as it can 
-//   legally go.  Use attemptMove(). This can be done in 1 line.
-// - param 1: GridTetromino shape
-// - return: nothing;
-void TetrisGame::drop(GridTetromino& shape)
-{
-	while (attemptMove(shape, 0, 1)){};	
 }
 
-// copy the contents (color) of the tetromino's mapped block locs to the grid.
-	//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
-	//   2) use the board's setContent() method to set the content at the mapped locations.
-	//   3) record the fact that we placed a shape by setting shapePlacedSinceLastGameLoop
-	//      to true
-	// - param 1: GridTetromino shape
-	// - return: nothing
-void TetrisGame::lock(const GridTetromino& shape)
+// start the bot's search of the current position on a thread of its own
+//   (on a copy of the engine, so the game goes on while it searches)
+// - params: none
+// - return: nothing
+void TetrisGame::startBotSearch()
 {
-	std::vector<Point> temp = shape.getBlockLocsMappedToGrid();
-	board.setContent(temp, static_cast<int>(shape.getColor()));
-	shapePlacedSinceLastGameLoop = true;
+	TetrisEngine position{ engine };
+	position.setRecording(nullptr);
+	botPiece = engine.getPieceCount();
+	botFrom = engine.getCurrentShape().getGridLoc();
+	botRotation = engine.getCurrentShape().getRotation();
+	botSearch = std::async(std::launch::async, [this, position]() { return bot.choosePlacement(position); });
 }
 
 // Graphics methods ==============================================
 
-// Draw a tetris block sprite on the canvas		
+// Set the 4 vertices of a tetris block quad
 // The block position is specified in terms of 2 offsets: 
 //    1) the top left (of the gameboard in pixels)
 //    2) an x & y offset into the gameboard - in blocks (not pixels)
 //       meaning they need to be multiplied by BLOCK_WIDTH and BLOCK_HEIGHT
 //       to get the pixel offset.
-//	 1) set the block color using blockSprite.setTextureRect()
-//   2) set the block location using blockSprite.setPosition()   
-//	 3) draw the block using window.draw()
-//   For details/instructions on these 3 operations see:
-//       www.sfml-dev.org/tutorials/2.5/graphics-sprite.php
-//       use member variables: window and blockSprite (assigned in constructor)
+//   The quad's 4 corners get the block's pixel position and the texture
+//   coordinates of the color's tile in the block texture.
+// param 1: a pointer to the quad's 4 vertices
+// param 2: Point topLeft
+// param 3: int xOffset
+// param 4: int yOffset
+// param 5: TetColor color
+// return: nothing
+void TetrisGame::setBlockQuad(sf::Vertex* quad, const Point& topLeft, int xOffset, int yOffset, TetColor color)
+{
+	const float left = static_cast<float>(topLeft.getX() + BLOCK_WIDTH * xOffset);
+	const float top = static_cast<float>(topLeft.getY() + BLOCK_HEIGHT * yOffset);
+	const float texLeft = static_cast<float>(static_cast<int>(color) * BLOCK_WIDTH);
+
+	quad[0] = sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(texLeft, 0.0f));
+	quad[1] = sf::Vertex(sf::Vector2f(left + BLOCK_WIDTH, top), sf::Vector2f(texLeft + BLOCK_WIDTH, 0.0f));
+	quad[2] = sf::Vertex(sf::Vector2f(left + BLOCK_WIDTH, top + BLOCK_HEIGHT), sf::Vector2f(texLeft + BLOCK_WIDTH, static_cast<float>(BLOCK_HEIGHT)));
+	quad[3] = sf::Vertex(sf::Vector2f(left, top + BLOCK_HEIGHT), sf::Vector2f(texLeft, static_cast<float>(BLOCK_HEIGHT)));
+}
+
+// Add a tetris block to the frame's batch of quads (blockQuads)
+//   (nothing is drawn until draw() submits the whole batch)
 // param 1: Point topLeft
 // param 2: int xOffset
 // param 3: int yOffset
 // param 4: TetColor color
+// param 5: the color the block's texture is modulated by (translucent for the ghost)
 // return: nothing
-void TetrisGame::drawBlock(const Point& topLeft, int xOffset, int yOffset, TetColor color) const
+void TetrisGame::addBlock(const Point& topLeft, int xOffset, int yOffset, TetColor color, sf::Color tint) const
 {
-	blockSprite.setTextureRect(sf::IntRect(static_cast<int>(color) * BLOCK_WIDTH, 0, BLOCK_WIDTH, BLOCK_HEIGHT));
-	blockSprite.setPosition(topLeft.getX() + BLOCK_HEIGHT * xOffset,topLeft.getY() + BLOCK_WIDTH * yOffset);
-	window.draw(blockSprite);
+	sf::Vertex quad[4];
+	setBlockQuad(quad, topLeft, xOffset, yOffset, color);
+	for (sf::Vertex& vertex : quad)
+	{
+		vertex.color = tint;
+		blockQuads.append(vertex);
+	}
 }
 
-// Draw the gameboard blocks on the window
-//   Iterate through each row & col, use drawBlock() to 
-//   draw a block if it isn't empty.
+// Bring the retained gameboard quads up to date
+//   Ask the board which rows changed since boardGeneration, rebuild only
+//   those rows' quads (an empty cell gets a zero sized quad) and upload the
+//   span of changed rows to boardBuffer in one update.
 // params: none
 // return: nothing
-void TetrisGame::drawGameboard() const
+void TetrisGame::updateBoardVertices() const
 {
-	for (int y{ 0 }; y < board.MAX_Y; y++)
+	const Board& board = engine.getBoard();
+	// (a board whose generation went backwards is a different board: refresh every row)
+	const Board::RowSet allRows = (Board::MAX_Y == 64) ? ~Board::RowSet{ 0 } : (Board::RowSet{ 1 } << Board::MAX_Y) - 1;
+	const Board::RowSet changedRows = board.getGeneration() < boardGeneration ? allRows : board.getChangedRowsSince(boardGeneration);
+	boardGeneration = board.getGeneration();
+	if (changedRows == 0)
 	{
-		for (int x{ 0 }; x < board.MAX_X; x++)
+		return;
+	}
+
+	const int rowVertexCount = Board::MAX_X * 4;
+	int firstRow = Board::MAX_Y;
+	int lastRow = -1;
+	for (int y{ 0 }; y < Board::MAX_Y; y++)
+	{
+		if ((changedRows & (Board::RowSet{ 1 } << y)) == 0)
+		{
+			continue;
+		}
+		firstRow = std::min(firstRow, y);
+		lastRow = y;
+
+		for (int x{ 0 }; x < Board::MAX_X; x++)
 		{
-			if (board.getContent(x, y) != Gameboard::EMPTY_BLOCK)
+			sf::Vertex* quad = &boardVertices[(y * Board::MAX_X + x) * 4];
+			const int content = board.getContent(x, y);
+			if (content != Board::EMPTY_BLOCK)
 			{
-				drawBlock(gameboardOffset, x, y, static_cast<TetColor>(board.getContent(x, y)));
-			}	
+				setBlockQuad(quad, gameboardOffset, x, y, static_cast<TetColor>(content));
+			}
+			else
+			{
+				for (int corner{ 0 }; corner < 4; corner++)
+				{
+					quad[corner] = sf::Vertex();
+				}
+			}
 		}
 	}
+
+	if (sf::VertexBuffer::isAvailable())
+	{
+		boardBuffer.update(&boardVertices[firstRow * rowVertexCount],
+			(lastRow - firstRow + 1) * rowVertexCount, firstRow * rowVertexCount);
+	}
 }
 
-// Draw a tetromino on the window
-//	 Iterate through each mapped loc & drawBlock() for each.
+// Add a tetromino to the frame's batch
+//	 Iterate through each mapped loc & addBlock() for each.
 //   The topLeft determines a 'base point' from which to calculate block offsets
 //      If the Tetromino is on the gameboard: use gameboardOffset
 // param 1: GridTetromino tetromino
 // param 2: Point topLeft
+// param 3: the color the blocks' texture is modulated by (translucent for the ghost)
 // return: nothing
-void TetrisGame::drawTetromino(const GridTetromino& tetromino, const Point& topLeft) const 
+void TetrisGame::addTetromino(const GridTetromino& tetromino, const Point& topLeft, sf::Color tint) const 
 {
-	for (Point& p : tetromino.getBlockLocsMappedToGrid())
+	for (const Point& p : tetromino.getBlockLocsMappedToGrid())
 	{
-		drawBlock(topLeft, p.getX(), p.getY(), tetromino.getColor());
+		addBlock(topLeft, p.getX(), p.getY(), tetromino.getColor(), tint);
 	}
 }
 
 // update the score display
-// form a string "score: ##" to display the current score
+// form a string "score: ##" to display the current (engine) score
 // user scoreText.setString() to display it.
 // params: none:
 // return: nothing
 void TetrisGame::updateScoreDisplay()
 {
+	displayedScore = engine.getScore();
+
 	std::stringstream message;
 	std::string messageToOutput;
-	message << "score: " << score;
+	message << "score: " << displayedScore;
 	messageToOutput = message.str();
 
 	scoreText.setString(messageToOutput);
 }
-
-// State & gameplay/logic methods ================================
-
-// Determine if a Tetromino can legally be placed at its current position
-// on the gameboard.
-//   Tip: Make use of Gameboard's areLocsEmpty() and pass it the shape's mapped locs.
-// - param 1: GridTetromino shape
-// - return: bool, true if shape is within borders (isWithinBorders()) and 
-//           the shape's mapped board locs are empty (false otherwise).
-bool TetrisGame::isPositionLegal(const GridTetromino& shape) const
-{
-	return isWithinBorders(shape) && board.areAllLocsEmpty(shape.getBlockLocsMappedToGrid());
-}
-
-
-// Determine if the shape is within the left, right, & bottom gameboard borders
-//   * Ignore the upper border because we want shapes to be able to drop
-//     in from the top of the gameboard.
-//   All of a shape's blocks must be inside these 3 borders to return true
-// - param 1: GridTetromino shape
-// - return: bool, true if the shape is within the left, right, and lower border
-//	         of the grid, but *NOT* the top border (false otherwise)
-bool TetrisGame::isWithinBorders(const GridTetromino& shape) const
-{
-	for (const Point& p : shape.getBlockLocsMappedToGrid())
-	{
-		if (!(p.getX() < Gameboard::MAX_X && p.getY() < Gameboard::MAX_Y && p.getX() >= 0))
-		{
-			return false;
-		}
-	}
-	return true;
-}
-
-
-// set secsPerTick 
-//   - basic: use MAX_SECS_PER_TICK
-//   - advanced: base it on score (higher score results in lower secsPerTick)
-// params: none
-// return: nothing
-void TetrisGame::determineSecondsPerTick() 
-{
-	secondsPerTick = MAX_SECONDS_PER_TICK;
-}
\ No newline at end of file
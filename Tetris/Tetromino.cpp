@@ -8,55 +8,17 @@ Tetromino::Tetromino()
 void Tetromino::setShape(TetShape shape)
 {
 	this->shape = shape;
-	color = static_cast<TetColor>(shape);
+	rotation = 0;
+}
 
-	switch (shape) 
-	{
-		case TetShape::O :
-		{
-			blockLocs = { Point{0, 1}, Point{1, 1}, Point{0, 0}, Point{1, 0} };
-			break;
-		}
-		case TetShape::I :
-		{
-			blockLocs = { Point{0, -1}, Point{0, 0}, Point{0, 1}, Point{0, 2} };
-			break;
-		}
-		case TetShape::S :
-		{
-			blockLocs = { Point{-1, 0}, Point{0, 0}, Point{0, 1}, Point{1, 1} };
-			break;
-		}
-		case TetShape::Z :
-		{
-			blockLocs = { Point{-1, 1}, Point{0, 1}, Point{0, 0}, Point{1, 0} };
-			break;
-		}
-		case TetShape::L :
-		{
-			blockLocs = { Point{0, 1}, Point{0, 0}, Point{0, -1}, Point{1, -1} };
-			break;
-		}
-		case TetShape::J :
-		{
-			blockLocs = { Point{-1, -1}, Point{0, -1}, Point{0, 0}, Point{0, 1} };
-			break;
-		}
-		case TetShape::T :
-		{
-			blockLocs = { Point{-1, 0}, Point{0, 0}, Point{1, 0}, Point{0, -1} };
-			break;
-		}
-	}
-	
+void Tetromino::setRotation(int rotation)
+{
+	this->rotation = ((rotation % ROTATION_COUNT) + ROTATION_COUNT) % ROTATION_COUNT;
 }
 
 void Tetromino::rotateClockwise() 
 {
-	for (Point& point : blockLocs) {
-		point.multiplyX(-1);
-		point.swapXY();
-	}
+	rotation = (rotation + 1) % ROTATION_COUNT;
 }
 
 void Tetromino::printToConsole() const
@@ -65,7 +27,7 @@ void Tetromino::printToConsole() const
 		std::cout << "\n";
 		for (int x = -3; x <= 3; x++) {
 			bool match = false;
-			for (const Point& point : blockLocs) {
+			for (const Point& point : getBlockLocs()) {
 				if (point.getX() == x && point.getY() == y) match = true;
 			}
 			if (match)
@@ -78,8 +40,8 @@ void Tetromino::printToConsole() const
 	std::cout << "\n";
 }
 
-TetShape Tetromino::getRandomShape()
+TetShape Tetromino::getRandomShape(Random& rng)
 {
-	int randomShape = rand() % static_cast<int>(TetShape::COUNT);
+	int randomShape = rng.nextInt(static_cast<int>(TetShape::COUNT));
 	return static_cast<TetShape>(randomShape);
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
-#include <vector>
+#include <array>
+#include <cstdint>
 #include "Point.h"
+#include "Random.h"
 #include <iostream>
 #include <sstream>
 
@@ -27,42 +29,147 @@ enum class TetShape
 	COUNT
 };
 
+// The geometry of one shape in one rotation state.
+// Every state of every shape is precomputed (at compile time) into
+// Tetromino's rotation table, so a tetromino is just a shape and a
+// rotation index and rotating never touches the blocks themselves.
+struct RotationState
+{
+	static constexpr int BLOCK_COUNT = 4;	// # of blocks in a Tetromino
+
+	std::array<Point, BLOCK_COUNT> blocks;		// block offsets from the pivot [0,0]
+	int minX;									// x offset of the bounding box's left column
+	int minY;									// y offset of the bounding box's top row
+	int width;									// bounding box width (in blocks)
+	int height;									// bounding box height (in blocks)
+	std::array<std::uint16_t, BLOCK_COUNT> rowMasks;	// occupancy of each bounding box row
+														// (bit 0 is the column at minX)
+	std::array<int, BLOCK_COUNT> columnBottoms;	// the row offset (from minY) of the lowest block
+												// in each bounding box column
+};
+
+namespace TetrominoTables
+{
+	// the blocks of each shape in its spawn (unrotated) state
+	constexpr std::array<Point, RotationState::BLOCK_COUNT> spawnBlocks(TetShape shape)
+	{
+		switch (shape)
+		{
+		case TetShape::O: return { Point{0, 1}, Point{1, 1}, Point{0, 0}, Point{1, 0} };
+		case TetShape::I: return { Point{0, -1}, Point{0, 0}, Point{0, 1}, Point{0, 2} };
+		case TetShape::S: return { Point{-1, 0}, Point{0, 0}, Point{0, 1}, Point{1, 1} };
+		case TetShape::Z: return { Point{-1, 1}, Point{0, 1}, Point{0, 0}, Point{1, 0} };
+		case TetShape::L: return { Point{0, 1}, Point{0, 0}, Point{0, -1}, Point{1, -1} };
+		case TetShape::J: return { Point{-1, -1}, Point{0, -1}, Point{0, 0}, Point{0, 1} };
+		default:          return { Point{-1, 0}, Point{0, 0}, Point{1, 0}, Point{0, -1} };	// T
+		}
+	}
+
+	// derive the bounding box, row masks and column bottoms of a set of blocks
+	constexpr RotationState makeRotationState(const std::array<Point, RotationState::BLOCK_COUNT>& blocks)
+	{
+		RotationState state{ blocks, blocks[0].getX(), blocks[0].getY(), 0, 0, {}, {} };
+		int maxX = state.minX;
+		int maxY = state.minY;
+		for (const Point& p : blocks)
+		{
+			state.minX = p.getX() < state.minX ? p.getX() : state.minX;
+			state.minY = p.getY() < state.minY ? p.getY() : state.minY;
+			maxX = p.getX() > maxX ? p.getX() : maxX;
+			maxY = p.getY() > maxY ? p.getY() : maxY;
+		}
+		state.width = maxX - state.minX + 1;
+		state.height = maxY - state.minY + 1;
+		for (const Point& p : blocks)
+		{
+			state.rowMasks[p.getY() - state.minY] |= static_cast<std::uint16_t>(1u << (p.getX() - state.minX));
+			int& bottom = state.columnBottoms[p.getX() - state.minX];
+			bottom = p.getY() - state.minY > bottom ? p.getY() - state.minY : bottom;
+		}
+		return state;
+	}
+
+	// build every rotation state of every shape.
+	//   Each state is the previous one rotated 90 degrees clockwise around [0,0]
+	//   ([x,y] becomes [y,-x]).  The O shape doesn't rotate.
+	constexpr std::array<std::array<RotationState, 4>, static_cast<int>(TetShape::COUNT)> buildRotationTable()
+	{
+		std::array<std::array<RotationState, 4>, static_cast<int>(TetShape::COUNT)> table{};
+		for (int s = 0; s < static_cast<int>(TetShape::COUNT); s++)
+		{
+			std::array<Point, RotationState::BLOCK_COUNT> blocks = spawnBlocks(static_cast<TetShape>(s));
+			for (int r = 0; r < 4; r++)
+			{
+				table[s][r] = makeRotationState(blocks);
+				if (static_cast<TetShape>(s) != TetShape::O)
+				{
+					for (Point& p : blocks)
+					{
+						p = Point{ p.getY(), -p.getX() };
+					}
+				}
+			}
+		}
+		return table;
+	}
+
+	// [shape][rotation] -> the geometry of that shape in that rotation state
+	constexpr std::array<std::array<RotationState, 4>, static_cast<int>(TetShape::COUNT)> ROTATIONS = buildRotationTable();
+}
+
 class Tetromino
 {
 	friend class TestSuite;
+public:
+	static constexpr int BLOCK_COUNT = RotationState::BLOCK_COUNT;	// # of blocks in a Tetromino
+	static constexpr int ROTATION_COUNT = 4;						// # of rotation states per shape
+
 private:
-	TetColor color;
 	TetShape shape;
-protected:
-	std::vector<Point> blockLocs;
+	int rotation;	// index into the rotation table [0, ROTATION_COUNT)
 
 public:
 	Tetromino();
-	TetColor getColor() const{ return color; }
+	TetColor getColor() const{ return static_cast<TetColor>(shape); }
 	TetShape getShape() const{ return shape; }
+	int getRotation() const{ return rotation; }
 
-	
+	// the precomputed geometry of this tetromino's current shape & rotation
+	const RotationState& getRotationState() const { return getRotationState(shape, rotation); }
+
+	// the block offsets (from the pivot [0,0]) of the current shape & rotation
+	const std::array<Point, BLOCK_COUNT>& getBlockLocs() const { return getRotationState().blocks; }
+
+	// look up the precomputed geometry of any shape in any rotation state
+	// - param 1: TetShape shape
+	// - param 2: int rotation, [0, ROTATION_COUNT)
+	// - return: the rotation table entry
+	static const RotationState& getRotationState(TetShape shape, int rotation)
+	{
+		return TetrominoTables::ROTATIONS[static_cast<int>(shape)][rotation];
+	}
 
 	// - set the shape
-	// - set the blockLocs for the shape
-	// - set the color for the shape
+	// - reset the rotation to the spawn state
+	//   (the blocks and the color come from the shape & rotation)
 	void setShape(TetShape shape);
 
+	// set the rotation state directly
+	// - param 1: int rotation, any value (wrapped into [0, ROTATION_COUNT))
+	void setRotation(int rotation);
+
 	// rotate the shape 90 degrees around [0,0] (clockwise)
 	// to do this:
-	// - iterate through blockLocs
-	// - rotate each Point 90 degrees clockwise around [0,0]
-	// hint: as you rotate the point [1,2] clockwise around [0,0], note
-	// how the x,y values change. Once you find the pattern you can use
-	// a couple existing methods in the Point class to accomplish this.
-	// make it so that the TetShape::O doesnt rotate
+	// - advance to the next rotation state in the rotation table
+	// The table entries were rotated at compile time, so no blocks are touched here.
+	// The TetShape::O doesnt rotate
 	void rotateClockwise();
 
 	// print a grid to display the current shape
 	// to do this: print out a grid of text to represent a co-ordinate
 	// system. Start at top left [-3,3] go to bottom right [3,-3]
 	// (use nested for loops)
-	// for each [x,y] point, loop through the blockLocs and if the point exists
+	// for each [x,y] point, loop through the block locs and if the point exists
 	// in the list, print an 'x' instead of a '.'. You should end up with something
 	// like this: (results will vary depending on shape and rotation, eg: this
 	// one shows a T shape rotated clockwise once)
@@ -74,7 +181,9 @@ public:
 	// ......
 	void printToConsole() const;
 
-	// Generates a random shape while seeding the randomizer
-	static TetShape getRandomShape();
+	// Generates a random shape from a random stream
+	// - param 1: the Random stream to draw from (each game owns its own)
+	// - return: a uniformly distributed TetShape
+	static TetShape getRandomShape(Random& rng);
 };
 
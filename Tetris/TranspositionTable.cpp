@@ -0,0 +1,70 @@
+#include "TranspositionTable.h"
+#include <cstring>
+
+namespace
+{
+	// the bits of a value
+	std::uint64_t toBits(double value)
+	{
+		std::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// the value of some bits
+	double fromBits(std::uint64_t bits)
+	{
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+}
+
+// constructor
+// - param 1: the log2 of the slot count
+TranspositionTable::TranspositionTable(int sizeLog2)
+	: slots{ new Slot[std::size_t{ 1 } << sizeLog2] }, mask{ (std::size_t{ 1 } << sizeLog2) - 1 }
+{
+}
+
+// look a position up
+//   (relaxed loads: a slot read halfway through another thread's store fails the check)
+// - param 1: the key
+// - param 2: set to the position's value if it is found
+// - return: bool, true if it is found
+bool TranspositionTable::probe(std::uint64_t key, double& value) const
+{
+	key |= 1;
+	const Slot& slot = slots[(key >> 1) & mask];
+	const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+	if ((slot.check.load(std::memory_order_relaxed) ^ data) != key)
+	{
+		return false;
+	}
+	value = fromBits(data);
+	return true;
+}
+
+// remember a position's value (replacing whatever the slot held)
+// - param 1: the key
+// - param 2: the value
+// - return: nothing
+void TranspositionTable::store(std::uint64_t key, double value)
+{
+	key |= 1;
+	Slot& slot = slots[(key >> 1) & mask];
+	const std::uint64_t data = toBits(value);
+	slot.check.store(key ^ data, std::memory_order_relaxed);
+	slot.data.store(data, std::memory_order_relaxed);
+}
+
+// forget every position (not while other threads use the table)
+// - return: nothing
+void TranspositionTable::clear()
+{
+	for (std::size_t s{ 0 }; s <= mask; s++)
+	{
+		slots[s].check.store(0, std::memory_order_relaxed);
+		slots[s].data.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,62 @@
+// A TranspositionTable remembers the values of searched positions, keyed on a 64 bit
+// hash (eg: a board's Zobrist hash mixed with what was searched below it), and can
+// be shared by any number of search threads without locks.
+//
+// Every slot is two 64 bit atomics: the value's bits, and the key XOR-ed with them.
+// A store writes both, a probe reads both and only accepts the value if XOR-ing them
+// gives back the key, so a slot torn by two threads writing at once just misses
+// (it never returns another position's value).  Slots are always replaced.
+//
+// The low bit of a key is reserved (it is set on every key), so an empty slot can
+// never match.
+
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class TranspositionTable
+{
+public:
+	static constexpr int DEFAULT_SIZE_LOG2 = 18;	// 2^18 slots (4MB)
+
+private:
+	// a slot: the key XOR the value bits, and the value bits
+	struct Slot
+	{
+		std::atomic<std::uint64_t> check{ 0 };
+		std::atomic<std::uint64_t> data{ 0 };
+	};
+
+	std::unique_ptr<Slot[]> slots;	// the slots (a power of 2 of them)
+	std::size_t mask;				// the slot count - 1
+
+public:
+	// constructor
+	// - param 1: the log2 of the slot count
+	explicit TranspositionTable(int sizeLog2 = DEFAULT_SIZE_LOG2);
+
+	// the number of slots
+	std::size_t getSize() const { return mask + 1; }
+
+	// look a position up
+	// - param 1: the key
+	// - param 2: set to the position's value if it is found
+	// - return: bool, true if it is found
+	bool probe(std::uint64_t key, double& value) const;
+
+	// remember a position's value (replacing whatever the slot held)
+	// - param 1: the key
+	// - param 2: the value
+	// - return: nothing
+	void store(std::uint64_t key, double value);
+
+	// forget every position (not while other threads use the table)
+	// - return: nothing
+	void clear();
+};
+
+#endif /* TRANSPOSITIONTABLE_H */
@@ -0,0 +1,138 @@
+// tetris_tune - tunes the Evaluator weights by self play (see Tuner.h).
+//
+// usage: tetris_tune [--generations N] [--population P] [--elites E] [--games G]
+//                    [--max-pieces M] [--seed S] [--sigma D] [--noise V]
+//                    [--pieces random|bag|history] [--threads T]
+//                    [--checkpoint FILE] [--resume]
+//
+// Runs until N generations are complete (default 20), saving the run's state to the
+// checkpoint file (default tetris_tune.checkpoint) after every generation.  --resume
+// continues from the checkpoint, with the options it was started with (the run
+// options given are then ignored, except --generations & --threads), and produces
+// exactly what an uninterrupted run would have.  --threads defaults to one thread per
+// hardware thread; the results never depend on it.
+//
+// The tuned weights are the distribution's mean, printed at the end.
+
+#include "Tuner.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// print the weights of a vector, one per line
+// - param 1: the vector
+// - return: nothing
+void printWeights(const TunerVector& vector)
+{
+	for (int w{ 0 }; w < TUNER_WEIGHT_COUNT; w++)
+	{
+		std::cout << "  " << getTunerWeightName(w) << " " << vector[w] << "\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	TunerOptions options;
+	int generations{ 20 };
+	int threads{ 0 };
+	std::string checkpointPath{ "tetris_tune.checkpoint" };
+	bool resume{ false };
+
+	for (int i{ 1 }; i < argc; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--generations") == 0 && hasValue)
+		{
+			generations = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--population") == 0 && hasValue)
+		{
+			options.population = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--elites") == 0 && hasValue)
+		{
+			options.elites = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--games") == 0 && hasValue)
+		{
+			options.games = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--max-pieces") == 0 && hasValue)
+		{
+			options.maxPiecesPerGame = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+		{
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--sigma") == 0 && hasValue)
+		{
+			options.initialSigma = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--noise") == 0 && hasValue)
+		{
+			options.noise = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+		{
+			threads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--checkpoint") == 0 && hasValue)
+		{
+			checkpointPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--resume") == 0)
+		{
+			resume = true;
+		}
+		else if (std::strcmp(argv[i], "--pieces") == 0 && hasValue && PieceGenerator::parseKind(argv[i + 1], options.pieceKind))
+		{
+			i++;
+		}
+		else
+		{
+			std::cerr << "usage: " << argv[0]
+				<< " [--generations N] [--population P] [--elites E] [--games G] [--max-pieces M] [--seed S]\n"
+				<< "       [--sigma D] [--noise V] [--pieces random|bag|history] [--threads T] [--checkpoint FILE] [--resume]\n";
+			return 1;
+		}
+	}
+
+	TunerState state = createTunerState(options);
+	if (resume)
+	{
+		if (!loadTunerState(checkpointPath, state))
+		{
+			std::cerr << checkpointPath << ": can't be read, or isn't a tetris_tune checkpoint\n";
+			return 1;
+		}
+		std::cout << "resuming " << checkpointPath << " after generation " << state.generation << "\n";
+	}
+	std::cout << "population:   " << state.options.population << " (" << state.options.elites << " elites)\n";
+	std::cout << "games:        " << state.options.games << " per candidate, up to " << state.options.maxPiecesPerGame
+		<< " pieces (" << PieceGenerator::getKindName(state.options.pieceKind) << ", seed " << state.options.seed << ")\n";
+	std::cout << "threads:      " << (threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency())) << "\n";
+
+	while (state.generation < generations)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		runTunerGeneration(state, threads);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (!saveTunerState(state, checkpointPath))
+		{
+			std::cerr << checkpointPath << ": can't be written\n";
+			return 1;
+		}
+		std::cout << "generation " << state.generation << ": best " << state.bestFitness << ", mean "
+			<< state.meanFitness << " (" << seconds << " seconds)\n";
+	}
+
+	std::cout << "tuned weights (the mean):\n";
+	printWeights(state.mean);
+	std::cout << "latest best candidate (" << state.bestFitness << "):\n";
+	printWeights(state.best);
+	return 0;
+}
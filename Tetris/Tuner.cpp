@@ -0,0 +1,343 @@
+#include "Tuner.h"
+#include "PlacementPolicy.h"
+#include "Random.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+namespace
+{
+	const char* const CHECKPOINT_HEADER = "tetris_tune-checkpoint";
+	const int CHECKPOINT_VERSION = 1;
+
+	// the names of the tuned weights (in TunerVector order)
+	const char* const WEIGHT_NAMES[TUNER_WEIGHT_COUNT] = {
+		"aggregateHeight", "holes", "bumpiness", "rowTransitions",
+		"columnTransitions", "wellSums", "landingHeight", "removedRows"
+	};
+
+	// a standard normal draw (Box-Muller, from two uniform draws in (0, 1])
+	// - param 1: the random stream
+	// - return: the draw
+	double nextGaussian(Random& rng)
+	{
+		const double u1 = static_cast<double>((rng.next() >> 11) + 1) / 9007199254740992.0;	// 2^53
+		const double u2 = static_cast<double>((rng.next() >> 11) + 1) / 9007199254740992.0;
+		return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+	}
+
+	// write a vector on one line after its key
+	// - param 1: the stream
+	// - param 2: the key
+	// - param 3: the vector
+	// - return: nothing
+	void writeVector(std::ostream& out, const char* key, const TunerVector& vector)
+	{
+		out << key;
+		for (double value : vector)
+		{
+			out << " " << value;
+		}
+		out << "\n";
+	}
+
+	// read a vector written by writeVector()
+	// - param 1: the stream
+	// - param 2: the key expected
+	// - param 3: set to the vector
+	// - return: bool, false if the key or a value is missing
+	bool readVector(std::istream& in, const char* key, TunerVector& vector)
+	{
+		std::string word;
+		if (!(in >> word) || word != key)
+		{
+			return false;
+		}
+		for (double& value : vector)
+		{
+			if (!(in >> value))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// read a value written as "key value"
+	// - param 1: the stream
+	// - param 2: the key expected
+	// - param 3: set to the value
+	// - return: bool, false if the key or the value is missing
+	template<typename T>
+	bool readValue(std::istream& in, const char* key, T& value)
+	{
+		std::string word;
+		return (in >> word) && word == key && (in >> value);
+	}
+}
+
+// the name of a tuned weight
+// - param 1: the weight index [0, TUNER_WEIGHT_COUNT)
+// - return: the name (the Evaluator::Weights member)
+std::string getTunerWeightName(int index)
+{
+	return WEIGHT_NAMES[index];
+}
+
+// the tuned weights of an Evaluator::Weights, in TUNER_WEIGHT_COUNT order
+// - param 1: the Weights
+// - return: the TunerVector
+TunerVector toTunerVector(const Evaluator::Weights& weights)
+{
+	return TunerVector{ weights.aggregateHeight, weights.holes, weights.bumpiness, weights.rowTransitions,
+		weights.columnTransitions, weights.wellSums, weights.landingHeight, weights.removedRows };
+}
+
+// the Evaluator::Weights of a TunerVector
+// - param 1: the TunerVector
+// - return: the Weights
+Evaluator::Weights toWeights(const TunerVector& vector)
+{
+	Evaluator::Weights weights;
+	weights.aggregateHeight = vector[0];
+	weights.holes = vector[1];
+	weights.bumpiness = vector[2];
+	weights.rowTransitions = vector[3];
+	weights.columnTransitions = vector[4];
+	weights.wellSums = vector[5];
+	weights.landingHeight = vector[6];
+	weights.removedRows = vector[7];
+	return weights;
+}
+
+// the state a run starts from: the default Evaluator weights, initialSigma wide
+// - param 1: the TunerOptions
+// - return: the TunerState (generation 0)
+TunerState createTunerState(const TunerOptions& options)
+{
+	TunerState state;
+	state.options = options;
+	state.mean = toTunerVector(Evaluator::Weights{});
+	state.sigma.fill(options.initialSigma);
+	state.best = state.mean;
+	return state;
+}
+
+// the candidates of the state's next generation
+//   (drawn from the state's distribution with the generation's own stream)
+// - param 1: the TunerState
+// - return: options.population candidates
+std::vector<TunerVector> sampleCandidates(const TunerState& state)
+{
+	Random rng{ Random::streamSeed(state.options.seed, static_cast<std::uint64_t>(state.generation)) };
+	std::vector<TunerVector> candidates(std::max(state.options.population, 1));
+	for (TunerVector& candidate : candidates)
+	{
+		for (int w{ 0 }; w < TUNER_WEIGHT_COUNT; w++)
+		{
+			candidate[w] = state.mean[w] + state.sigma[w] * nextGaussian(rng);
+		}
+	}
+	return candidates;
+}
+
+// the fitness of each candidate: the mean score of its games, all candidates
+// playing the same games (the generation's), spread over worker threads
+//   Every (candidate, game) is a task; workers claim the next one from a shared
+//   counter, and each game's score is kept in its own slot so the sums don't
+//   depend on which thread played what.
+// - param 1: the candidates
+// - param 2: the TunerOptions
+// - param 3: the generation (it picks the games)
+// - param 4: the worker threads (0: one per hardware thread)
+// - return: the fitness of each candidate
+std::vector<double> evaluateCandidates(const std::vector<TunerVector>& candidates, const TunerOptions& options,
+	int generation, int threads)
+{
+	const int games = std::max(options.games, 1);
+	const long long taskCount = static_cast<long long>(candidates.size()) * games;
+	std::vector<long long> scores(static_cast<std::size_t>(taskCount));
+	// the generation's games: a run seed of their own, the same for every candidate
+	const std::uint64_t gamesSeed = Random::streamSeed(options.seed ^ 0x6A09E667F3BCC908ull, static_cast<std::uint64_t>(generation));
+
+	int threadCount = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+	threadCount = static_cast<int>(std::max(1LL, std::min<long long>(threadCount, taskCount)));
+	std::atomic<long long> nextTask{ 0 };
+
+	auto worker = [&]()
+	{
+		TetrisEngine engine{ 0, options.pieceKind };
+		for (long long task = nextTask++; task < taskCount; task = nextTask++)
+		{
+			const std::size_t candidate = static_cast<std::size_t>(task / games);
+			std::uint64_t engineSeed, policySeed;
+			getGameSeeds(gamesSeed, task % games, engineSeed, policySeed);
+			engine.reset(engineSeed);
+			GreedyPolicy policy{ toWeights(candidates[candidate]) };
+			policy.reset(policySeed);
+			scores[static_cast<std::size_t>(task)] = playGame(engine, policy, options.maxPiecesPerGame).score;
+		}
+	};
+
+	// the calling thread is worker 0
+	std::vector<std::thread> workers;
+	for (int t{ 1 }; t < threadCount; t++)
+	{
+		workers.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : workers)
+	{
+		thread.join();
+	}
+
+	std::vector<double> fitness(candidates.size());
+	for (std::size_t c{ 0 }; c < candidates.size(); c++)
+	{
+		long long sum{ 0 };
+		for (int g{ 0 }; g < games; g++)
+		{
+			sum += scores[c * games + g];
+		}
+		fitness[c] = static_cast<double>(sum) / games;
+	}
+	return fitness;
+}
+
+// refit the state's distribution to a generation's elites & advance the generation
+//   The elites are the options.elites fittest candidates (ties go to the first
+//   drawn); the new mean & variance are theirs, plus options.noise on the variance.
+// - param 1: the TunerState
+// - param 2: the generation's candidates
+// - param 3: their fitness
+// - return: nothing
+void updateTunerState(TunerState& state, const std::vector<TunerVector>& candidates, const std::vector<double>& fitness)
+{
+	std::vector<int> order(candidates.size());
+	for (std::size_t c{ 0 }; c < order.size(); c++)
+	{
+		order[c] = static_cast<int>(c);
+	}
+	std::stable_sort(order.begin(), order.end(), [&fitness](int a, int b) { return fitness[a] > fitness[b]; });
+	const int elites = std::max(1, std::min(state.options.elites, static_cast<int>(order.size())));
+
+	for (int w{ 0 }; w < TUNER_WEIGHT_COUNT; w++)
+	{
+		double mean{ 0 };
+		for (int e{ 0 }; e < elites; e++)
+		{
+			mean += candidates[order[e]][w];
+		}
+		mean /= elites;
+		double variance{ 0 };
+		for (int e{ 0 }; e < elites; e++)
+		{
+			const double deviation = candidates[order[e]][w] - mean;
+			variance += deviation * deviation;
+		}
+		variance /= elites;
+		state.mean[w] = mean;
+		state.sigma[w] = std::sqrt(variance + state.options.noise);
+	}
+
+	double total{ 0 };
+	for (double value : fitness)
+	{
+		total += value;
+	}
+	state.meanFitness = fitness.empty() ? 0 : total / fitness.size();
+	state.bestFitness = fitness[order[0]];
+	state.best = candidates[order[0]];
+	state.generation++;
+}
+
+// run one generation: sample, evaluate & update
+// - param 1: the TunerState
+// - param 2: the worker threads (0: one per hardware thread)
+// - return: nothing
+void runTunerGeneration(TunerState& state, int threads)
+{
+	const std::vector<TunerVector> candidates = sampleCandidates(state);
+	updateTunerState(state, candidates, evaluateCandidates(candidates, state.options, state.generation, threads));
+}
+
+// write a state to a file (through a temporary file, so an interruption while
+// saving leaves the previous checkpoint intact)
+//   A text file: one "key values..." line per field, doubles written with enough
+//   digits to be read back exactly.
+// - param 1: the TunerState
+// - param 2: the file path
+// - return: bool, true if it was written
+bool saveTunerState(const TunerState& state, const std::string& path)
+{
+	const std::string temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath);
+		file.precision(std::numeric_limits<double>::max_digits10);
+		const TunerOptions& options = state.options;
+		file << CHECKPOINT_HEADER << " " << CHECKPOINT_VERSION << "\n";
+		file << "seed " << options.seed << "\n";
+		file << "population " << options.population << "\n";
+		file << "elites " << options.elites << "\n";
+		file << "games " << options.games << "\n";
+		file << "max-pieces " << options.maxPiecesPerGame << "\n";
+		file << "initial-sigma " << options.initialSigma << "\n";
+		file << "noise " << options.noise << "\n";
+		file << "pieces " << PieceGenerator::getKindName(options.pieceKind) << "\n";
+		file << "generation " << state.generation << "\n";
+		writeVector(file, "mean", state.mean);
+		writeVector(file, "sigma", state.sigma);
+		file << "best-fitness " << state.bestFitness << "\n";
+		writeVector(file, "best", state.best);
+		file << "mean-fitness " << state.meanFitness << "\n";
+		if (!file.flush())
+		{
+			return false;
+		}
+	}
+	// (std::rename doesn't replace an existing file everywhere)
+	if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+	{
+		std::remove(path.c_str());
+		return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+	}
+	return true;
+}
+
+// read a state from a file
+// - param 1: the file path
+// - param 2: set to the state read
+// - return: bool, true if the file held a valid checkpoint
+bool loadTunerState(const std::string& path, TunerState& state)
+{
+	std::ifstream file(path);
+	TunerState read;
+	TunerOptions& options = read.options;
+	int version{ 0 };
+	std::string pieces;
+	if (!readValue(file, CHECKPOINT_HEADER, version) || version != CHECKPOINT_VERSION
+		|| !readValue(file, "seed", options.seed)
+		|| !readValue(file, "population", options.population)
+		|| !readValue(file, "elites", options.elites)
+		|| !readValue(file, "games", options.games)
+		|| !readValue(file, "max-pieces", options.maxPiecesPerGame)
+		|| !readValue(file, "initial-sigma", options.initialSigma)
+		|| !readValue(file, "noise", options.noise)
+		|| !readValue(file, "pieces", pieces) || !PieceGenerator::parseKind(pieces, options.pieceKind)
+		|| !readValue(file, "generation", read.generation)
+		|| !readVector(file, "mean", read.mean)
+		|| !readVector(file, "sigma", read.sigma)
+		|| !readValue(file, "best-fitness", read.bestFitness)
+		|| !readVector(file, "best", read.best)
+		|| !readValue(file, "mean-fitness", read.meanFitness))
+	{
+		return false;
+	}
+	state = read;
+	return true;
+}
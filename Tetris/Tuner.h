@@ -0,0 +1,124 @@
+// Offline tuning of the Evaluator weights by self play (what tetris_tune runs).
+//
+// The optimizer is the cross-entropy method, a population based evolution strategy:
+// the weights are drawn from a Gaussian with a mean & a standard deviation per weight,
+// every candidate of a generation plays the same games, and the distribution is then
+// refit to the best candidates (the elites).  A little noise is added to the refit
+// variance so it doesn't collapse before the mean settles.
+//
+// A candidate's fitness is the mean final score of its games, played headless with a
+// GreedyPolicy using its weights.  Every candidate of a generation is dealt the same
+// piece sequences (common random numbers), so they are compared on the same games and
+// not on their luck; each generation deals new sequences, so the weights don't fit
+// one set of games.
+//
+// Every game of a generation is a task, and the tasks are spread over worker threads
+// (all of them by default).  The candidates & the games of generation g only depend
+// on the options' seed & g, and the fitnesses are summed in a fixed order, so the
+// run is the same whatever the number of threads - and a run resumed from a
+// checkpoint is the same as one that was never interrupted.  The whole state of a
+// run (its options, the generation & the distribution) is what a checkpoint holds.
+
+#ifndef TUNER_H
+#define TUNER_H
+
+#include "Evaluator.h"
+#include "PieceGenerator.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// the number of Evaluator weights tuned
+const int TUNER_WEIGHT_COUNT = 8;
+
+typedef std::array<double, TUNER_WEIGHT_COUNT> TunerVector;
+
+// how a tuning run should be run
+struct TunerOptions
+{
+	std::uint64_t seed{ 1 };		// the seed of the whole run (same seed, same run)
+	int population{ 32 };			// the candidates per generation
+	int elites{ 8 };				// the best candidates the distribution is refit to
+	int games{ 20 };				// the games each candidate plays (the same for all of a generation)
+	int maxPiecesPerGame{ 1000 };	// games still running after this many pieces are stopped
+	double initialSigma{ 2.0 };		// the starting standard deviation of every weight
+	double noise{ 0.1 };			// the variance added to every weight at each refit
+	PieceGenerator::Kind pieceKind{ PieceGenerator::Kind::RANDOM };	// the shape sequence games are dealt
+};
+
+// the state of a tuning run (all a checkpoint holds)
+struct TunerState
+{
+	TunerOptions options;
+	int generation{ 0 };		// the generations completed
+	TunerVector mean{};			// the distribution the next generation is drawn from
+	TunerVector sigma{};
+	double bestFitness{ 0 };	// the latest generation's best candidate (0 before the first)
+	TunerVector best{};
+	double meanFitness{ 0 };	// the latest generation's mean fitness
+};
+
+// the name of a tuned weight
+// - param 1: the weight index [0, TUNER_WEIGHT_COUNT)
+// - return: the name (the Evaluator::Weights member)
+std::string getTunerWeightName(int index);
+
+// the tuned weights of an Evaluator::Weights, in TUNER_WEIGHT_COUNT order
+// - param 1: the Weights
+// - return: the TunerVector
+TunerVector toTunerVector(const Evaluator::Weights& weights);
+
+// the Evaluator::Weights of a TunerVector
+// - param 1: the TunerVector
+// - return: the Weights
+Evaluator::Weights toWeights(const TunerVector& vector);
+
+// the state a run starts from: the default Evaluator weights, initialSigma wide
+// - param 1: the TunerOptions
+// - return: the TunerState (generation 0)
+TunerState createTunerState(const TunerOptions& options);
+
+// the candidates of the state's next generation
+//   (drawn from the state's distribution with the generation's own stream)
+// - param 1: the TunerState
+// - return: options.population candidates
+std::vector<TunerVector> sampleCandidates(const TunerState& state);
+
+// the fitness of each candidate: the mean score of its games, all candidates
+// playing the same games (the generation's), spread over worker threads
+// - param 1: the candidates
+// - param 2: the TunerOptions
+// - param 3: the generation (it picks the games)
+// - param 4: the worker threads (0: one per hardware thread)
+// - return: the fitness of each candidate
+std::vector<double> evaluateCandidates(const std::vector<TunerVector>& candidates, const TunerOptions& options,
+	int generation, int threads = 0);
+
+// refit the state's distribution to a generation's elites & advance the generation
+// - param 1: the TunerState
+// - param 2: the generation's candidates
+// - param 3: their fitness
+// - return: nothing
+void updateTunerState(TunerState& state, const std::vector<TunerVector>& candidates, const std::vector<double>& fitness);
+
+// run one generation: sample, evaluate & update
+// - param 1: the TunerState
+// - param 2: the worker threads (0: one per hardware thread)
+// - return: nothing
+void runTunerGeneration(TunerState& state, int threads = 0);
+
+// write a state to a file (through a temporary file, so an interruption while
+// saving leaves the previous checkpoint intact)
+// - param 1: the TunerState
+// - param 2: the file path
+// - return: bool, true if it was written
+bool saveTunerState(const TunerState& state, const std::string& path);
+
+// read a state from a file
+// - param 1: the file path
+// - param 2: set to the state read
+// - return: bool, true if the file held a valid checkpoint
+bool loadTunerState(const std::string& path, TunerState& state);
+
+#endif /* TUNER_H */
@@ -0,0 +1,116 @@
+// Zobrist hashing of gameboard occupancy.
+//
+// Every cell (x, y) has a fixed random 64 bit key; the hash of a board is the XOR of
+// the keys of its occupied cells.  The keys are a pure function of the cell, so the
+// hash of a board never depends on how it was built, and a placement changes it by
+// XOR-ing in the keys of the cells it fills.
+//
+// Cells also have a key per content (color), for hashes that tell boards with the
+// same occupancy but different colors apart.
+//
+// Hashing a whole board at once goes through per-row nibble tables (the XOR of the
+// cell keys of every 4 bit pattern), so a row costs one lookup per 4 columns.
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "Random.h"
+#include <cstdint>
+
+namespace Zobrist
+{
+	// the key of an occupied cell
+	// - param 1: the column
+	// - param 2: the row
+	// - return: the key
+	inline std::uint64_t cellKey(int x, int y)
+	{
+		return Random::mix(0x5A0B7157D1CEull + (static_cast<std::uint64_t>(y) << 8) + static_cast<std::uint64_t>(x));
+	}
+
+	// the key of a cell holding some content (eg: a color)
+	// - param 1: the column
+	// - param 2: the row
+	// - param 3: the content
+	// - return: the key
+	inline std::uint64_t contentKey(int x, int y, int content)
+	{
+		return Random::mix(cellKey(x, y) ^ (static_cast<std::uint64_t>(content) + 2) * 0x9E3779B97F4A7C15ull);
+	}
+
+	// the nibble tables of a board size
+	//   (built once, on first use - thread safe)
+	template<int WIDTH, int HEIGHT>
+	class RowKeys
+	{
+	public:
+		static constexpr int NIBBLES = (WIDTH + 3) / 4;	// 4 column groups per row
+
+	private:
+		// [row][nibble][pattern] -> the XOR of the cell keys of the pattern's columns
+		std::uint64_t keys[HEIGHT][NIBBLES][16];
+
+		RowKeys()
+		{
+			for (int y{ 0 }; y < HEIGHT; y++)
+			{
+				for (int n{ 0 }; n < NIBBLES; n++)
+				{
+					for (int pattern{ 0 }; pattern < 16; pattern++)
+					{
+						keys[y][n][pattern] = 0;
+						for (int bit{ 0 }; bit < 4 && n * 4 + bit < WIDTH; bit++)
+						{
+							if (pattern & (1 << bit))
+							{
+								keys[y][n][pattern] ^= cellKey(n * 4 + bit, y);
+							}
+						}
+					}
+				}
+			}
+		}
+
+	public:
+		// the tables
+		static const RowKeys& get()
+		{
+			static const RowKeys instance;
+			return instance;
+		}
+
+		// the hash of a row (the XOR of the keys of its occupied cells)
+		// - param 1: the row index
+		// - param 2: the row's occupancy bits (bit x set if column x is occupied)
+		// - return: the hash
+		std::uint64_t hashRow(int y, std::uint32_t row) const
+		{
+			std::uint64_t hash{ 0 };
+			for (int n{ 0 }; n < NIBBLES; n++)
+			{
+				hash ^= keys[y][n][(row >> (n * 4)) & 15];
+			}
+			return hash;
+		}
+	};
+
+	// the hash of a board's occupancy
+	// - param 1: the board's rows (HEIGHT of them, bit x set if column x is occupied)
+	// - return: the hash (0 for an empty board)
+	template<int WIDTH, int HEIGHT, typename Row>
+	std::uint64_t hashRows(const Row* rows)
+	{
+		const RowKeys<WIDTH, HEIGHT>& tables = RowKeys<WIDTH, HEIGHT>::get();
+		std::uint64_t hash{ 0 };
+		for (int y{ 0 }; y < HEIGHT; y++)
+		{
+			if (rows[y] != 0)
+			{
+				hash ^= tables.hashRow(y, rows[y]);
+			}
+		}
+		return hash;
+	}
+}
+
+#endif /* ZOBRIST_H */